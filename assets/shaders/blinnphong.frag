@@ -1,6 +1,9 @@
 #version 330 core
 
 #define MAX_LIGHTS 8
+#define MAX_MATERIAL_VARIANTS 4
+// Models::InstanceFlags
+#define INSTANCE_HIGHLIGHT 1u
 
 //——————————————————————————————————————————————————————————————————————————
 // material + light structs
@@ -42,6 +45,11 @@ uniform Material    material;
 uniform Light       lights[MAX_LIGHTS];
 uniform int         numLights;
 uniform vec3        viewPos;
+// variant n > 0 of an instance scales the diffuse colour by materialVariants[n - 1].rgb and
+// the specular one by .a, variant 0 and the ones past the model's table are the material as
+// it is (Model::set_material_variants)
+uniform vec4        materialVariants[MAX_MATERIAL_VARIANTS];
+uniform int         materialVariantCount;
 
 
 //——————————————————————————————————————————————————————————————————————————
@@ -93,6 +101,9 @@ in  vec3  FragPos;
 in  vec3  Normal;
 in  vec2  TexCoord;
 in  mat3  TBN;
+in  vec4  Tint;
+flat in uint InstanceFlags;
+flat in uint MaterialVariant;
 out vec4  FragColor;
 
 //——————————————————————————————————————————————————————————————————————————
@@ -314,6 +325,12 @@ void main()
     vec3 Ka = useAmbientMap  ? texture(ambientMap,  TexCoord).rgb : material.ambient;
     vec3 Kd = useDiffuseMap  ? texture(diffuseMap,  TexCoord).rgb : material.diffuse;
     vec3 Ks = useSpecularMap ? texture(specularMap, TexCoord).rgb : material.specular;
+    if (MaterialVariant > 0u && MaterialVariant <= uint(materialVariantCount)) {
+        vec4 variant = materialVariants[MaterialVariant - 1u];
+        Kd *= variant.rgb;
+        Ks *= variant.a;
+    }
+    Kd *= Tint.rgb;
 
     // 2) prepare
     vec3 N = fetchNormal();
@@ -416,6 +433,9 @@ void main()
                + ambientAccum * 0.05
                + diffuseAccum
                + specAccum * 0.1;
+    if ((InstanceFlags & INSTANCE_HIGHLIGHT) != 0u) {
+        color += 0.25 * Kd;
+    }
 
 
     //vec3 color = material.emissive
@@ -456,5 +476,5 @@ void main()
 
     //FragColor = vec4(vec3(storedDepth), 1.0);
     //return;
-    FragColor = vec4(color, material.opacity);
+    FragColor = vec4(color, material.opacity * Tint.a);
 }
@@ -8,30 +8,48 @@ layout(location = 4) in vec4 iModelCol0;
 layout(location = 5) in vec4 iModelCol1;
 layout(location = 6) in vec4 iModelCol2;
 layout(location = 7) in vec4 iModelCol3;
+// see Models::InstanceData
+layout(location = 8) in vec4 iTint;
+layout(location = 9) in uvec2 iFlagsVariant;
 
 uniform mat4 uView;
 uniform mat4 uProj;
 uniform mat4 uModel;
 uniform bool uUseInstancing;
+// InstanceFlags of a model that is not instanced
+uniform int  uFlags;
+// aPos/aTexCoord are unorm16 inside the mesh bounds for packed vertices, identity for float ones
+uniform vec3 uPosOffset;
+uniform vec3 uPosScale;
+uniform vec2 uTexOffset;
+uniform vec2 uTexScale;
 
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
 out mat3   TBN;
+// white, uFlags and 0 without instancing
+out vec4      Tint;
+flat out uint InstanceFlags;
+flat out uint MaterialVariant;
 
 void main() {
     mat4 modelMatrix = uUseInstancing
         ? mat4(iModelCol0, iModelCol1, iModelCol2, iModelCol3)
         : uModel;
     mat3 normalMatrix = mat3(transpose(inverse(modelMatrix)));
-    vec4 worldPos = modelMatrix * vec4(aPos, 1.0);
+    vec4 worldPos = modelMatrix * vec4(uPosOffset + aPos * uPosScale, 1.0);
     FragPos       = worldPos.xyz;
     Normal        = normalMatrix * aNormal;
     vec3 N        = normalize(Normal);
     vec3 T        = normalize(normalMatrix * aTangent.xyz);
-    vec3 B        = cross(N, T) * aTangent.w;
+    // packed tangents bring the handedness back as -1/3 or -1 depending on the GL version
+    vec3 B        = cross(N, T) * (aTangent.w < 0.0 ? -1.0 : 1.0);
     TBN           = mat3(T, B, N);
-    TexCoord      = aTexCoord;
+    TexCoord      = uTexOffset + aTexCoord * uTexScale;
     gl_Position   = uProj * uView * worldPos;
+    Tint            = uUseInstancing ? iTint : vec4(1.0);
+    InstanceFlags   = uUseInstancing ? iFlagsVariant.x : uint(uFlags);
+    MaterialVariant = uUseInstancing ? iFlagsVariant.y : 0u;
 }
\ No newline at end of file
@@ -11,6 +11,9 @@ uniform mat4 uModel;
 uniform mat4 uProj;
 uniform mat4 uView;
 uniform bool uUseInstancing;
+// aPos is unorm16 inside the mesh bounds for packed vertices, identity for float ones
+uniform vec3 uPosOffset;
+uniform vec3 uPosScale;
 
 void main() {
 
@@ -18,7 +21,7 @@ void main() {
         ? mat4(iModelCol0, iModelCol1, iModelCol2, iModelCol3)
         : uModel;
 
-    vec4 worldPos = modelMatrix * vec4(aPos, 1.0);
+    vec4 worldPos = modelMatrix * vec4(uPosOffset + aPos * uPosScale, 1.0);
 
     gl_Position = uProj * uView * worldPos;
 }
\ No newline at end of file
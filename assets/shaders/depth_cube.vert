@@ -8,6 +8,9 @@ layout(location = 7) in vec4 iModelCol3;
 
 uniform mat4 uModel;
 uniform bool uUseInstancing;
+// aPos is unorm16 inside the mesh bounds for packed vertices, identity for float ones
+uniform vec3 uPosOffset;
+uniform vec3 uPosScale;
 
 void main()
 {
@@ -15,5 +18,5 @@ void main()
         ? mat4(iModelCol0, iModelCol1, iModelCol2, iModelCol3)
         : uModel;
 
-    gl_Position = modelMatrix * vec4(aPos, 1.0);
+    gl_Position = modelMatrix * vec4(uPosOffset + aPos * uPosScale, 1.0);
 } 
\ No newline at end of file
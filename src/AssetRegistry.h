@@ -0,0 +1,171 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace ObjectLoader {
+
+// Shared, immutable cache of loaded assets keyed by path, with an LRU memory budget.
+// Assets are moved into the registry once and handed out as shared_ptr<const T>, T must
+// provide `size_t bytes() const`.
+// The registry keeps strong references to the most recently used assets while their total
+// size fits in the budget, older ones are evicted down to a weak reference: they stay shared
+// for as long as somebody still holds them and are freed with the last user. An evicted
+// asset that is still alive is revived on the next lookup instead of being loaded again.
+template <typename T> class AssetRegistry {
+  public:
+    using Handle     = std::shared_ptr<const T>;
+    using WeakHandle = std::weak_ptr<const T>;
+
+    struct Stats {
+        size_t hits      = 0;
+        size_t misses    = 0;
+        size_t evictions = 0;
+        size_t entries   = 0; // strongly held
+        size_t bytes     = 0; // of the strongly held entries
+    };
+
+    explicit AssetRegistry(size_t budget_bytes) : budget(budget_bytes) {}
+
+    AssetRegistry(const AssetRegistry&)            = delete;
+    AssetRegistry& operator=(const AssetRegistry&) = delete;
+
+    // nullptr (counted as a miss) if key is neither cached nor alive elsewhere
+    Handle find(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Handle                      handle = lookup(key);
+        handle ? ++counters.hits : ++counters.misses;
+        return handle;
+    }
+
+    // Takes ownership of value. If another thread inserted key meanwhile, theirs is kept
+    // and returned.
+    Handle insert(const std::string& key, T&& value) {
+        auto                        handle = std::make_shared<const T>(std::move(value));
+        std::lock_guard<std::mutex> lock(mutex);
+        if (Handle existing = lookup(key))
+            return existing;
+        hold(key, handle);
+        return handle;
+    }
+
+    // find(), or load() -> T outside the lock and insert() the result
+    template <typename Loader> Handle get_or_load(const std::string& key, Loader&& load) {
+        if (Handle handle = find(key))
+            return handle;
+        return insert(key, load());
+    }
+
+    // does not count towards the hit/miss counters or the LRU order
+    WeakHandle peek(const std::string& key) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        it = entries.find(key);
+        return it == entries.end() ? WeakHandle{} : it->second.weak;
+    }
+
+    // 0 keeps nothing strongly, everything lives only as long as its users
+    void set_budget(size_t budget_bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budget = budget_bytes;
+        evict_over_budget();
+    }
+
+    size_t get_budget() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return budget;
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Stats out   = counters;
+        out.entries = lru.size();
+        out.bytes   = resident_bytes;
+        return out;
+    }
+
+    // drops every reference the registry holds, the counters are kept
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+        lru.clear();
+        resident_bytes = 0;
+    }
+
+  private:
+    struct Strong {
+        std::string key;
+        Handle      handle;
+        size_t      bytes;
+    };
+    using LruList = std::list<Strong>;
+
+    struct Entry {
+        WeakHandle                weak;
+        typename LruList::iterator strong; // lru.end() once evicted
+    };
+
+    // mutex held; strong entries move to the front, live evicted ones are held again
+    Handle lookup(const std::string& key) {
+        auto it = entries.find(key);
+        if (it == entries.end())
+            return nullptr;
+        Entry& entry = it->second;
+        if (entry.strong != lru.end()) {
+            lru.splice(lru.begin(), lru, entry.strong);
+            return entry.strong->handle;
+        }
+        Handle revived = entry.weak.lock();
+        if (!revived) {
+            entries.erase(it);
+            return nullptr;
+        }
+        hold(key, revived);
+        return revived;
+    }
+
+    // mutex held
+    void hold(const std::string& key, const Handle& handle) {
+        const size_t bytes = handle->bytes();
+        lru.push_front({key, handle, bytes});
+        resident_bytes += bytes;
+        entries[key] = {handle, lru.begin()};
+        evict_over_budget();
+    }
+
+    // mutex held; the most recently used entry is never evicted so an asset larger than
+    // the whole budget can still be shared while it is in use
+    void evict_over_budget() {
+        while (resident_bytes > budget && lru.size() > 1) {
+            evict(std::prev(lru.end()));
+        }
+        if (budget == 0 && !lru.empty())
+            evict(lru.begin());
+    }
+
+    void evict(typename LruList::iterator victim) {
+        resident_bytes -= victim->bytes;
+        auto it = entries.find(victim->key);
+        if (victim->handle.use_count() == 1) {
+            // nobody else has it, forget it entirely
+            entries.erase(it);
+        } else {
+            it->second.strong = lru.end();
+        }
+        lru.erase(victim);
+        ++counters.evictions;
+    }
+
+    mutable std::mutex                     mutex;
+    size_t                                 budget;
+    size_t                                 resident_bytes = 0;
+    Stats                                  counters;
+    LruList                                lru;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+} // namespace ObjectLoader
@@ -0,0 +1,122 @@
+#include "DecodePool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+ObjectLoader::DecodePool::DecodePool(unsigned threads) {
+    if (threads == 0) {
+        unsigned hw = std::thread::hardware_concurrency();
+        threads     = hw > 1 ? hw - 1 : 1;
+    }
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&DecodePool::worker_loop, this);
+    }
+}
+
+ObjectLoader::DecodePool::~DecodePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    work_ready.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ObjectLoader::DecodePool& ObjectLoader::DecodePool::shared() {
+    static DecodePool pool;
+    return pool;
+}
+
+void ObjectLoader::DecodePool::submit(std::string path, std::function<void(Image)> on_decoded) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back({std::move(path), std::move(on_decoded)});
+    }
+    work_ready.notify_one();
+}
+
+void ObjectLoader::DecodePool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this] { return jobs.empty() && running == 0; });
+}
+
+bool ObjectLoader::DecodePool::idle() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.empty() && running == 0;
+}
+
+std::vector<ObjectLoader::DecodeTiming> ObjectLoader::DecodePool::timings() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return decode_timings;
+}
+
+void ObjectLoader::DecodePool::worker_loop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            ++running;
+        }
+
+        auto  start = std::chrono::steady_clock::now();
+        Image image = decode_image(job.path);
+        auto  end   = std::chrono::steady_clock::now();
+
+        DecodeTiming timing;
+        timing.path   = job.path;
+        timing.ms     = std::chrono::duration<double, std::milli>(end - start).count();
+        timing.bytes  = image.bytes();
+        timing.width  = image.width;
+        timing.height = image.height;
+
+        if (job.on_decoded) {
+            job.on_decoded(std::move(image));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decode_timings.push_back(std::move(timing));
+            --running;
+        }
+        work_done.notify_all();
+    }
+}
+
+void ObjectLoader::DecodePool::report(std::ostream& out, size_t max_files) const {
+    std::vector<DecodeTiming> sorted = timings();
+    if (sorted.empty())
+        return;
+
+    double total_ms    = 0.0;
+    size_t total_bytes = 0;
+    size_t failed      = 0;
+    for (const auto& t : sorted) {
+        total_ms += t.ms;
+        total_bytes += t.bytes;
+        failed += t.bytes == 0;
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const DecodeTiming& a, const DecodeTiming& b) { return a.ms > b.ms; });
+
+    char line[64];
+    std::snprintf(line, sizeof(line), "%.1f ms", total_ms);
+    out << "Decoded " << sorted.size() << " textures (" << failed << " failed) on "
+        << thread_count() << " threads, " << line << " of decode time, "
+        << total_bytes / (1024 * 1024) << " MiB of pixels\n";
+
+    const size_t shown = std::min(max_files, sorted.size());
+    for (size_t i = 0; i < shown; ++i) {
+        const auto& t = sorted[i];
+        std::snprintf(line, sizeof(line), "%9.2f ms %5dx%-5d ", t.ms, t.width, t.height);
+        out << line << t.path << "\n";
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Image.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ObjectLoader {
+
+// How long one texture file took to decode, for the startup report.
+struct DecodeTiming {
+    std::string path;
+    double      ms     = 0.0;
+    size_t      bytes  = 0; // decoded size, 0 if the decode failed
+    int         width  = 0;
+    int         height = 0;
+};
+
+// Worker threads that run decode_image() for texture files. Everything submitted while a
+// scene loads is decoded concurrently, the callbacks hand the pixels on (to the GL upload
+// queue for the game) so the submitting thread never waits on stb_image/libtiff.
+class DecodePool {
+  public:
+    // 0 picks hardware_concurrency() - 1, leaving a core for the thread that submits
+    explicit DecodePool(unsigned threads = 0);
+    // drops jobs that have not started and joins the workers
+    ~DecodePool();
+
+    DecodePool(const DecodePool&)            = delete;
+    DecodePool& operator=(const DecodePool&) = delete;
+
+    // on_decoded runs on a worker thread, also for failed decodes (image.valid() is false)
+    void submit(std::string path, std::function<void(Image)> on_decoded);
+
+    // blocks until every submitted file has been decoded and its callback returned
+    void wait();
+
+    bool idle() const;
+
+    inline unsigned thread_count() const {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    // per file decode times in completion order
+    std::vector<DecodeTiming> timings() const;
+
+    // prints the max_files slowest decodes plus totals, does nothing if nothing was decoded
+    void report(std::ostream& out, size_t max_files = 10) const;
+
+    // the pool the material loaders submit to
+    static DecodePool& shared();
+
+  private:
+    struct Job {
+        std::string                path;
+        std::function<void(Image)> on_decoded;
+    };
+
+    void worker_loop();
+
+    mutable std::mutex        mutex;
+    std::condition_variable   work_ready;
+    std::condition_variable   work_done;
+    std::deque<Job>           jobs;
+    size_t                    running  = 0;
+    bool                      stopping = false;
+    std::vector<DecodeTiming> decode_timings;
+    std::vector<std::thread>  workers;
+};
+
+} // namespace ObjectLoader
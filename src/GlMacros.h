@@ -25,5 +25,21 @@ static bool GLLogCall(const char* function, const char* file, int line) {
     }
     return true;
 }
+
+// the VAO bind_vertex_array() bound last
+inline GLuint& bound_vertex_array() {
+    static GLuint bound = 0;
+    return bound;
+}
+
+// glBindVertexArray that skips the call when vao is bound already, returns whether it bound.
+// Only right as long as every VAO bind goes through here.
+inline bool bind_vertex_array(GLuint vao) {
+    if (bound_vertex_array() == vao)
+        return false;
+    GLCall(glBindVertexArray(vao));
+    bound_vertex_array() = vao;
+    return true;
+}
 } // namespace GlHelpers
 #endif
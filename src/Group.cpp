@@ -1,6 +1,7 @@
 #include "Group.h"
 #include "ext/matrix_transform.hpp"
 #include <glm/gtc/matrix_transform.hpp>
+#include <unordered_map>
 
 Group::Group(const std::string& room_name,
            const glm::vec3&   room_position)
@@ -81,21 +82,24 @@ Group& Group::walls(Models::Model& wall_model,
 }
 
 
+glm::mat4 Group::entry_transform(const Entry& e, const glm::mat4& base) const {
+    glm::mat4 xf = glm::translate(base, position + e.position);
+    if (e.scale) {
+        xf = glm::scale(xf, *e.scale);
+    }
+    if (e.rotation) {
+        xf = glm::rotate(xf, glm::radians(e.rotation->first), e.rotation->second);
+    }
+    return xf;
+}
+
 std::vector<std::unique_ptr<Models::Model>> Group::models() const {
     std::vector<std::unique_ptr<Models::Model>> result;
     result.reserve(entries.size());
 
     for (auto& e : entries) {
         auto m = std::make_unique<Models::Model>(e.file, name + "-" + e.model_name);
-        glm::mat4 xf = m->get_local_transform();
-        xf = glm::translate(xf, position + e.position);
-        if (e.scale) {
-            xf = glm::scale(xf, *e.scale);
-        }
-        if (e.rotation) {
-            xf = glm::rotate(xf, glm::radians(e.rotation->first), e.rotation->second);
-        }
-        m->set_local_transform(xf);
+        m->set_local_transform(entry_transform(e, m->get_local_transform()));
         if (e.interactive) {
             m->set_interactivity(true);
         }
@@ -105,3 +109,59 @@ std::vector<std::unique_ptr<Models::Model>> Group::models() const {
     return result;
 }
 
+std::vector<std::pair<std::string, std::unique_ptr<Models::Model>>>
+Group::instanced_models(const std::vector<const Group*>& groups, GroupInstancingStats* stats) {
+    struct Placement {
+        const Group* group;
+        const Entry* entry;
+    };
+    // one bucket per file and interactivity, in the order the files first show up
+    std::vector<std::vector<Placement>>     buckets;
+    std::unordered_map<std::string, size_t> bucket_of;
+    for (const Group* group : groups) {
+        for (const Entry& e : group->entries) {
+            std::string key = e.file + (e.interactive ? "#interactive" : "");
+            auto [it, added] = bucket_of.emplace(std::move(key), buckets.size());
+            if (added) {
+                buckets.emplace_back();
+            }
+            buckets[it->second].push_back({group, &e});
+        }
+    }
+
+    std::vector<std::pair<std::string, std::unique_ptr<Models::Model>>> result;
+    result.reserve(buckets.size());
+    GroupInstancingStats counted;
+    for (const auto& bucket : buckets) {
+        const Entry& first = *bucket.front().entry;
+        counted.entries += bucket.size();
+        ++counted.models;
+        if (bucket.size() == 1) {
+            auto m = std::make_unique<Models::Model>(
+                first.file, bucket.front().group->name + "-" + first.model_name);
+            m->set_local_transform(
+                bucket.front().group->entry_transform(first, m->get_local_transform()));
+            m->set_interactivity(first.interactive);
+            std::string registered = m->name();
+            result.emplace_back(std::move(registered), std::move(m));
+            continue;
+        }
+
+        ++counted.instanced;
+        auto m = std::make_unique<Models::Model>(first.file, "");
+        m->init_instancing(bucket.size());
+        for (const Placement& p : bucket) {
+            m->add_instance_transform(
+                p.group->entry_transform(*p.entry, m->get_local_transform()),
+                p.group->name + "-" + p.entry->model_name);
+        }
+        m->set_interactivity(first.interactive);
+        result.emplace_back(first.file + (first.interactive ? "#interactive" : ""),
+                            std::move(m));
+    }
+
+    if (stats) {
+        *stats = counted;
+    }
+    return result;
+}
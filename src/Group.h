@@ -9,6 +9,13 @@
 #include <glm/glm.hpp>
 #include "Model.h"
 
+// What Group::instanced_models() collapsed: entries placed and the models that draw them
+struct GroupInstancingStats {
+    size_t entries   = 0;
+    size_t models    = 0;
+    size_t instanced = 0; // models of the ones above that draw more than one entry
+};
+
 class Group {
 public:
     using Rotation = std::pair<float, glm::vec3>; // angle in radians, axis
@@ -31,6 +38,14 @@ public:
     // Build and return all models with transforms applied
     std::vector<std::unique_ptr<Models::Model>> models() const;
 
+    // Builds the models of several groups at once. Entries that place the same file with the
+    // same interactivity become the instances of one model, named like models() names the
+    // entries so name(i) is still "room-1-door"; that model's own label is empty. Files placed
+    // once get a model of their own. Each model comes with the name to register it under.
+    static std::vector<std::pair<std::string, std::unique_ptr<Models::Model>>>
+    instanced_models(const std::vector<const Group*>& groups,
+                     GroupInstancingStats*            stats = nullptr);
+
     inline glm::vec3 room_position() {
         return position;
     }
@@ -45,6 +60,8 @@ private:
         bool        interactive;
     };
 
+    glm::mat4 entry_transform(const Entry& e, const glm::mat4& base) const;
+
     std::string        name;
     glm::vec3          position;
     std::vector<Entry> entries;
@@ -0,0 +1,91 @@
+#include "Image.h"
+#include "tiffio.h"
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include <cstring>
+#include <iostream>
+
+static bool fileExtensionIs(const std::string& filename, const std::string& extension) {
+    auto pos = filename.rfind(extension);
+
+    if (pos != std::string::npos && (filename.substr(pos, filename.size()) == extension))
+        return true;
+
+    return false;
+}
+
+static ObjectLoader::Image decode_tiff(const std::string& filename) {
+    ObjectLoader::Image image;
+    image.path = filename;
+
+    TIFF* tif = TIFFOpen(filename.c_str(), "r");
+    if (!tif) {
+        std::cerr << "Failed to open TIFF: " << filename << "\n";
+        return image;
+    }
+
+    uint32_t width, height;
+    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+
+    std::vector<uint32_t> raster(width * height);
+    if (!TIFFReadRGBAImage(tif, width, height, raster.data(), 0)) {
+        std::cerr << "Failed to read TIFF image data from: " << filename << "\n";
+        TIFFClose(tif);
+        return image;
+    }
+
+    // TIFF is bottom-up; reverse vertically if needed
+    std::vector<uint8_t> data(width * height * 4);
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            uint32_t pixel                = raster[(height - 1 - y) * width + x];
+            data[4 * (y * width + x) + 0] = TIFFGetR(pixel);
+            data[4 * (y * width + x) + 1] = TIFFGetG(pixel);
+            data[4 * (y * width + x) + 2] = TIFFGetB(pixel);
+            data[4 * (y * width + x) + 3] = TIFFGetA(pixel);
+        }
+    }
+    TIFFClose(tif);
+
+    image.width    = static_cast<int>(width);
+    image.height   = static_cast<int>(height);
+    image.channels = 4;
+    image.pixels   = std::move(data);
+    return image;
+}
+
+ObjectLoader::Image ObjectLoader::decode_image(const std::string& filepath) {
+    if (fileExtensionIs(filepath, ".tif")) {
+        return decode_tiff(filepath);
+    }
+
+    Image image;
+    image.path = filepath;
+
+    // the upload only knows RGB and RGBA, so grey(+alpha) files are expanded while decoding
+    int width, height, channels;
+    int wanted = 0;
+    if (stbi_info(filepath.c_str(), &width, &height, &channels) && channels < 3) {
+        wanted = channels == 2 ? 4 : 3;
+    }
+
+    // per thread so images can be decoded concurrently
+    stbi_set_flip_vertically_on_load_thread(true);
+    unsigned char* data = stbi_load(filepath.c_str(), &width, &height, &channels, wanted);
+
+    if (!data) {
+        std::cerr << "Failed to load texture " << filepath << "\n";
+        return image;
+    }
+    if (wanted != 0) {
+        channels = wanted;
+    }
+
+    image.width    = width;
+    image.height   = height;
+    image.channels = channels;
+    image.pixels.assign(data, data + size_t(width) * height * channels);
+    stbi_image_free(data);
+    return image;
+}
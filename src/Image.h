@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ObjectLoader {
+
+// A decoded texture file: tightly packed 8-bit pixels with 3 (RGB) or 4 (RGBA) channels,
+// flipped the way the GL upload expects. Pure CPU data, safe to build on any thread.
+struct Image {
+    std::string          path;
+    int                  width    = 0;
+    int                  height   = 0;
+    int                  channels = 0;
+    std::vector<uint8_t> pixels;
+
+    inline bool valid() const {
+        return !pixels.empty();
+    }
+
+    inline size_t bytes() const {
+        return pixels.size();
+    }
+};
+
+// Decodes a .tif through libtiff and anything else through stb_image.
+// Returns an invalid Image (and logs) when the file cannot be read.
+Image decode_image(const std::string& path);
+
+} // namespace ObjectLoader
@@ -0,0 +1,183 @@
+#include "InstanceStream.h"
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+using namespace GlHelpers;
+
+void Models::bind_instance_attributes(uint32_t first) {
+    const size_t base = size_t(first) * sizeof(InstanceData);
+    // the transform, one vec4 per column
+    for (GLuint i = 0; i < 4; ++i) {
+        GLCall(glEnableVertexAttribArray(4 + i));
+        GLCall(glVertexAttribPointer(4 + i, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                                     (void*)(base + sizeof(glm::vec4) * i)));
+        GLCall(glVertexAttribDivisor(4 + i, 1));
+    }
+    const size_t attributes = base + offsetof(InstanceData, attributes);
+    GLCall(glEnableVertexAttribArray(8));
+    GLCall(glVertexAttribPointer(8, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(InstanceData),
+                                 (void*)(attributes + offsetof(InstanceAttributes, tint))));
+    GLCall(glVertexAttribDivisor(8, 1));
+    // flags and variant stay integers
+    GLCall(glEnableVertexAttribArray(9));
+    GLCall(glVertexAttribIPointer(9, 2, GL_UNSIGNED_INT, sizeof(InstanceData),
+                                  (void*)(attributes + offsetof(InstanceAttributes, flags))));
+    GLCall(glVertexAttribDivisor(9, 1));
+}
+
+Models::InstanceStream::InstanceStream(size_t segment_bytes, uint32_t segments)
+    : segment_size(segment_bytes / sizeof(InstanceData)), segments(segments) {}
+
+Models::InstanceStream::~InstanceStream() {
+    // the GL objects go with the context, this only runs at exit
+}
+
+Models::InstanceStream& Models::InstanceStream::shared() {
+    static InstanceStream stream;
+    return stream;
+}
+
+GLuint Models::InstanceStream::buffer() {
+    if (!vbo)
+        create();
+    return vbo;
+}
+
+void Models::InstanceStream::create() {
+    const GLsizeiptr bytes = GLsizeiptr(segment_size * segments.size() * sizeof(InstanceData));
+    if (GLEW_ARB_buffer_storage) {
+        GLCall(glGenBuffers(1, &vbo));
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLCall(glBufferStorage(GL_ARRAY_BUFFER, bytes, nullptr, flags));
+        mapped = static_cast<InstanceData*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, flags));
+        if (mapped)
+            return;
+        // immutable storage can not be respecified, start over with a buffer that can
+        std::cerr << "Could not map the instance stream persistently, orphaning it instead\n";
+        GLCall(glDeleteBuffers(1, &vbo));
+    }
+    GLCall(glGenBuffers(1, &vbo));
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+    GLCall(glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW));
+}
+
+void Models::InstanceStream::drop_persistence() {
+    for (auto& segment : segments) {
+        if (segment.fence)
+            glDeleteSync(segment.fence);
+        segment.fence = nullptr;
+        segment.used  = false;
+        segment.generation++;
+    }
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+    GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+    // queued draws keep the old storage alive, the Models rebind to the new buffer
+    GLCall(glDeleteBuffers(1, &vbo));
+    mapped = nullptr;
+    vbo    = 0;
+    const GLsizeiptr bytes = GLsizeiptr(segment_size * segments.size() * sizeof(InstanceData));
+    GLCall(glGenBuffers(1, &vbo));
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+    GLCall(glBufferData(GL_ARRAY_BUFFER, bytes, nullptr, GL_STREAM_DRAW));
+}
+
+void Models::InstanceStream::recycle(uint32_t s) {
+    Segment& segment = segments[s];
+    if (segment.used && !segment.fence) {
+        // draws of this very frame still read it
+        segment.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    if (segment.fence) {
+        GLenum status;
+        do {
+            status = glClientWaitSync(segment.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        if (status == GL_WAIT_FAILED) {
+            // nothing says when the GPU is done with the segment, stop reusing storage
+            std::cerr << "Instance stream fence wait failed, orphaning the buffer instead\n";
+            drop_persistence();
+            return;
+        }
+        glDeleteSync(segment.fence);
+        segment.fence = nullptr;
+    }
+    segment.used = false;
+    segment.generation++;
+}
+
+Models::InstanceRange Models::InstanceStream::write(const InstanceData* instances,
+                                                   uint32_t            count) {
+    if (count > segment_size) {
+        throw std::runtime_error("instance list does not fit in an instance stream segment");
+    }
+    buffer();
+    if (cursor + count > segment_size) {
+        current = (current + 1) % static_cast<uint32_t>(segments.size());
+        cursor  = 0;
+        if (persistent()) {
+            recycle(current);
+        } else if (current == 0) {
+            // new storage for the whole ring, draws already queued keep the old one
+            GLCall(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+            GLCall(glBufferData(GL_ARRAY_BUFFER,
+                                GLsizeiptr(segment_size * segments.size() * sizeof(InstanceData)),
+                                nullptr, GL_STREAM_DRAW));
+            for (auto& segment : segments)
+                segment.generation++;
+        }
+    }
+
+    InstanceRange range;
+    range.first      = static_cast<uint32_t>(current * segment_size + cursor);
+    range.count      = count;
+    range.segment    = current;
+    range.generation = segments[current].generation;
+    cursor += count;
+    written += uint64_t(count) * sizeof(InstanceData);
+    if (count == 0)
+        return range;
+
+    const size_t bytes = size_t(count) * sizeof(InstanceData);
+    if (persistent()) {
+        std::memcpy(mapped + range.first, instances, bytes);
+    } else {
+        // nothing queued reads this range since the buffer was last orphaned
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, vbo));
+        const GLintptr offset = GLintptr(range.first) * sizeof(InstanceData);
+        void* dst = glMapBufferRange(GL_ARRAY_BUFFER, offset, GLsizeiptr(bytes),
+                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                                         GL_MAP_UNSYNCHRONIZED_BIT);
+        if (dst) {
+            std::memcpy(dst, instances, bytes);
+            GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+        } else {
+            GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, GLsizeiptr(bytes), instances));
+        }
+    }
+    return range;
+}
+
+bool Models::InstanceStream::valid(const InstanceRange& range) const {
+    return range.segment < segments.size() &&
+           segments[range.segment].generation == range.generation;
+}
+
+void Models::InstanceStream::use(const InstanceRange& range) {
+    segments[range.segment].used = true;
+}
+
+void Models::InstanceStream::end_frame() {
+    if (!persistent())
+        return;
+    for (auto& segment : segments) {
+        if (!segment.used)
+            continue;
+        // one fence per frame and segment is enough, the newest one covers the older draws
+        if (segment.fence)
+            glDeleteSync(segment.fence);
+        segment.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        segment.used  = false;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "GlMacros.h"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Models {
+
+    enum InstanceFlags : uint32_t {
+        INSTANCE_HIGHLIGHT = 1u << 0, // brightened, for the interactable the player can use
+    };
+
+    // What an instance carries next to its transform, the same for every draw of it
+    struct InstanceAttributes {
+        uint32_t tint    = 0xffffffffu; // RGBA8 as glm::packUnorm4x8 packs it, scales the colour
+        uint32_t flags   = 0;           // InstanceFlags
+        uint32_t variant = 0;           // material variant, 0 is the material as loaded
+        uint32_t unused  = 0;           // keeps the records 16 byte aligned
+    };
+
+    // One instance as the shaders read it: the transform at attribute locations 4 to 7, the
+    // tint at 8, flags and variant at 9. A new channel goes at the end of InstanceAttributes,
+    // with its attribute in bind_instance_attributes() and its input in blinnphong.vert.
+    struct InstanceData {
+        glm::mat4          transform;
+        InstanceAttributes attributes;
+    };
+    static_assert(sizeof(InstanceData) == 80, "instance records are read with a stride of 80");
+
+    // Points the instance attributes of the bound VAO at the stream buffer (bound to
+    // GL_ARRAY_BUFFER), starting at record first, advancing once per instance
+    void bind_instance_attributes(uint32_t first);
+
+    // Instances written into the stream, valid while InstanceStream::valid() says so
+    struct InstanceRange {
+        uint32_t first      = 0; // in records from the start of the buffer
+        uint32_t count      = 0;
+        uint32_t segment    = 0;
+        uint64_t generation = 0; // 0 never matches, a default range is never valid
+    };
+
+    // Ring buffer every instanced Model streams its per view instance records through.
+    // The ring is split into segments, a range lives in one of them and stays valid until the
+    // write cursor comes back around to it, so a list that did not change is drawn again
+    // without being written again.
+    // With ARB_buffer_storage the buffer is mapped once (persistent, coherent) and a fence per
+    // segment keeps the cursor from overwriting what queued draws still read. Without it the
+    // whole buffer is orphaned when the cursor wraps and writes map their range unsynchronized.
+    // GL thread only.
+    class InstanceStream {
+    public:
+        explicit InstanceStream(size_t segment_bytes = 1u << 20, uint32_t segments = 4);
+        ~InstanceStream();
+
+        InstanceStream(const InstanceStream&)            = delete;
+        InstanceStream& operator=(const InstanceStream&) = delete;
+
+        // Copies count records into the ring, throws when they do not fit in a segment
+        InstanceRange write(const InstanceData* instances, uint32_t count);
+        bool          valid(const InstanceRange& range) const;
+        // the draws of this frame read range, keeps its segment from being overwritten until
+        // the GPU is done with them
+        void use(const InstanceRange& range);
+        // fences the segments used since the last call, once per frame after the draws
+        void end_frame();
+
+        // the GL buffer, created on first use. It changes if the persistent mapping is dropped,
+        // draws check it against the one their VAO reads.
+        GLuint buffer();
+
+        inline bool persistent() const {
+            return mapped != nullptr;
+        }
+
+        // bytes written since the start, for the frame stats
+        inline uint64_t bytes_written() const {
+            return written;
+        }
+
+        // the stream the Models draw from
+        static InstanceStream& shared();
+
+    private:
+        struct Segment {
+            uint64_t generation = 1;
+            GLsync   fence      = nullptr;
+            bool     used       = false; // read by draws that are not fenced yet
+        };
+
+        void create();
+        // makes segment s writable again, everything in it stops being valid. Drops the
+        // persistent mapping when the fence wait fails.
+        void recycle(uint32_t s);
+        // moves the stream to a new, unmapped buffer that is orphaned on wrap from then on,
+        // every range stops being valid
+        void drop_persistence();
+
+        size_t               segment_size; // in records
+        std::vector<Segment> segments;
+        GLuint               vbo     = 0;
+        InstanceData*        mapped  = nullptr;
+        uint32_t             current = 0; // segment the cursor is in
+        size_t               cursor  = 0; // next free record in it
+        uint64_t             written = 0;
+    };
+
+} // namespace Models
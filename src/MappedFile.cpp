@@ -0,0 +1,100 @@
+#include "MappedFile.h"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OBJLOADER_HAS_MMAP 1
+#endif
+
+ObjectLoader::MappedFile::MappedFile(const std::string& path) {
+#ifdef OBJLOADER_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + path);
+    }
+    size = static_cast<std::size_t>(st.st_size);
+    if (size > 0) {
+        void* ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Failed to mmap file: " + path);
+        }
+        // the parsers walk the file front to back exactly once
+        ::madvise(ptr, size, MADV_SEQUENTIAL);
+        data   = static_cast<const char*>(ptr);
+        mapped = true;
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+#else
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    file.seekg(0, std::ios::end);
+    fallback_buffer.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(fallback_buffer.data(), fallback_buffer.size());
+    data = fallback_buffer.data();
+    size = fallback_buffer.size();
+#endif
+}
+
+ObjectLoader::MappedFile::~MappedFile() {
+    release();
+}
+
+ObjectLoader::MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+ObjectLoader::MappedFile& ObjectLoader::MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        mapped          = std::exchange(other.mapped, false);
+        size            = std::exchange(other.size, 0);
+        fallback_buffer = std::move(other.fallback_buffer);
+        data = mapped ? std::exchange(other.data, nullptr) : fallback_buffer.data();
+        other.data = nullptr;
+    }
+    return *this;
+}
+
+void ObjectLoader::MappedFile::release() {
+#ifdef OBJLOADER_HAS_MMAP
+    if (mapped && data) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+#endif
+    data   = nullptr;
+    size   = 0;
+    mapped = false;
+    fallback_buffer.clear();
+}
+
+uint64_t ObjectLoader::hash_bytes(std::string_view bytes) {
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t       h     = 1469598103934665603ULL ^ bytes.size();
+    const char*    p     = bytes.data();
+    std::size_t    n     = bytes.size();
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = (h ^ word) * prime;
+        h ^= h >> 29;
+    }
+    for (; n > 0; ++p, --n)
+        h = (h ^ static_cast<unsigned char>(*p)) * prime;
+    return h;
+}
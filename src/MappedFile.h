@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ObjectLoader {
+
+// Read-only view of a whole file on disk.
+// On POSIX systems the file is mmap'd so the parsers can tokenize straight over the
+// page cache without copying, elsewhere it falls back to reading into a buffer.
+class MappedFile {
+  public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    inline std::string_view view() const {
+        return {data, size};
+    }
+
+    inline std::size_t bytes() const {
+        return size;
+    }
+
+  private:
+    void release();
+
+    const char* data   = nullptr;
+    std::size_t size   = 0;
+    bool        mapped = false;
+    std::string fallback_buffer;
+};
+
+// Cheap 64-bit content hash (FNV-1a over 8 byte words), used to key on-disk caches.
+// Not cryptographic, it only has to notice that an asset was edited.
+uint64_t hash_bytes(std::string_view bytes);
+
+// Returns the next line of `text` starting at `pos` (without the '\n' or a trailing '\r')
+// and advances `pos` past the line terminator.
+inline std::string_view next_line(std::string_view text, std::size_t& pos) {
+    const std::size_t start = pos;
+    std::size_t       eol   = text.find('\n', start);
+    if (eol == std::string_view::npos) {
+        eol = text.size();
+        pos = text.size();
+    } else {
+        pos = eol + 1;
+    }
+    std::size_t end = eol;
+    if (end > start && text[end - 1] == '\r')
+        --end;
+    return text.substr(start, end - start);
+}
+
+} // namespace ObjectLoader
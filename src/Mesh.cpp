@@ -0,0 +1,532 @@
+#include "Mesh.h"
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+    // Open-addressing map from three int32 (an OBJ v/vt/vn triplet, or a grid cell) to a
+    // uint32, linear probing over one flat array. It is sized once for the most entries it
+    // will get and kept at most half full, so it never rehashes.
+    class TripletTable {
+      public:
+        explicit TripletTable(size_t max_entries) {
+            size_t size = 16;
+            while (size < max_entries * 2)
+                size <<= 1;
+            slots.resize(size);
+            mask = size - 1;
+        }
+
+        // The value stored for (a, b, c), or value newly stored for it. inserted tells which.
+        uint32_t& insert(int32_t a, int32_t b, int32_t c, uint32_t value, bool& inserted) {
+            size_t slot  = hash(a, b, c) & mask;
+            size_t probe = 0;
+            for (; slots[slot].value != EMPTY; slot = (slot + 1) & mask, ++probe) {
+                Slot& s = slots[slot];
+                if (s.a == a && s.b == b && s.c == c) {
+                    count_probes(probe);
+                    inserted = false;
+                    return s.value;
+                }
+            }
+            count_probes(probe);
+            slots[slot] = {a, b, c, value};
+            inserted    = true;
+            return slots[slot].value;
+        }
+
+        // nullptr if (a, b, c) is not in the table
+        const uint32_t* find(int32_t a, int32_t b, int32_t c) const {
+            for (size_t slot = hash(a, b, c) & mask; slots[slot].value != EMPTY;
+                 slot        = (slot + 1) & mask) {
+                const Slot& s = slots[slot];
+                if (s.a == a && s.b == b && s.c == c)
+                    return &s.value;
+            }
+            return nullptr;
+        }
+
+        inline size_t size() const {
+            return slots.size();
+        }
+
+        size_t probes    = 0;
+        size_t max_probe = 0;
+
+      private:
+        static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+
+        struct Slot {
+            int32_t  a = 0, b = 0, c = 0;
+            uint32_t value = EMPTY;
+        };
+
+        // the indices of neighbouring corners are close together, the multiplies spread them
+        // over the whole table before the low bits are used
+        static inline size_t hash(int32_t a, int32_t b, int32_t c) {
+            uint64_t h = static_cast<uint32_t>(a) * 0x9E3779B97F4A7C15ull +
+                         static_cast<uint32_t>(b) * 0xC2B2AE3D27D4EB4Full +
+                         static_cast<uint32_t>(c) * 0x165667B19E3779F9ull;
+            h ^= h >> 29;
+            h *= 0xBF58476D1CE4E5B9ull;
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+
+        inline void count_probes(size_t probe) {
+            probes += probe;
+            max_probe = std::max(max_probe, probe);
+        }
+
+        std::vector<Slot> slots;
+        size_t            mask;
+    };
+
+    bool near_equal(const Models::Vertex& a, const Models::Vertex& b, float epsilon) {
+        return glm::all(glm::epsilonEqual(a.position, b.position, epsilon)) &&
+               glm::all(glm::epsilonEqual(a.texcoord, b.texcoord, epsilon)) &&
+               glm::all(glm::epsilonEqual(a.normal, b.normal, epsilon));
+    }
+
+    // Merges every vertex into the first earlier one whose attributes are all within epsilon
+    // and drops it, the survivors keep their order. Positions are bucketed on a grid of cells
+    // much larger than epsilon, so a match is almost always in the vertex's own cell and a
+    // neighbouring cell is only searched when the position is within epsilon of its border.
+    // Returns how many vertices were merged.
+    size_t weld_near(std::vector<Models::Vertex>& vertices, std::vector<uint32_t>& indices,
+                     float epsilon) {
+        constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+        const double       cell = 64.0 * epsilon;
+
+        TripletTable          grid(vertices.size());
+        std::vector<uint32_t> next(vertices.size(), NONE); // earlier survivors in the same cell
+        std::vector<uint32_t> remap(vertices.size());
+        size_t                welded = 0;
+
+        for (uint32_t i = 0; i < vertices.size(); ++i) {
+            const glm::vec3& p = vertices[i].position;
+            int64_t          home[3], low[3], high[3];
+            for (int axis = 0; axis < 3; ++axis) {
+                const double x = p[axis];
+                home[axis]     = static_cast<int64_t>(std::floor(x / cell));
+                low[axis]      = home[axis] - (x - epsilon < home[axis] * cell);
+                high[axis]     = home[axis] + (x + epsilon >= (home[axis] + 1) * cell);
+            }
+            // cells far apart may wrap onto the same key, that only adds candidates
+            auto key = [](int64_t k) { return static_cast<int32_t>(k); };
+
+            uint32_t match = NONE;
+            for (int64_t x = low[0]; x <= high[0] && match == NONE; ++x)
+                for (int64_t y = low[1]; y <= high[1] && match == NONE; ++y)
+                    for (int64_t z = low[2]; z <= high[2] && match == NONE; ++z) {
+                        const uint32_t* head = grid.find(key(x), key(y), key(z));
+                        for (uint32_t j = head ? *head : NONE; j != NONE; j = next[j]) {
+                            if (near_equal(vertices[j], vertices[i], epsilon)) {
+                                match = j;
+                                break;
+                            }
+                        }
+                    }
+
+            if (match != NONE) {
+                remap[i] = match;
+                ++welded;
+                continue;
+            }
+            remap[i] = i;
+            bool      inserted;
+            uint32_t& head = grid.insert(key(home[0]), key(home[1]), key(home[2]), i, inserted);
+            if (!inserted) {
+                next[i] = head;
+                head    = i;
+            }
+        }
+        if (welded == 0)
+            return 0;
+
+        // survivors move down in order, merged vertices take their survivor's new index
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < vertices.size(); ++i) {
+            if (remap[i] == i) {
+                vertices[kept] = vertices[i];
+                remap[i]       = kept++;
+            } else {
+                remap[i] = remap[remap[i]];
+            }
+        }
+        vertices.resize(kept);
+        for (auto& index : indices)
+            index = remap[index];
+        return welded;
+    }
+
+    // compute_tangents() gives every thread at least this many triangles, below that starting
+    // the threads costs more than they save
+    constexpr size_t PARALLEL_TANGENT_MIN_TRIANGLES = 16 * 1024;
+    // triangles gathered into SoA arrays at a time, small enough to stay in L1
+    constexpr size_t TANGENT_BATCH = 256;
+
+    // 1 / the determinant of the UV edges. Triangles whose UVs (nearly) lie on a line have no
+    // tangent space and a huge 1 / det would drown their neighbours, so it is capped at
+    // 1 / limit and goes to 0 with the UV area. Branch free, so the batches vectorise.
+    inline float uv_inverse_determinant(float du1, float dv1, float du2, float dv2) {
+        const float det   = du1 * dv2 - du2 * dv1;
+        const float limit = 1e-6f * (du1 * du1 + dv1 * dv1 + du2 * du2 + dv2 * dv2);
+        return det / std::max(std::max(det * det, limit * limit),
+                              std::numeric_limits<float>::min());
+    }
+
+    // Runs work(begin, end) over [0, count) cut into chunk_count even pieces, the last one on
+    // the calling thread
+    template <typename Work>
+    void run_chunks(size_t count, size_t chunk_count, const Work& work) {
+        std::vector<std::thread> workers;
+        workers.reserve(chunk_count - 1);
+        for (size_t i = 0; i + 1 < chunk_count; ++i) {
+            workers.emplace_back(
+                [&, i]() { work(count * i / chunk_count, count * (i + 1) / chunk_count); });
+        }
+        work(count * (chunk_count - 1) / chunk_count, count);
+        for (auto& worker : workers)
+            worker.join();
+    }
+
+    struct TriangleTangent {
+        glm::vec3 tangent;
+        glm::vec3 bitangent;
+    };
+
+    // calculate_tangent_bitangent() for the triangles [begin, end). The corners are gathered
+    // batch by batch into SoA arrays first, zero padded to a whole batch, so the arithmetic
+    // runs over fixed size float arrays the compiler vectorises even at -O2.
+    void triangle_tangents(const std::vector<Models::Vertex>& vertices, const uint32_t* indices,
+                           size_t begin, size_t end, TriangleTangent* out) {
+        float edge1[3][TANGENT_BATCH], edge2[3][TANGENT_BATCH];
+        float du1[TANGENT_BATCH], dv1[TANGENT_BATCH], du2[TANGENT_BATCH], dv2[TANGENT_BATCH];
+        float r[TANGENT_BATCH], t[3][TANGENT_BATCH], b[3][TANGENT_BATCH];
+        for (size_t first = begin; first < end; first += TANGENT_BATCH) {
+            const size_t count = std::min(TANGENT_BATCH, end - first);
+            for (size_t i = 0; i < TANGENT_BATCH; ++i) {
+                if (i == count) {
+                    for (int axis = 0; axis < 3; ++axis) {
+                        std::fill(edge1[axis] + i, edge1[axis] + TANGENT_BATCH, 0.0f);
+                        std::fill(edge2[axis] + i, edge2[axis] + TANGENT_BATCH, 0.0f);
+                    }
+                    std::fill(du1 + i, du1 + TANGENT_BATCH, 0.0f);
+                    std::fill(dv1 + i, dv1 + TANGENT_BATCH, 0.0f);
+                    std::fill(du2 + i, du2 + TANGENT_BATCH, 0.0f);
+                    std::fill(dv2 + i, dv2 + TANGENT_BATCH, 0.0f);
+                    break;
+                }
+                const uint32_t*       triangle = indices + (first + i) * 3;
+                const Models::Vertex& v0       = vertices[triangle[0]];
+                const Models::Vertex& v1       = vertices[triangle[1]];
+                const Models::Vertex& v2       = vertices[triangle[2]];
+                for (int axis = 0; axis < 3; ++axis) {
+                    edge1[axis][i] = v1.position[axis] - v0.position[axis];
+                    edge2[axis][i] = v2.position[axis] - v0.position[axis];
+                }
+                du1[i] = v1.texcoord.x - v0.texcoord.x;
+                dv1[i] = v1.texcoord.y - v0.texcoord.y;
+                du2[i] = v2.texcoord.x - v0.texcoord.x;
+                dv2[i] = v2.texcoord.y - v0.texcoord.y;
+            }
+            for (size_t i = 0; i < TANGENT_BATCH; ++i)
+                r[i] = uv_inverse_determinant(du1[i], dv1[i], du2[i], dv2[i]);
+            for (int axis = 0; axis < 3; ++axis) {
+                for (size_t i = 0; i < TANGENT_BATCH; ++i) {
+                    t[axis][i] = r[i] * (dv2[i] * edge1[axis][i] - dv1[i] * edge2[axis][i]);
+                    b[axis][i] = r[i] * (-du2[i] * edge1[axis][i] + du1[i] * edge2[axis][i]);
+                }
+            }
+            for (size_t i = 0; i < count; ++i) {
+                out[first + i].tangent   = glm::vec3(t[0][i], t[1][i], t[2][i]);
+                out[first + i].bitangent = glm::vec3(b[0][i], b[1][i], b[2][i]);
+            }
+        }
+    }
+
+    // Gram–Schmidt orthogonalizes the summed tangent against the normal and stores it with
+    // the handedness (±1) the shader rebuilds the bitangent with. A vertex whose triangles
+    // all had degenerate UVs gets some direction perpendicular to its normal.
+    void store_tangent(Models::Vertex& vertex, const glm::vec3& tangent,
+                       const glm::vec3& bitangent) {
+        const glm::vec3& normal       = vertex.normal;
+        glm::vec3        orth_tangent = tangent - normal * glm::dot(normal, tangent);
+        float            length2      = glm::dot(orth_tangent, orth_tangent);
+        if (!(length2 > std::numeric_limits<float>::min()) || !std::isfinite(length2)) {
+            orth_tangent = glm::cross(normal, std::abs(normal.x) < 0.9f ? glm::vec3(1, 0, 0)
+                                                                         : glm::vec3(0, 1, 0));
+            length2      = glm::dot(orth_tangent, orth_tangent);
+            if (!(length2 > 0.0f)) {
+                orth_tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+                length2      = 1.0f;
+            }
+        }
+        orth_tangent *= glm::inversesqrt(length2);
+
+        float handedness =
+            (glm::dot(glm::cross(normal, orth_tangent), bitangent) < 0.0f) ? -1.0f : 1.0f;
+        vertex.tangent = glm::vec4(orth_tangent, handedness);
+    }
+
+} // namespace
+
+Models::MeshData Models::build_mesh(const ObjectLoader::ModelData& model_data,
+                                    const WeldOptions& options, WeldStats* stats) {
+    MeshData mesh;
+    auto&    unique_vertices = mesh.vertices;
+
+    // one table entry per distinct (v, vt, vn), at most one per corner
+    const auto&  faces = model_data.m_faces;
+    TripletTable triplets(faces.corner_count());
+    size_t       corners = 0;
+
+    // bucket indices by material_id
+    std::unordered_map<int, std::vector<uint32_t>> buckets;
+
+    const int texcoord_count = static_cast<int>(model_data.m_texture_coords.size());
+    const int normal_count   = static_cast<int>(model_data.m_vertex_normals.size());
+    auto      add_vertex     = [&](int vi, int ti, int ni) {
+        // out of range texcoords/normals get the defaults below, they all share one key
+        if (ti < 0 || ti >= texcoord_count)
+            ti = -1;
+        if (ni < 0 || ni >= normal_count)
+            ni = -1;
+        ++corners;
+
+        bool      inserted;
+        uint32_t& index = triplets.insert(vi, ti, ni, (uint32_t)unique_vertices.size(), inserted);
+        if (!inserted)
+            return index;
+
+        Vertex vert;
+        vert.position = glm::vec3(model_data.m_vertices[vi]);
+        vert.texcoord = ti >= 0 ? model_data.m_texture_coords[ti] : glm::vec2{0.0f, 0.0f};
+        vert.normal   = ni >= 0 ? model_data.m_vertex_normals[ni] : glm::vec3{0.0f, 0.0f, 1.0f};
+        vert.tangent  = glm::vec4(0.0f);
+        unique_vertices.push_back(vert);
+        return index;
+    };
+
+    // every face fanned into triangles, one bucket per run of the same material
+    const int vertex_count = static_cast<int>(model_data.m_vertices.size());
+    for (size_t run = 0; run < model_data.m_face_runs.size(); ++run) {
+        auto& bucket = buckets[model_data.m_face_runs[run].material_id];
+        for (size_t face = model_data.m_face_runs[run].first_face; face < model_data.run_end(run);
+             ++face) {
+            faces.for_each_triangle(face, [&](uint32_t c0, uint32_t c1, uint32_t c2) {
+                int v0 = faces.corner_vertices[c0];
+                int v1 = faces.corner_vertices[c1];
+                int v2 = faces.corner_vertices[c2];
+                // a triangle referring to a position that does not exist is dropped
+                if (v0 < 0 || v1 < 0 || v2 < 0 || v0 >= vertex_count || v1 >= vertex_count ||
+                    v2 >= vertex_count)
+                    return;
+                bucket.push_back(add_vertex(v0, faces.texcoord(c0), faces.normal(c0)));
+                bucket.push_back(add_vertex(v1, faces.texcoord(c1), faces.normal(c1)));
+                bucket.push_back(add_vertex(v2, faces.texcoord(c2), faces.normal(c2)));
+            });
+        }
+    }
+
+    // flatten buckets → one big index array, record submeshes
+    auto& all_indices = mesh.indices;
+    all_indices.reserve(std::accumulate(buckets.begin(), buckets.end(), size_t{0},
+                                        [](auto sum, auto& p) { return sum + p.second.size(); }));
+
+    for (auto& [material_id, indexes] : buckets) {
+        if (indexes.empty())
+            continue;
+        SubMesh sm;
+        if (material_id >= 0) {
+            sm.mat = model_data.m_materials[material_id];
+        } else {
+            sm.mat = Material{};
+        }
+        sm.index_offset = (uint32_t)all_indices.size();
+        sm.index_count  = (uint32_t)indexes.size();
+
+        all_indices.insert(all_indices.end(), indexes.begin(), indexes.end());
+        mesh.submeshes.push_back(sm);
+    }
+
+    if (stats) {
+        stats->corners   = corners;
+        stats->triplets  = unique_vertices.size();
+        stats->slots     = triplets.size();
+        stats->probes    = triplets.probes;
+        stats->max_probe = triplets.max_probe;
+    }
+    if (options.near_weld) {
+        size_t welded = weld_near(unique_vertices, all_indices, options.weld_epsilon);
+        if (stats)
+            stats->near_welded = welded;
+    }
+
+    compute_tangents(unique_vertices, all_indices);
+
+    // compute local AABB
+    mesh.aabb_min = glm::vec3(std::numeric_limits<float>::max());
+    mesh.aabb_max = glm::vec3(-std::numeric_limits<float>::max());
+    for (auto const& v : unique_vertices) {
+        mesh.aabb_min = glm::min(mesh.aabb_min, v.position);
+        mesh.aabb_max = glm::max(mesh.aabb_max, v.position);
+    }
+    return mesh;
+}
+
+Models::PackedBounds Models::packed_bounds(const std::vector<Vertex>& vertices) {
+    PackedBounds bounds;
+    if (vertices.empty())
+        return bounds;
+    glm::vec3 position_min = vertices[0].position, position_max = position_min;
+    glm::vec2 texcoord_min = vertices[0].texcoord, texcoord_max = texcoord_min;
+    for (const auto& v : vertices) {
+        position_min = glm::min(position_min, v.position);
+        position_max = glm::max(position_max, v.position);
+        texcoord_min = glm::min(texcoord_min, v.texcoord);
+        texcoord_max = glm::max(texcoord_max, v.texcoord);
+    }
+    bounds.position_offset = position_min;
+    bounds.position_scale  = position_max - position_min;
+    bounds.texcoord_offset = texcoord_min;
+    bounds.texcoord_scale  = texcoord_max - texcoord_min;
+    // a flat mesh still needs a non-zero scale to divide by
+    for (int axis = 0; axis < 3; ++axis) {
+        if (!(bounds.position_scale[axis] > 0.0f))
+            bounds.position_scale[axis] = 1.0f;
+    }
+    for (int axis = 0; axis < 2; ++axis) {
+        if (!(bounds.texcoord_scale[axis] > 0.0f))
+            bounds.texcoord_scale[axis] = 1.0f;
+    }
+    return bounds;
+}
+
+Models::PackedVertex Models::pack_vertex(const Vertex& vertex, const PackedBounds& bounds) {
+    PackedVertex packed;
+    glm::vec3    position = (vertex.position - bounds.position_offset) / bounds.position_scale;
+    uint64_t     position_bits = glm::packUnorm4x16(glm::vec4(position, 0.0f));
+    std::memcpy(packed.position, &position_bits, sizeof(packed.position));
+    glm::vec2 texcoord = (vertex.texcoord - bounds.texcoord_offset) / bounds.texcoord_scale;
+    uint32_t  texcoord_bits = glm::packUnorm2x16(texcoord);
+    std::memcpy(packed.texcoord, &texcoord_bits, sizeof(packed.texcoord));
+    packed.normal  = glm::packSnorm3x10_1x2(glm::vec4(vertex.normal, 0.0f));
+    packed.tangent = glm::packSnorm3x10_1x2(
+        glm::vec4(glm::vec3(vertex.tangent), vertex.tangent.w < 0.0f ? -1.0f : 1.0f));
+    return packed;
+}
+
+Models::Vertex Models::unpack_vertex(const PackedVertex& packed, const PackedBounds& bounds) {
+    uint64_t position_bits;
+    std::memcpy(&position_bits, packed.position, sizeof(position_bits));
+    uint32_t texcoord_bits;
+    std::memcpy(&texcoord_bits, packed.texcoord, sizeof(texcoord_bits));
+    Vertex vertex;
+    vertex.position = bounds.position_offset +
+                      glm::vec3(glm::unpackUnorm4x16(position_bits)) * bounds.position_scale;
+    vertex.texcoord =
+        bounds.texcoord_offset + glm::unpackUnorm2x16(texcoord_bits) * bounds.texcoord_scale;
+    vertex.normal  = glm::vec3(glm::unpackSnorm3x10_1x2(packed.normal));
+    vertex.tangent = glm::unpackSnorm3x10_1x2(packed.tangent);
+    return vertex;
+}
+
+void Models::compute_tangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                              unsigned threads) {
+    const size_t triangles = indices.size() / 3;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t chunks =
+        std::max<size_t>(1, std::min<size_t>(threads, triangles / PARALLEL_TANGENT_MIN_TRIANGLES));
+
+    std::vector<TriangleTangent> per_triangle(triangles);
+    run_chunks(triangles, chunks, [&](size_t begin, size_t end) {
+        triangle_tangents(vertices, indices.data(), begin, end, per_triangle.data());
+    });
+
+    if (chunks == 1) {
+        std::vector<glm::vec3> tan1(vertices.size(), glm::vec3(0.0f));
+        std::vector<glm::vec3> tan2(vertices.size(), glm::vec3(0.0f));
+        for (size_t i = 0; i < triangles * 3; ++i) {
+            tan1[indices[i]] += per_triangle[i / 3].tangent;
+            tan2[indices[i]] += per_triangle[i / 3].bitangent;
+        }
+        for (size_t v = 0; v < vertices.size(); ++v)
+            store_tangent(vertices[v], tan1[v], tan2[v]);
+        return;
+    }
+
+    // the triangles around every vertex in index order, so each thread sums its vertices'
+    // contributions without locks and in the same order as the loop above
+    std::vector<uint32_t> offsets(vertices.size() + 1, 0);
+    for (size_t i = 0; i < triangles * 3; ++i)
+        ++offsets[indices[i] + 1];
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<uint32_t> corner_triangles(triangles * 3);
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangles * 3; ++i)
+            corner_triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    run_chunks(vertices.size(), chunks, [&](size_t begin, size_t end) {
+        for (size_t v = begin; v < end; ++v) {
+            glm::vec3 tangent(0.0f), bitangent(0.0f);
+            for (uint32_t c = offsets[v]; c < offsets[v + 1]; ++c) {
+                tangent += per_triangle[corner_triangles[c]].tangent;
+                bitangent += per_triangle[corner_triangles[c]].bitangent;
+            }
+            store_tangent(vertices[v], tangent, bitangent);
+        }
+    });
+}
+
+void Models::orthogonalize_and_normalize_tb(
+    Models::Vertex& vertex,
+    const std::vector<glm::vec3>& accumulated_tangent,
+    const std::vector<glm::vec3>& accumulated_bitangent,
+    const size_t index
+) {
+    store_tangent(vertex, accumulated_tangent[index], accumulated_bitangent[index]);
+}
+
+std::pair<glm::vec3, glm::vec3> Models::calculate_tangent_bitangent(
+    const Models::Vertex& v0,
+    const Models::Vertex& v1,
+    const Models::Vertex& v2
+){
+
+    glm::vec3 edge1 = v1.position - v0.position;
+    glm::vec3 edge2 = v2.position - v0.position;
+    glm::vec2 uv0   = v0.texcoord;
+    glm::vec2 uv1   = v1.texcoord;
+    glm::vec2 uv2   = v2.texcoord;
+
+    glm::vec2 delta_uv1 = uv1 - uv0;
+    glm::vec2 delta_uv2 = uv2 - uv0;
+    // Compute the inverse of the determinant of the UV matrix (Δ)
+    // This is equivalent to: Δ = 1 / (s1 * t2 - s2 * t1), 0 for degenerate UVs
+    float r = uv_inverse_determinant(delta_uv1.x, delta_uv1.y, delta_uv2.x, delta_uv2.y);
+
+    // Compute the tangent direction vector (T)
+    // This solves: T = (t2 * Q1 - t1 * Q2) / Δ
+    glm::vec3 tangent = {0.0f, 0.0f, 0.0f};
+    // Compute the bitangent direction vector (B)
+    // This solves: B = (-s2 * Q1 + s1 * Q2) / Δ
+    glm::vec3 bitangent = {0.0f, 0.0f, 0.0f};
+
+    tangent.x = r * (delta_uv2.y * edge1.x - delta_uv1.y * edge2.x);
+    tangent.y = r * (delta_uv2.y * edge1.y- delta_uv1.y * edge2.y);
+    tangent.z = r * (delta_uv2.y * edge1.z - delta_uv1.y * edge2.z);
+    bitangent.x = r * (-delta_uv2.x * edge1.x + delta_uv1.x * edge2.x);
+    bitangent.y = r * (-delta_uv2.x * edge1.y + delta_uv1.x * edge2.y);
+    bitangent.z = r * (-delta_uv2.x * edge1.z + delta_uv1.x * edge2.z);
+
+    return {tangent, bitangent};
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "OBJLoader.h"
+#include "SubMesh.h"
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Models {
+
+    struct Vertex {
+        glm::vec3 position;
+        glm::vec2 texcoord;
+        glm::vec3 normal;
+        glm::vec4 tangent;
+
+        bool operator==(Vertex const& o) const {
+            return glm::all(glm::epsilonEqual(position, o.position, glm::epsilon<float>())) &&
+                glm::all(glm::epsilonEqual(texcoord, o.texcoord, glm::epsilon<float>())) &&
+                glm::all(glm::epsilonEqual(normal, o.normal, glm::epsilon<float>()));
+        }
+    };
+
+    // Vertex quantised for the GPU, 20 bytes instead of 48.
+    // position/texcoord: unorm16 inside the PackedBounds of the mesh (position w unused),
+    // normal/tangent: snorm 10:10:10:2, the tangent's handedness in the 2-bit w.
+    struct PackedVertex {
+        uint16_t position[4];
+        uint16_t texcoord[2];
+        uint32_t normal;
+        uint32_t tangent;
+    };
+    static_assert(sizeof(PackedVertex) == 20, "PackedVertex is uploaded as is");
+
+    // The boxes a mesh's positions and texcoords are quantised in, the shader gets them back
+    // as offset + packed * scale. The defaults are the identity, for float vertices.
+    struct PackedBounds {
+        glm::vec3 position_offset{0.0f};
+        glm::vec3 position_scale{1.0f};
+        glm::vec2 texcoord_offset{0.0f};
+        glm::vec2 texcoord_scale{1.0f};
+    };
+
+    PackedBounds packed_bounds(const std::vector<Vertex>& vertices);
+    PackedVertex pack_vertex(const Vertex& vertex, const PackedBounds& bounds);
+    // What the shader reads from a PackedVertex
+    Vertex unpack_vertex(const PackedVertex& packed, const PackedBounds& bounds);
+
+    // How build_mesh() turns OBJ corners into vertices. Corners with the same (v, vt, vn)
+    // index triplet always share a vertex. near_weld also merges vertices of different
+    // triplets whose position, texcoord and normal are all within weld_epsilon, exporters often
+    // write the same attribute values more than once.
+    struct WeldOptions {
+        bool  near_weld    = true;
+        float weld_epsilon = glm::epsilon<float>();
+    };
+
+    // What the vertex dedup did, for obj_bench --weld
+    struct WeldStats {
+        size_t corners     = 0; // triangle corners looked up
+        size_t triplets    = 0; // distinct (v, vt, vn)
+        size_t slots       = 0; // size of the triplet table
+        size_t probes      = 0; // slots visited past the home slot, over every lookup
+        size_t max_probe   = 0;
+        size_t near_welded = 0; // vertices merged into another by the near weld
+    };
+
+    // Everything a Model needs to go to the GPU: deduplicated interleaved vertices,
+    // one index buffer and the per-material ranges into it, followed by the ranges of the
+    // levels of detail if build_lods() ran.
+    // Materials carry their texture paths only, the GL textures are created by whoever uploads.
+    struct MeshData {
+        std::vector<Vertex>   vertices;
+        std::vector<uint32_t> indices;
+        std::vector<SubMesh>  submeshes;
+        // error of every SubMesh::lods level, relative to the AABB diagonal
+        std::vector<float>    lod_errors;
+        glm::vec3             aabb_min{0.0f};
+        glm::vec3             aabb_max{0.0f};
+
+        // Set by a warm MeshCache load instead of vertices/indices: views into the mapped .mesh
+        // file, which also stores the vertices packed and the indices at their upload width so
+        // Model uploads straight from the mapping. The file stays mapped with the MeshData.
+        struct BakedStreams {
+            std::shared_ptr<const ObjectLoader::MappedFile> file;
+            const Vertex*                                   vertices     = nullptr;
+            size_t                                          vertex_count = 0;
+            const uint32_t*                                 indices      = nullptr;
+            size_t                                          index_count  = 0;
+            const PackedVertex*                             packed       = nullptr;
+            PackedBounds                                    packed_bounds;
+            const void*                                     upload_indices = nullptr;
+            uint32_t                                        index_size     = 0; // 2 or 4
+        };
+        BakedStreams baked;
+
+        inline const Vertex* vertex_data() const {
+            return baked.file ? baked.vertices : vertices.data();
+        }
+
+        inline size_t vertex_count() const {
+            return baked.file ? baked.vertex_count : vertices.size();
+        }
+
+        inline const uint32_t* index_data() const {
+            return baked.file ? baked.indices : indices.data();
+        }
+
+        inline size_t index_count() const {
+            return baked.file ? baked.index_count : indices.size();
+        }
+
+        // approximate heap footprint, what the asset cache budgets against (a baked mapping is
+        // page cache, not heap)
+        inline size_t bytes() const {
+            return sizeof(MeshData) + vertices.capacity() * sizeof(Vertex) +
+                   indices.capacity() * sizeof(uint32_t) + submeshes.capacity() * sizeof(SubMesh);
+        }
+    };
+
+    // Dedups the OBJ corners into unique vertices, buckets the triangles by material and
+    // generates tangents.
+    MeshData build_mesh(const ObjectLoader::ModelData& model_data,
+                        const WeldOptions& options = {}, WeldStats* stats = nullptr);
+
+    std::pair<glm::vec3, glm::vec3> calculate_tangent_bitangent(const Vertex& v0, const Vertex& v1,
+                                                                const Vertex& v2);
+    void orthogonalize_and_normalize_tb(Vertex& vertex,
+                                        const std::vector<glm::vec3>& accumulated_tangent,
+                                        const std::vector<glm::vec3>& accumulated_bitangent,
+                                        const size_t index);
+    // Accumulates per-triangle tangents on the shared vertices and stores them in
+    // vertex.tangent. Triangles whose UVs have no area add nothing, a vertex left without any
+    // tangent gets one perpendicular to its normal. Big meshes are split over threads (0: one
+    // per hardware thread), the result is the same for any count.
+    void compute_tangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+                          unsigned threads = 0);
+
+} // namespace Models
@@ -0,0 +1,173 @@
+#include "MeshArena.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <utility>
+
+using namespace GlHelpers;
+
+size_t Models::vertex_stride(VertexFormat format) {
+    return format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+void Models::set_vertex_attributes(VertexFormat format) {
+    GLCall(glEnableVertexAttribArray(0));
+    GLCall(glEnableVertexAttribArray(1));
+    GLCall(glEnableVertexAttribArray(2));
+    GLCall(glEnableVertexAttribArray(3));
+    if (format == VertexFormat::Packed) {
+        // the 2_10_10_10 formats always have 4 components, the shader ignores the normal's w
+        GLCall(glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex),
+                                     (void*)offsetof(PackedVertex, position)));
+        GLCall(glVertexAttribPointer(1, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex),
+                                     (void*)offsetof(PackedVertex, texcoord)));
+        GLCall(glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex),
+                                     (void*)offsetof(PackedVertex, normal)));
+        GLCall(glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex),
+                                     (void*)offsetof(PackedVertex, tangent)));
+    } else {
+        // attributes (pos, tex, norm) …
+        GLCall(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                                     (void*)offsetof(Vertex, position)));
+        GLCall(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                                     (void*)offsetof(Vertex, texcoord)));
+        GLCall(glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                                     (void*)offsetof(Vertex, normal)));
+        GLCall(glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                                     (void*)offsetof(Vertex, tangent)));
+    }
+}
+
+Models::MeshAllocation::~MeshAllocation() {
+    release();
+}
+
+Models::MeshAllocation::MeshAllocation(MeshAllocation&& other) noexcept
+    : arena(std::exchange(other.arena, nullptr)), block(other.block), vertices(other.vertices),
+      indices(other.indices) {}
+
+Models::MeshAllocation& Models::MeshAllocation::operator=(MeshAllocation&& other) noexcept {
+    if (this != &other) {
+        release();
+        arena    = std::exchange(other.arena, nullptr);
+        block    = other.block;
+        vertices = other.vertices;
+        indices  = other.indices;
+    }
+    return *this;
+}
+
+void Models::MeshAllocation::release() {
+    if (arena) {
+        arena->release(block, vertices, indices);
+        arena = nullptr;
+    }
+}
+
+GLuint Models::MeshAllocation::vao() const {
+    return arena ? arena->blocks[block].vao : 0;
+}
+
+GLuint Models::MeshAllocation::vbo() const {
+    return arena ? arena->blocks[block].vbo : 0;
+}
+
+GLuint Models::MeshAllocation::ebo() const {
+    return arena ? arena->blocks[block].ebo : 0;
+}
+
+Models::MeshArena::MeshArena(uint32_t block_vertices, uint32_t block_index_bytes)
+    : block_vertices(block_vertices), block_index_bytes(block_index_bytes) {}
+
+Models::MeshArena& Models::MeshArena::shared() {
+    static MeshArena arena;
+    return arena;
+}
+
+uint32_t Models::MeshArena::add_block(VertexFormat format, uint32_t vertex_count,
+                                      uint32_t index_bytes) {
+    Block block;
+    block.format   = format;
+    block.vertices = RangeAllocator(std::max(vertex_count, block_vertices));
+    block.indices  = RangeAllocator(std::max(index_bytes, block_index_bytes));
+
+    GLCall(glGenVertexArrays(1, &block.vao));
+    GLCall(glGenBuffers(1, &block.vbo));
+    GLCall(glGenBuffers(1, &block.ebo));
+    bind_vertex_array(block.vao);
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, block.vbo));
+    GLCall(glBufferData(GL_ARRAY_BUFFER, size_t(block.vertices.capacity()) * vertex_stride(format),
+                        nullptr, GL_STATIC_DRAW));
+    set_vertex_attributes(format);
+    // the element buffer binding belongs to the VAO
+    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block.ebo));
+    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, block.indices.capacity(), nullptr,
+                        GL_STATIC_DRAW));
+
+    blocks.push_back(std::move(block));
+    return static_cast<uint32_t>(blocks.size() - 1);
+}
+
+Models::MeshAllocation Models::MeshArena::allocate(VertexFormat format, const void* vertices,
+                                                   uint32_t vertex_count, const void* indices,
+                                                   uint32_t index_bytes) {
+    // keeps every index range starting on a 4 byte boundary
+    const uint32_t index_size = (index_bytes + 3u) & ~3u;
+
+    MeshAllocation allocation;
+    auto           fits = [&](uint32_t b) {
+        Block& block = blocks[b];
+        if (block.format != format || block.vertices.largest_free() < vertex_count ||
+            block.indices.largest_free() < index_size)
+            return false;
+        block.vertices.allocate(vertex_count, allocation.vertices);
+        block.indices.allocate(index_size, allocation.indices);
+        allocation.block = b;
+        return true;
+    };
+
+    bool placed = false;
+    for (uint32_t b = 0; b < blocks.size() && !placed; ++b)
+        placed = fits(b);
+    if (!placed)
+        fits(add_block(format, vertex_count, index_size));
+    allocation.arena = this;
+
+    const Block& block = blocks[allocation.block];
+    const size_t stride = vertex_stride(format);
+    bind_vertex_array(block.vao);
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, block.vbo));
+    GLCall(glBufferSubData(GL_ARRAY_BUFFER, size_t(allocation.vertices.offset) * stride,
+                           size_t(vertex_count) * stride, vertices));
+    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, block.ebo));
+    GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, allocation.indices.offset, index_bytes,
+                           indices));
+    return allocation;
+}
+
+void Models::MeshArena::release(uint32_t block, const Range& vertices, const Range& indices) {
+    // the contents stay in the buffers until the ranges are handed out again
+    blocks[block].vertices.free(vertices);
+    blocks[block].indices.free(indices);
+}
+
+Models::MeshArenaStats Models::MeshArena::stats() const {
+    MeshArenaStats stats;
+    size_t         free_total = 0;
+    size_t         scattered  = 0;
+    for (const auto& block : blocks) {
+        const size_t stride = vertex_stride(block.format);
+        stats.blocks += 1;
+        stats.vertex_bytes += size_t(block.vertices.capacity()) * stride;
+        stats.index_bytes += block.indices.capacity();
+        stats.used_vertex_bytes +=
+            size_t(block.vertices.capacity() - block.vertices.free_units()) * stride;
+        stats.used_index_bytes += block.indices.capacity() - block.indices.free_units();
+        stats.free_ranges += block.vertices.free_ranges() + block.indices.free_ranges();
+
+        free_total += size_t(block.vertices.free_units()) * stride + block.indices.free_units();
+        scattered += size_t(block.vertices.free_units() - block.vertices.largest_free()) * stride +
+                     block.indices.free_units() - block.indices.largest_free();
+    }
+    stats.fragmentation = free_total ? double(scattered) / double(free_total) : 0.0;
+    return stats;
+}
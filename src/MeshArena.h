@@ -0,0 +1,120 @@
+#pragma once
+
+#include "GlMacros.h"
+#include "RangeAllocator.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Models {
+
+    // Vertex layouts in the arena. Base vertices count in vertices of one stride, so each
+    // layout gets blocks of its own.
+    enum class VertexFormat {
+        Packed, // PackedVertex
+        Float,  // Vertex
+    };
+
+    size_t vertex_stride(VertexFormat format);
+    // attributes 0-3 of the bound VAO, read from the VBO bound to GL_ARRAY_BUFFER
+    void set_vertex_attributes(VertexFormat format);
+
+    struct MeshArenaStats {
+        size_t blocks            = 0;
+        size_t vertex_bytes      = 0; // capacity of the VBOs
+        size_t index_bytes       = 0; // capacity of the EBOs
+        size_t used_vertex_bytes = 0;
+        size_t used_index_bytes  = 0;
+        size_t free_ranges       = 0;
+        // free space that is not part of the largest free range of its buffer, 0 when every
+        // buffer has its free space in one piece
+        double fragmentation = 0.0;
+    };
+
+    class MeshArena;
+
+    // The vertex and index ranges of one mesh, given back to the arena when destroyed
+    class MeshAllocation {
+    public:
+        MeshAllocation() = default;
+        ~MeshAllocation();
+
+        MeshAllocation(const MeshAllocation&)            = delete;
+        MeshAllocation& operator=(const MeshAllocation&) = delete;
+        MeshAllocation(MeshAllocation&& other) noexcept;
+        MeshAllocation& operator=(MeshAllocation&& other) noexcept;
+
+        inline explicit operator bool() const {
+            return arena != nullptr;
+        }
+
+        GLuint vao() const;
+        GLuint vbo() const;
+        GLuint ebo() const;
+
+        // what glDraw*BaseVertex adds to every index
+        inline GLint base_vertex() const {
+            return static_cast<GLint>(vertices.offset);
+        }
+
+        // where the indices start in the EBO
+        inline size_t index_byte_offset() const {
+            return indices.offset;
+        }
+
+    private:
+        friend class MeshArena;
+        void release();
+
+        MeshArena* arena = nullptr;
+        uint32_t   block = 0;
+        Range      vertices; // in vertices
+        Range      indices;  // in bytes
+    };
+
+    // Large VBO/EBO pairs shared by every Model, each with one VAO. Meshes get a range of
+    // vertices and one of indices in the same block and draw with glDraw*BaseVertex, so
+    // models in one block draw without binding another VAO. Ranges of removed models go back
+    // to the block's free lists and are reused by the next mesh that fits; a mesh that fits
+    // in no block opens a new one, as large as the mesh if it needs more than the default.
+    // GL thread only.
+    class MeshArena {
+    public:
+        explicit MeshArena(uint32_t block_vertices    = 1u << 18,
+                           uint32_t block_index_bytes = 4u << 20);
+
+        MeshArena(const MeshArena&)            = delete;
+        MeshArena& operator=(const MeshArena&) = delete;
+
+        // Copies vertex_count vertices of format and index_bytes of indices into a block.
+        // Index offsets stay 4 byte aligned, so 16 and 32-bit indices share the EBOs.
+        MeshAllocation allocate(VertexFormat format, const void* vertices, uint32_t vertex_count,
+                                const void* indices, uint32_t index_bytes);
+
+        MeshArenaStats stats() const;
+
+        // the arena every Model allocates from
+        static MeshArena& shared();
+
+    private:
+        friend class MeshAllocation;
+
+        struct Block {
+            VertexFormat   format;
+            GLuint         vao = 0;
+            GLuint         vbo = 0;
+            GLuint         ebo = 0;
+            RangeAllocator vertices;
+            RangeAllocator indices;
+        };
+
+        uint32_t add_block(VertexFormat format, uint32_t vertex_count, uint32_t index_bytes);
+        void     release(uint32_t block, const Range& vertices, const Range& indices);
+
+        uint32_t block_vertices;
+        uint32_t block_index_bytes;
+        // never shrinks, MeshAllocation::block indexes it
+        std::vector<Block> blocks;
+    };
+
+} // namespace Models
@@ -0,0 +1,441 @@
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <type_traits>
+
+namespace {
+
+    constexpr char MAGIC[8] = {'H', 'G', 'M', 'E', 'S', 'H', '\0', '\0'};
+
+    // Fixed part at the start of every .mesh file. The variable sized records (source path,
+    // dependencies, LOD errors, submeshes) follow it, then the vertex and index arrays at the given
+    // 16 byte aligned offsets: as built, and as Model uploads them (PackedVertex inside the packed
+    // bounds, indices index_size bytes wide, the same array as the built one when that is 4).
+    struct BakedHeader {
+        char     magic[8];
+        uint32_t format_version;
+        uint32_t loader_version;
+        uint32_t vertex_size;
+        uint32_t vertex_count;
+        uint32_t index_count;
+        uint32_t submesh_count;
+        uint32_t dependency_count;
+        uint32_t lod_count;
+        uint64_t source_size;
+        uint64_t source_hash;
+        float    aabb_min[3];
+        float    aabb_max[3];
+        uint64_t vertices_offset;
+        uint64_t indices_offset;
+        float    packed_position_offset[3];
+        float    packed_position_scale[3];
+        float    packed_texcoord_offset[2];
+        float    packed_texcoord_scale[2];
+        uint32_t index_size;
+        uint64_t packed_offset;
+        uint64_t upload_indices_offset;
+    };
+
+    // smallest a submesh record can be: fixed fields and empty strings, before its LOD ranges and
+    // clusters
+    constexpr size_t MIN_SUBMESH_BYTES = 2 * sizeof(uint32_t) + 5 * sizeof(uint32_t) +
+                                         4 * 3 * sizeof(float) + 3 * sizeof(float) +
+                                         sizeof(int32_t) + sizeof(uint32_t);
+
+    static_assert(std::is_trivially_copyable<Models::Vertex>::value,
+                  "Vertex is written to disk as raw bytes");
+    static_assert(std::is_trivially_copyable<Cluster>::value,
+                  "Cluster is written to disk as raw bytes");
+    static_assert(std::is_trivially_copyable<Models::PackedVertex>::value,
+                  "PackedVertex is written to disk as raw bytes");
+
+    // 0 for files that do not exist, so a missing .mtl showing up later invalidates the bake
+    uint64_t hash_file(const std::string& path) {
+        try {
+            ObjectLoader::MappedFile file{path};
+            return ObjectLoader::hash_bytes(file.view()) | 1;
+        } catch (const std::runtime_error&) {
+            return 0;
+        }
+    }
+
+    struct ByteWriter {
+        std::string bytes;
+
+        template <typename T> void put(const T& value) {
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void put_string(const std::string& s) {
+            put(static_cast<uint32_t>(s.size()));
+            bytes.append(s);
+        }
+
+        void put_vec3(const glm::vec3& v) {
+            put(v.x);
+            put(v.y);
+            put(v.z);
+        }
+
+        void align(size_t alignment) {
+            bytes.resize((bytes.size() + alignment - 1) / alignment * alignment, '\0');
+        }
+    };
+
+    // Bounds checked reader over the mapped file, any overrun flips ok to false.
+    struct ByteReader {
+        std::string_view bytes;
+        size_t           pos = 0;
+        bool             ok  = true;
+
+        size_t remaining() const {
+            return ok ? bytes.size() - pos : 0;
+        }
+
+        template <typename T> T get() {
+            T value{};
+            if (!ok || bytes.size() - pos < sizeof(T)) {
+                ok = false;
+                return value;
+            }
+            std::memcpy(&value, bytes.data() + pos, sizeof(T));
+            pos += sizeof(T);
+            return value;
+        }
+
+        std::string get_string() {
+            uint32_t size = get<uint32_t>();
+            if (!ok || bytes.size() - pos < size) {
+                ok = false;
+                return {};
+            }
+            std::string s{bytes.substr(pos, size)};
+            pos += size;
+            return s;
+        }
+
+        glm::vec3 get_vec3() {
+            float x = get<float>();
+            float y = get<float>();
+            float z = get<float>();
+            return {x, y, z};
+        }
+    };
+
+} // namespace
+
+std::string Models::MeshCache::baked_path(const std::string& obj_path) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.mesh",
+                  static_cast<unsigned long long>(ObjectLoader::hash_bytes(obj_path)));
+    return directory + "/" + name;
+}
+
+void Models::MeshCache::clear() {
+    loaded.clear();
+}
+
+std::shared_ptr<const Models::MeshData> Models::MeshCache::load(const std::string& obj_path) {
+    return loaded.get_or_load(obj_path, [&] { return read_or_build(obj_path); });
+}
+
+Models::MeshData Models::MeshCache::read_or_build(const std::string& obj_path, bool* was_baked) {
+    if (was_baked)
+        *was_baked = false;
+
+    uint64_t source_hash = 0;
+    uint64_t source_size = 0;
+    {
+        // throws if the .obj does not exist, same as the parser would
+        ObjectLoader::MappedFile source{obj_path};
+        source_hash = ObjectLoader::hash_bytes(source.view());
+        source_size = source.bytes();
+    }
+
+    MeshData mesh;
+    if (!directory.empty()) {
+        std::string path = baked_path(obj_path);
+        if (read_baked(path, obj_path, source_hash, source_size, mesh)) {
+            if (was_baked)
+                *was_baked = true;
+            return mesh;
+        }
+    }
+
+    ObjectLoader::OBJLoader loader;
+    loader.parse(obj_path);
+    mesh = build_mesh(loader.model_data);
+    optimize_mesh(mesh);
+    build_clusters(mesh);
+    build_lods(mesh);
+
+    if (!directory.empty()) {
+        write_baked(baked_path(obj_path), obj_path, source_hash, source_size,
+                    loader.model_data.m_mtllibs, mesh);
+    }
+    return mesh;
+}
+
+bool Models::MeshCache::read_baked(const std::string& path, const std::string& obj_path,
+                                   uint64_t source_hash, uint64_t source_size, MeshData& out) {
+    std::shared_ptr<const ObjectLoader::MappedFile> file;
+    try {
+        file = std::make_shared<const ObjectLoader::MappedFile>(path);
+    } catch (const std::runtime_error&) {
+        // not baked yet
+        return false;
+    }
+
+    ByteReader  in{file->view()};
+    BakedHeader header = in.get<BakedHeader>();
+    if (!in.ok || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header.format_version != FORMAT_VERSION ||
+        header.loader_version != ObjectLoader::LOADER_VERSION ||
+        header.vertex_size != sizeof(Vertex) || header.source_size != source_size ||
+        header.source_hash != source_hash) {
+        return false;
+    }
+
+    // two paths can hash to the same file name
+    if (in.get_string() != obj_path || !in.ok)
+        return false;
+
+    for (uint32_t i = 0; i < header.dependency_count; ++i) {
+        std::string dependency = in.get_string();
+        uint64_t    hash       = in.get<uint64_t>();
+        if (!in.ok || hash_file(dependency) != hash)
+            return false;
+    }
+
+    // the counts come from the file, bound them by what is left of it before allocating
+    const uint64_t submesh_bytes =
+        MIN_SUBMESH_BYTES + uint64_t{header.lod_count} * sizeof(LodRange);
+    if (header.lod_count > in.remaining() / sizeof(float) ||
+        header.submesh_count >
+            (in.remaining() - header.lod_count * sizeof(float)) / submesh_bytes) {
+        std::cerr << "Corrupt baked mesh, rebuilding: " << path << "\n";
+        return false;
+    }
+    std::vector<float> lod_errors(header.lod_count);
+    for (auto& error : lod_errors)
+        error = in.get<float>();
+
+    std::vector<SubMesh> submeshes(header.submesh_count);
+    for (auto& sm : submeshes) {
+        sm.index_offset  = in.get<uint32_t>();
+        sm.index_count   = in.get<uint32_t>();
+        sm.mat.name      = in.get_string();
+        sm.mat.Ka        = in.get_vec3();
+        sm.mat.Kd        = in.get_vec3();
+        sm.mat.Ks        = in.get_vec3();
+        sm.mat.Ke        = in.get_vec3();
+        sm.mat.Ns        = in.get<float>();
+        sm.mat.Ni        = in.get<float>();
+        sm.mat.d         = in.get<float>();
+        sm.mat.illum     = in.get<int32_t>();
+        sm.mat.map_Ka    = in.get_string();
+        sm.mat.map_Kd    = in.get_string();
+        sm.mat.map_Ks    = in.get_string();
+        sm.mat.map_Bump  = in.get_string();
+        if (!in.ok || uint64_t{sm.index_offset} + sm.index_count > header.index_count)
+            return false;
+        sm.lods.resize(header.lod_count);
+        for (auto& lod : sm.lods) {
+            lod.index_offset = in.get<uint32_t>();
+            lod.index_count  = in.get<uint32_t>();
+            if (!in.ok || uint64_t{lod.index_offset} + lod.index_count > header.index_count)
+                return false;
+        }
+        const uint32_t cluster_count = in.get<uint32_t>();
+        if (!in.ok || cluster_count > sm.index_count / 3 ||
+            cluster_count > in.remaining() / sizeof(Cluster))
+            return false;
+        sm.clusters.resize(cluster_count);
+        for (auto& cluster : sm.clusters) {
+            cluster = in.get<Cluster>();
+            if (!in.ok ||
+                uint64_t{cluster.index_offset} + cluster.index_count > header.index_count)
+                return false;
+        }
+    }
+
+    const std::string_view bytes = file->view();
+    const auto in_file = [&](uint64_t offset, uint64_t size) {
+        return offset <= bytes.size() && bytes.size() - offset >= size;
+    };
+    // Model narrows the indices to 16-bit exactly when every vertex fits
+    const uint32_t index_size = header.vertex_count <= 65536 ? 2 : 4;
+    if (header.index_size != index_size) {
+        std::cerr << "Corrupt baked mesh, rebuilding: " << path << "\n";
+        return false;
+    }
+    if (!in_file(header.vertices_offset, uint64_t{header.vertex_count} * sizeof(Vertex)) ||
+        !in_file(header.indices_offset, uint64_t{header.index_count} * sizeof(uint32_t)) ||
+        !in_file(header.packed_offset, uint64_t{header.vertex_count} * sizeof(PackedVertex)) ||
+        !in_file(header.upload_indices_offset, uint64_t{header.index_count} * index_size)) {
+        std::cerr << "Truncated baked mesh, rebuilding: " << path << "\n";
+        return false;
+    }
+
+    // Not copied: the arrays are used in place and the MeshData keeps the file mapped. The offsets
+    // are 16 byte aligned from the start of the page aligned mapping.
+    MeshData::BakedStreams& baked = out.baked;
+    baked.vertices     = reinterpret_cast<const Vertex*>(bytes.data() + header.vertices_offset);
+    baked.vertex_count = header.vertex_count;
+    baked.indices      = reinterpret_cast<const uint32_t*>(bytes.data() + header.indices_offset);
+    baked.index_count  = header.index_count;
+    baked.packed = reinterpret_cast<const PackedVertex*>(bytes.data() + header.packed_offset);
+    baked.packed_bounds.position_offset = {header.packed_position_offset[0],
+                                           header.packed_position_offset[1],
+                                           header.packed_position_offset[2]};
+    baked.packed_bounds.position_scale  = {header.packed_position_scale[0],
+                                           header.packed_position_scale[1],
+                                           header.packed_position_scale[2]};
+    baked.packed_bounds.texcoord_offset = {header.packed_texcoord_offset[0],
+                                           header.packed_texcoord_offset[1]};
+    baked.packed_bounds.texcoord_scale  = {header.packed_texcoord_scale[0],
+                                           header.packed_texcoord_scale[1]};
+    baked.upload_indices = bytes.data() + header.upload_indices_offset;
+    baked.index_size     = index_size;
+
+    // both index arrays reach the GPU or the CPU copy of the vertices, check them the same way
+    bool in_range = true;
+    for (size_t i = 0; i < baked.index_count; ++i) {
+        in_range &= baked.indices[i] < header.vertex_count;
+    }
+    if (index_size == 2) {
+        const auto* narrow = static_cast<const uint16_t*>(baked.upload_indices);
+        for (size_t i = 0; i < baked.index_count; ++i) {
+            in_range &= narrow[i] < header.vertex_count;
+        }
+    }
+    if (!in_range) {
+        std::cerr << "Corrupt baked mesh, rebuilding: " << path << "\n";
+        out.baked = {};
+        return false;
+    }
+    baked.file = std::move(file);
+    out.submeshes  = std::move(submeshes);
+    out.lod_errors = std::move(lod_errors);
+    out.aabb_min   = {header.aabb_min[0], header.aabb_min[1], header.aabb_min[2]};
+    out.aabb_max   = {header.aabb_max[0], header.aabb_max[1], header.aabb_max[2]};
+    return true;
+}
+
+void Models::MeshCache::write_baked(const std::string& path, const std::string& obj_path,
+                                    uint64_t source_hash, uint64_t source_size,
+                                    const std::vector<std::string>& dependencies,
+                                    const MeshData& mesh) {
+    BakedHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.format_version   = FORMAT_VERSION;
+    header.loader_version   = ObjectLoader::LOADER_VERSION;
+    header.vertex_size      = sizeof(Vertex);
+    header.vertex_count     = static_cast<uint32_t>(mesh.vertices.size());
+    header.index_count      = static_cast<uint32_t>(mesh.indices.size());
+    header.submesh_count    = static_cast<uint32_t>(mesh.submeshes.size());
+    header.dependency_count = static_cast<uint32_t>(dependencies.size());
+    header.lod_count        = static_cast<uint32_t>(mesh.lod_errors.size());
+    header.source_size      = source_size;
+    header.source_hash      = source_hash;
+    for (int i = 0; i < 3; ++i) {
+        header.aabb_min[i] = mesh.aabb_min[i];
+        header.aabb_max[i] = mesh.aabb_max[i];
+    }
+
+    ByteWriter out;
+    out.put(header);
+    out.put_string(obj_path);
+    for (const auto& dependency : dependencies) {
+        out.put_string(dependency);
+        out.put(hash_file(dependency));
+    }
+    for (float error : mesh.lod_errors) {
+        out.put(error);
+    }
+    for (const auto& sm : mesh.submeshes) {
+        out.put(static_cast<uint32_t>(sm.index_offset));
+        out.put(static_cast<uint32_t>(sm.index_count));
+        out.put_string(sm.mat.name);
+        out.put_vec3(sm.mat.Ka);
+        out.put_vec3(sm.mat.Kd);
+        out.put_vec3(sm.mat.Ks);
+        out.put_vec3(sm.mat.Ke);
+        out.put(sm.mat.Ns);
+        out.put(sm.mat.Ni);
+        out.put(sm.mat.d);
+        out.put(static_cast<int32_t>(sm.mat.illum));
+        out.put_string(sm.mat.map_Ka);
+        out.put_string(sm.mat.map_Kd);
+        out.put_string(sm.mat.map_Ks);
+        out.put_string(sm.mat.map_Bump);
+        // build_lods() gives every submesh the same number of levels
+        for (const auto& lod : sm.lods) {
+            out.put(lod.index_offset);
+            out.put(lod.index_count);
+        }
+        out.put(static_cast<uint32_t>(sm.clusters.size()));
+        for (const auto& cluster : sm.clusters) {
+            out.put(cluster);
+        }
+    }
+
+    out.align(16);
+    header.vertices_offset = out.bytes.size();
+    out.bytes.append(reinterpret_cast<const char*>(mesh.vertices.data()),
+                     mesh.vertices.size() * sizeof(Vertex));
+    out.align(16);
+    header.indices_offset = out.bytes.size();
+    out.bytes.append(reinterpret_cast<const char*>(mesh.indices.data()),
+                     mesh.indices.size() * sizeof(uint32_t));
+
+    // the same streams as Model::upload_buffers() makes them
+    const PackedBounds bounds = packed_bounds(mesh.vertices);
+    for (int i = 0; i < 3; ++i) {
+        header.packed_position_offset[i] = bounds.position_offset[i];
+        header.packed_position_scale[i]  = bounds.position_scale[i];
+    }
+    for (int i = 0; i < 2; ++i) {
+        header.packed_texcoord_offset[i] = bounds.texcoord_offset[i];
+        header.packed_texcoord_scale[i]  = bounds.texcoord_scale[i];
+    }
+    out.align(16);
+    header.packed_offset = out.bytes.size();
+    for (const auto& vertex : mesh.vertices) {
+        out.put(pack_vertex(vertex, bounds));
+    }
+    header.index_size            = mesh.vertices.size() <= 65536 ? 2 : 4;
+    header.upload_indices_offset = header.indices_offset;
+    if (header.index_size == 2) {
+        out.align(16);
+        header.upload_indices_offset = out.bytes.size();
+        for (uint32_t index : mesh.indices) {
+            out.put(static_cast<uint16_t>(index));
+        }
+    }
+    // patch the offsets in now that they are known
+    std::memcpy(out.bytes.data(), &header, sizeof(header));
+
+    // write next to the target and rename so a crash never leaves a half written bake
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream file{tmp_path, std::ios::binary | std::ios::trunc};
+        if (!file || !file.write(out.bytes.data(), out.bytes.size())) {
+            std::cerr << "Failed to write baked mesh: " << tmp_path << "\n";
+            return;
+        }
+    }
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::cerr << "Failed to write baked mesh: " << path << " (" << ec.message() << ")\n";
+        std::filesystem::remove(tmp_path, ec);
+    }
+}
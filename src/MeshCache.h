@@ -0,0 +1,67 @@
+#pragma once
+
+#include "AssetRegistry.h"
+#include "Mesh.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Models {
+
+    // Binary cache of build_mesh() + optimize_mesh() + build_clusters() + build_lods() output
+    // so warm starts skip OBJ parsing, vertex dedup, tangent generation, the index reordering,
+    // clustering and simplification.
+    // One .mesh file per source .obj, named after a hash of its path. It is only used when the
+    // stored path, the .obj/.mtl content hashes, FORMAT_VERSION and ObjectLoader::LOADER_VERSION
+    // all match, otherwise the mesh is rebuilt and the file rewritten.
+    // The file is native-endian and meant to live next to the build, not to be shipped.
+    class MeshCache {
+    public:
+        // Bump whenever build_mesh(), optimize_mesh(), build_clusters(), build_lods(), Vertex,
+        // PackedVertex or the file layout changes.
+        static constexpr uint32_t FORMAT_VERSION = 8;
+
+        // Mesh for obj_path, shared by every Model of that file while it stays in memory(),
+        // later calls get the same object back. Its materials only carry texture paths, so a
+        // cached mesh does not keep textures in VRAM.
+        static std::shared_ptr<const MeshData> load(const std::string& obj_path);
+
+        // CPU only: maps the baked file if it is still valid (the MeshData then reads its
+        // MeshData::baked streams from the mapping), otherwise parses the .obj and bakes it.
+        // was_baked (optional) reports which of the two happened.
+        static MeshData read_or_build(const std::string& obj_path, bool* was_baked = nullptr);
+
+        // Where the .mesh files go, an empty string disables the on-disk cache.
+        inline static void set_directory(const std::string& dir) {
+            directory = dir;
+        }
+
+        inline static const std::string& get_directory() {
+            return directory;
+        }
+
+        // The meshes load() shares, bounded by MEMORY_BUDGET by default. Meshes evicted from
+        // it stay shared while a Model still uses them.
+        inline static ObjectLoader::AssetRegistry<MeshData>& memory() {
+            return loaded;
+        }
+
+        static void clear();
+
+    private:
+        static std::string baked_path(const std::string& obj_path);
+        static bool read_baked(const std::string& path, const std::string& obj_path,
+                               uint64_t source_hash, uint64_t source_size, MeshData& out);
+        static void write_baked(const std::string& path, const std::string& obj_path,
+                                uint64_t source_hash, uint64_t source_size,
+                                const std::vector<std::string>& dependencies,
+                                const MeshData& mesh);
+
+        inline static std::string directory = "mesh_cache";
+        static constexpr size_t MEMORY_BUDGET = 256 * 1024 * 1024;
+
+        inline static ObjectLoader::AssetRegistry<MeshData> loaded{MEMORY_BUDGET};
+    };
+
+} // namespace Models
@@ -0,0 +1,563 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+    constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    // Tipsify over the triangle_count triangles of indices. Appends the new triangle order to
+    // order and the first triangle of every cluster (a run between two dead ends, where the
+    // fan could not continue from the cache) to clusters.
+    void tipsify(const uint32_t* indices, size_t triangle_count, size_t vertex_count,
+                 uint32_t cache_size, std::vector<uint32_t>& order,
+                 std::vector<uint32_t>& clusters) {
+        // triangles around every vertex, as offsets into one flat array
+        std::vector<uint32_t> live(vertex_count, 0);
+        for (size_t i = 0; i < triangle_count * 3; ++i)
+            ++live[indices[i]];
+        std::vector<uint32_t> offsets(vertex_count + 1, 0);
+        for (size_t v = 0; v < vertex_count; ++v)
+            offsets[v + 1] = offsets[v] + live[v];
+        std::vector<uint32_t> adjacency(offsets.back());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangle_count * 3; ++i)
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+        std::vector<bool>     emitted(triangle_count, false);
+        std::vector<uint32_t> cache_time(vertex_count, 0);
+        std::vector<uint32_t> dead_ends;
+        std::vector<uint32_t> candidates;
+        uint32_t              time   = cache_size + 1;
+        size_t                cursor = 0; // next index to look at once the dead ends run out
+
+        auto skip_dead_end = [&]() -> uint32_t {
+            while (!dead_ends.empty()) {
+                uint32_t v = dead_ends.back();
+                dead_ends.pop_back();
+                if (live[v] > 0)
+                    return v;
+            }
+            for (; cursor < triangle_count * 3; ++cursor) {
+                if (live[indices[cursor]] > 0)
+                    return indices[cursor];
+            }
+            return NONE;
+        };
+
+        uint32_t fan = triangle_count ? indices[0] : NONE;
+        if (fan != NONE)
+            clusters.push_back(static_cast<uint32_t>(order.size()));
+        while (fan != NONE) {
+            // emit every triangle still pending around the fanning vertex
+            candidates.clear();
+            for (uint32_t a = offsets[fan]; a < offsets[fan + 1]; ++a) {
+                const uint32_t triangle = adjacency[a];
+                if (emitted[triangle])
+                    continue;
+                emitted[triangle] = true;
+                order.push_back(triangle);
+                for (int k = 0; k < 3; ++k) {
+                    const uint32_t v = indices[triangle * 3 + k];
+                    dead_ends.push_back(v);
+                    candidates.push_back(v);
+                    --live[v];
+                    if (time - cache_time[v] > cache_size)
+                        cache_time[v] = time++;
+                }
+            }
+
+            // continue from the oldest candidate that is still cached after its own fan
+            uint32_t next          = NONE;
+            int64_t  best_priority = -1;
+            for (uint32_t v : candidates) {
+                if (live[v] == 0)
+                    continue;
+                int64_t priority = 0;
+                if (time - cache_time[v] + 2 * live[v] <= cache_size)
+                    priority = time - cache_time[v];
+                if (priority > best_priority) {
+                    best_priority = priority;
+                    next          = v;
+                }
+            }
+            if (next == NONE) {
+                next = skip_dead_end();
+                if (next != NONE)
+                    clusters.push_back(static_cast<uint32_t>(order.size()));
+            }
+            fan = next;
+        }
+    }
+
+    // Sorts the clusters of order (triangle ids into indices) by how far they face away from
+    // the centroid of all of them, outermost first: those are the ones most likely to hide
+    // the others from any direction. clusters (the first position of each in order) is
+    // updated to the new order.
+    void sort_clusters_for_overdraw(const uint32_t*                     indices,
+                                    const std::vector<Models::Vertex>& vertices,
+                                    std::vector<uint32_t>&              order,
+                                    std::vector<uint32_t>&              clusters) {
+        if (clusters.size() < 2)
+            return;
+
+        struct Cluster {
+            uint32_t  begin, end;
+            glm::vec3 centroid{0.0f}; // area weighted
+            glm::vec3 normal{0.0f};   // area weighted
+            float     area     = 0.0f;
+            float     sort_key = 0.0f;
+        };
+        std::vector<Cluster> list(clusters.size());
+        glm::vec3            centroid{0.0f};
+        float                area = 0.0f;
+        for (size_t c = 0; c < clusters.size(); ++c) {
+            Cluster& cluster = list[c];
+            cluster.begin    = clusters[c];
+            cluster.end      = c + 1 < clusters.size() ? clusters[c + 1]
+                                                       : static_cast<uint32_t>(order.size());
+            for (uint32_t t = cluster.begin; t < cluster.end; ++t) {
+                const glm::vec3& p0 = vertices[indices[order[t] * 3 + 0]].position;
+                const glm::vec3& p1 = vertices[indices[order[t] * 3 + 1]].position;
+                const glm::vec3& p2 = vertices[indices[order[t] * 3 + 2]].position;
+                glm::vec3        n  = glm::cross(p1 - p0, p2 - p0);
+                float            a  = glm::length(n) * 0.5f;
+                cluster.normal += n;
+                cluster.centroid += (p0 + p1 + p2) * (a / 3.0f);
+                cluster.area += a;
+            }
+            centroid += cluster.centroid;
+            area += cluster.area;
+        }
+        if (area <= 0.0f)
+            return;
+        centroid /= area;
+
+        for (auto& cluster : list) {
+            if (cluster.area <= 0.0f || glm::length(cluster.normal) <= 0.0f)
+                continue;
+            cluster.sort_key = glm::dot(cluster.centroid / cluster.area - centroid,
+                                        glm::normalize(cluster.normal));
+        }
+        std::stable_sort(list.begin(), list.end(), [](const Cluster& a, const Cluster& b) {
+            return a.sort_key > b.sort_key;
+        });
+
+        std::vector<uint32_t> sorted;
+        sorted.reserve(order.size());
+        for (size_t c = 0; c < list.size(); ++c) {
+            clusters[c] = static_cast<uint32_t>(sorted.size());
+            sorted.insert(sorted.end(), order.begin() + list[c].begin,
+                          order.begin() + list[c].end);
+        }
+        order.swap(sorted);
+    }
+
+    // The triangles of a submesh bucketed by centroid into a uniform grid, about
+    // TRIANGLES_PER_CELL per cell, so build_clusters() finds the loose triangles near a cluster
+    // without looking at all of them. Taken triangles leave their cell once a lookup meets them.
+    struct CentroidGrid {
+        static constexpr float TRIANGLES_PER_CELL = 8.0f;
+
+        glm::vec3             origin{0.0f};
+        float                 cell = 1.0f;
+        glm::ivec3            dims{1};
+        std::vector<uint32_t> begin, end, triangles;
+
+        void build(const std::vector<glm::vec3>& centroids) {
+            glm::vec3 lo = centroids[0], hi = lo;
+            for (const auto& c : centroids) {
+                lo = glm::min(lo, c);
+                hi = glm::max(hi, c);
+            }
+            const glm::vec3 extent  = hi - lo;
+            const float     largest = std::max({extent.x, extent.y, extent.z});
+            const float per_axis = std::cbrt(float(centroids.size()) / TRIANGLES_PER_CELL);
+            origin               = lo;
+            cell                 = largest > 0.0f ? largest / std::max(per_axis, 1.0f) : 1.0f;
+            dims                 = glm::ivec3(extent / cell) + 1;
+
+            const size_t cells = size_t(dims.x) * dims.y * dims.z;
+            begin.assign(cells + 1, 0);
+            for (const auto& c : centroids)
+                ++begin[cell_of(c) + 1];
+            std::partial_sum(begin.begin(), begin.end(), begin.begin());
+            end.assign(begin.begin(), begin.end() - 1);
+            triangles.resize(centroids.size());
+            for (size_t t = 0; t < centroids.size(); ++t)
+                triangles[end[cell_of(centroids[t])]++] = static_cast<uint32_t>(t);
+        }
+
+        glm::ivec3 coords(const glm::vec3& p) const {
+            return glm::clamp(glm::ivec3(glm::floor((p - origin) / cell)), glm::ivec3(0),
+                              dims - 1);
+        }
+
+        size_t cell_of(const glm::vec3& p) const {
+            const glm::ivec3 c = coords(p);
+            return (size_t(c.z) * dims.y + c.y) * dims.x + c.x;
+        }
+
+        // visit(t) for the triangles not taken yet whose cells overlap the box around center
+        template <typename Visit>
+        void for_each_near(const glm::vec3& center, float radius, const std::vector<bool>& taken,
+                           Visit&& visit) {
+            const glm::ivec3 lo = coords(center - radius), hi = coords(center + radius);
+            for (int z = lo.z; z <= hi.z; ++z) {
+                for (int y = lo.y; y <= hi.y; ++y) {
+                    for (int x = lo.x; x <= hi.x; ++x) {
+                        const size_t c = (size_t(z) * dims.y + y) * dims.x + x;
+                        for (uint32_t i = begin[c]; i < end[c];) {
+                            const uint32_t triangle = triangles[i];
+                            if (taken[triangle]) {
+                                triangles[i] = triangles[--end[c]];
+                                continue;
+                            }
+                            visit(triangle);
+                            ++i;
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    // vertices in order of first use
+    void renumber_vertices(Models::MeshData& mesh) {
+        std::vector<uint32_t>       remap(mesh.vertices.size(), NONE);
+        std::vector<Models::Vertex> vertices;
+        vertices.reserve(mesh.vertices.size());
+        for (auto& index : mesh.indices) {
+            if (remap[index] == NONE) {
+                remap[index] = static_cast<uint32_t>(vertices.size());
+                vertices.push_back(mesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+        // build_mesh() only makes vertices some triangle uses, but keep any stragglers
+        for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+            if (remap[v] == NONE)
+                vertices.push_back(mesh.vertices[v]);
+        }
+        mesh.vertices.swap(vertices);
+    }
+
+    // Bounding sphere (around the AABB centre) and normal cone of triangles
+    void cluster_bounds(const uint32_t* indices, size_t index_count,
+                        const std::vector<Models::Vertex>& vertices, Cluster& cluster) {
+        glm::vec3 aabb_min = vertices[indices[0]].position, aabb_max = aabb_min;
+        for (size_t i = 0; i < index_count; ++i) {
+            aabb_min = glm::min(aabb_min, vertices[indices[i]].position);
+            aabb_max = glm::max(aabb_max, vertices[indices[i]].position);
+        }
+        cluster.center = 0.5f * (aabb_min + aabb_max);
+        cluster.radius = 0.0f;
+        for (size_t i = 0; i < index_count; ++i)
+            cluster.radius = std::max(cluster.radius,
+                                      glm::length(vertices[indices[i]].position - cluster.center));
+
+        std::vector<glm::vec3> normals;
+        glm::vec3              sum{0.0f};
+        for (size_t i = 0; i + 2 < index_count; i += 3) {
+            const glm::vec3& p0 = vertices[indices[i + 0]].position;
+            const glm::vec3& p1 = vertices[indices[i + 1]].position;
+            const glm::vec3& p2 = vertices[indices[i + 2]].position;
+            const glm::vec3  n  = glm::cross(p1 - p0, p2 - p0);
+            const float      length = glm::length(n);
+            if (!(length > 0.0f))
+                continue;
+            normals.push_back(n / length);
+            sum += normals.back();
+        }
+        // no cone for clusters whose normals spread over (almost) a half sphere
+        cluster.cone_axis   = glm::vec3(0.0f, 0.0f, 1.0f);
+        cluster.cone_cutoff = 1.0f;
+        const float length  = glm::length(sum);
+        if (normals.empty() || !(length > 0.0f))
+            return;
+        cluster.cone_axis = sum / length;
+        float min_dot     = 1.0f;
+        for (const auto& n : normals)
+            min_dot = std::min(min_dot, glm::dot(n, cluster.cone_axis));
+        if (min_dot > 0.1f)
+            cluster.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+    }
+
+} // namespace
+
+Models::VertexCacheStats Models::analyze_vertex_cache(const MeshData& mesh, uint32_t cache_size) {
+    VertexCacheStats stats;
+    if (mesh.indices.empty())
+        return stats;
+
+    // FIFO: a vertex stays cached until cache_size other vertices were transformed after it
+    std::vector<uint64_t> inserted(mesh.vertices.size(), 0);
+    std::vector<bool>     used(mesh.vertices.size(), false);
+    uint64_t              transformed = 0;
+    uint64_t              clock       = cache_size + 1;
+    size_t                triangles = 0, used_count = 0;
+    for (const auto& sm : mesh.submeshes) {
+        // a new draw starts with an empty cache
+        clock += cache_size + 1;
+        for (uint32_t i = sm.index_offset; i < sm.index_offset + sm.index_count; ++i) {
+            const uint32_t v = mesh.indices[i];
+            if (clock - inserted[v] > cache_size) {
+                inserted[v] = clock++;
+                ++transformed;
+            }
+            if (!used[v]) {
+                used[v] = true;
+                ++used_count;
+            }
+        }
+        triangles += sm.index_count / 3;
+    }
+    stats.acmr = triangles ? double(transformed) / triangles : 0.0;
+    stats.atvr = used_count ? double(transformed) / used_count : 0.0;
+    return stats;
+}
+
+void Models::optimize_mesh(MeshData& mesh, const OptimizeOptions& options) {
+    std::vector<uint32_t> order, clusters, reordered;
+    for (const auto& sm : mesh.submeshes) {
+        const uint32_t* indices   = mesh.indices.data() + sm.index_offset;
+        const size_t    triangles = sm.index_count / 3;
+        order.clear();
+        clusters.clear();
+        tipsify(indices, triangles, mesh.vertices.size(), options.cache_size, order, clusters);
+        if (options.overdraw)
+            sort_clusters_for_overdraw(indices, mesh.vertices, order, clusters);
+
+        reordered.clear();
+        for (uint32_t triangle : order)
+            reordered.insert(reordered.end(), indices + triangle * 3, indices + triangle * 3 + 3);
+        std::copy(reordered.begin(), reordered.end(), mesh.indices.begin() + sm.index_offset);
+    }
+
+    renumber_vertices(mesh);
+}
+
+void Models::build_clusters(MeshData& mesh, const ClusterOptions& options) {
+    const uint32_t         cache_size = OptimizeOptions{}.cache_size;
+    std::vector<uint32_t>  offsets, adjacency, fill, members, candidates, reordered;
+    std::vector<uint32_t>  local, global, order, starts;
+    // cluster_id while a cluster grows, cluster_id + 1 once it has a local number
+    std::vector<uint32_t>  vertex_stamp(mesh.vertices.size(), NONE);
+    std::vector<uint32_t>  local_id(mesh.vertices.size());
+    std::vector<glm::vec3> centroids, facets;
+    std::vector<bool>      assigned;
+    CentroidGrid           loose;
+    for (auto& sm : mesh.submeshes) {
+        sm.clusters.clear();
+        uint32_t* const indices   = mesh.indices.data() + sm.index_offset;
+        const size_t    triangles = sm.index_count / 3;
+        if (triangles == 0)
+            continue;
+
+        // triangles around every vertex of this submesh
+        offsets.assign(mesh.vertices.size() + 1, 0);
+        for (size_t i = 0; i < triangles * 3; ++i)
+            ++offsets[indices[i] + 1];
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        adjacency.resize(triangles * 3);
+        fill.assign(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangles * 3; ++i)
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+        centroids.resize(triangles);
+        facets.resize(triangles);
+        for (size_t t = 0; t < triangles; ++t) {
+            const glm::vec3& p0    = mesh.vertices[indices[t * 3 + 0]].position;
+            const glm::vec3& p1    = mesh.vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& p2    = mesh.vertices[indices[t * 3 + 2]].position;
+            const glm::vec3  n     = glm::cross(p1 - p0, p2 - p0);
+            const float      area2 = glm::length(n);
+            centroids[t]           = (p0 + p1 + p2) / 3.0f;
+            facets[t]              = area2 > 0.0f ? n / area2 : glm::vec3(0.0f);
+        }
+        assigned.assign(triangles, false);
+        loose.build(centroids);
+        reordered.clear();
+        size_t   seed       = 0;
+        uint32_t cluster_id = 0;
+        while (true) {
+            // every cluster starts at the first triangle the old order still has left, so
+            // the clusters keep roughly the order optimize_mesh() gave the triangles
+            while (seed < triangles && assigned[seed])
+                ++seed;
+            if (seed == triangles)
+                break;
+
+            members.clear();
+            candidates.clear();
+            size_t    vertex_count = 0;
+            glm::vec3 centroid{0.0f}, normal{0.0f};
+            auto      add = [&](uint32_t triangle) {
+                assigned[triangle] = true;
+                members.push_back(triangle);
+                normal += facets[triangle];
+                for (int k = 0; k < 3; ++k) {
+                    const uint32_t v = indices[triangle * 3 + k];
+                    centroid += mesh.vertices[v].position;
+                    if (vertex_stamp[v] != cluster_id) {
+                        vertex_stamp[v] = cluster_id;
+                        ++vertex_count;
+                    }
+                    for (uint32_t a = offsets[v]; a < offsets[v + 1]; ++a) {
+                        if (!assigned[adjacency[a]])
+                            candidates.push_back(adjacency[a]);
+                    }
+                }
+            };
+            add(static_cast<uint32_t>(seed));
+
+            // grow with a neighbour that brings no new vertex if there is one, otherwise the
+            // one that is closest and faces the way the cluster does, until a limit is hit
+            // or nothing near fits
+            while (members.size() < options.max_triangles) {
+                const glm::vec3 center = centroid / float(members.size() * 3);
+                const float     length = glm::length(normal);
+                const glm::vec3 axis   = length > 0.0f ? normal / length : glm::vec3(0.0f);
+                uint32_t        best   = NONE;
+                bool            best_free  = false;
+                float           best_score = std::numeric_limits<float>::max();
+                auto            consider   = [&](uint32_t triangle) {
+                    int fresh = 0;
+                    for (int k = 0; k < 3; ++k)
+                        fresh += vertex_stamp[indices[triangle * 3 + k]] != cluster_id;
+                    if (vertex_count + fresh > options.max_vertices || (best_free && fresh))
+                        return;
+                    const float score =
+                        glm::length(centroids[triangle] - center) *
+                        (1.0f + options.cone_weight * (1.0f - glm::dot(facets[triangle], axis)));
+                    if ((fresh == 0 && !best_free) || score < best_score) {
+                        best       = triangle;
+                        best_free  = fresh == 0;
+                        best_score = score;
+                    }
+                };
+                size_t kept = 0;
+                for (uint32_t triangle : candidates) {
+                    if (assigned[triangle])
+                        continue;
+                    candidates[kept++] = triangle;
+                    consider(triangle);
+                }
+                candidates.resize(kept);
+                if (best == NONE) {
+                    // nothing connected fits: flat shaded meshes share no vertices, so look
+                    // at the loose triangles not further away than the cluster is wide,
+                    // otherwise those would stay clusters of a few triangles
+                    float radius = 0.0f;
+                    for (uint32_t triangle : members) {
+                        for (int k = 0; k < 3; ++k) {
+                            const glm::vec3& p = mesh.vertices[indices[triangle * 3 + k]].position;
+                            radius             = std::max(radius, glm::length(p - center));
+                        }
+                    }
+                    loose.for_each_near(center, 2.0f * radius, assigned, [&](uint32_t triangle) {
+                        if (glm::length(centroids[triangle] - center) <= 2.0f * radius)
+                            consider(triangle);
+                    });
+                }
+                if (best == NONE)
+                    break;
+                add(best);
+            }
+
+            // inside the cluster: the old order, tipsified again for the cache on cluster
+            // local vertex numbers
+            std::sort(members.begin(), members.end());
+            local.clear();
+            for (uint32_t triangle : members) {
+                for (int k = 0; k < 3; ++k) {
+                    const uint32_t v = indices[triangle * 3 + k];
+                    if (vertex_stamp[v] == cluster_id) {
+                        vertex_stamp[v] = cluster_id + 1; // numbered
+                        local_id[v]     = static_cast<uint32_t>(global.size());
+                        global.push_back(v);
+                    }
+                    local.push_back(local_id[v]);
+                }
+            }
+            order.clear();
+            starts.clear();
+            tipsify(local.data(), members.size(), global.size(), cache_size, order, starts);
+
+            Cluster cluster;
+            cluster.index_offset = static_cast<uint32_t>(sm.index_offset + reordered.size());
+            cluster.index_count  = static_cast<uint32_t>(members.size() * 3);
+            for (uint32_t triangle : order) {
+                for (int k = 0; k < 3; ++k)
+                    reordered.push_back(global[local[triangle * 3 + k]]);
+            }
+            sm.clusters.push_back(cluster);
+            global.clear();
+            cluster_id += 2;
+        }
+        if (options.overdraw && sm.clusters.size() > 1) {
+            // growing through neighbours scatters the outer first order optimize_mesh() gave
+            // the triangles over the clusters, sort the clusters the same way to get it back
+            order.resize(triangles);
+            std::iota(order.begin(), order.end(), 0u);
+            starts.clear();
+            for (const auto& cluster : sm.clusters)
+                starts.push_back((cluster.index_offset - sm.index_offset) / 3);
+            sort_clusters_for_overdraw(reordered.data(), mesh.vertices, order, starts);
+            for (size_t c = 0; c < starts.size(); ++c) {
+                const size_t next    = c + 1 < starts.size() ? starts[c + 1] : triangles;
+                Cluster&     cluster = sm.clusters[c];
+                cluster.index_offset = static_cast<uint32_t>(sm.index_offset + starts[c] * 3);
+                cluster.index_count  = static_cast<uint32_t>((next - starts[c]) * 3);
+            }
+            for (size_t t = 0; t < triangles; ++t)
+                std::copy_n(reordered.begin() + order[t] * 3, 3, indices + t * 3);
+        } else {
+            std::copy(reordered.begin(), reordered.end(), indices);
+        }
+        for (auto& cluster : sm.clusters)
+            cluster_bounds(mesh.indices.data() + cluster.index_offset, cluster.index_count,
+                           mesh.vertices, cluster);
+        // a new submesh must not see this one's stamps
+        std::fill(vertex_stamp.begin(), vertex_stamp.end(), NONE);
+    }
+    renumber_vertices(mesh);
+}
+
+Models::ClusterView Models::make_cluster_view(const glm::mat4& model_view,
+                                              const glm::mat4& projection, bool cull_front_faces) {
+    ClusterView view;
+    // Gribb and Hartmann, on the model space clip matrix
+    const glm::mat4 clip = glm::transpose(projection * model_view);
+    view.planes          = {clip[3] + clip[0], clip[3] - clip[0], clip[3] + clip[1],
+                            clip[3] - clip[1], clip[3] + clip[2], clip[3] - clip[2]};
+    for (auto& plane : view.planes)
+        plane /= glm::length(glm::vec3(plane));
+
+    const glm::mat4 inverse = glm::inverse(model_view);
+    const glm::vec4 forward(0.0f, 0.0f, -1.0f, 0.0f);
+    view.eye          = glm::vec3(inverse[3]);
+    view.direction    = glm::normalize(glm::vec3(inverse * forward));
+    view.orthographic = projection[2][3] == 0.0f;
+    view.facing       = cull_front_faces ? -1.0f : 1.0f;
+    if (glm::determinant(glm::mat3(model_view)) < 0.0f)
+        view.facing = -view.facing;
+    return view;
+}
+
+bool Models::cluster_visible(const Cluster& cluster, const ClusterView& view) {
+    for (const auto& plane : view.planes) {
+        if (glm::dot(glm::vec3(plane), cluster.center) + plane.w < -cluster.radius)
+            return false;
+    }
+    if (!(cluster.cone_cutoff < 1.0f))
+        return true;
+    const glm::vec3 axis = cluster.cone_axis * view.facing;
+    if (view.orthographic)
+        return glm::dot(view.direction, axis) < cluster.cone_cutoff;
+    const glm::vec3 to_center = cluster.center - view.eye;
+    return glm::dot(to_center, axis) <
+           cluster.cone_cutoff * glm::length(to_center) + cluster.radius;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Mesh.h"
+#include <array>
+#include <cstdint>
+
+namespace Models {
+
+    // Reordering of a built mesh for the GPU. Every submesh draws the same triangles with the
+    // same winding afterwards, only their order and the numbering of the vertices change.
+    struct OptimizeOptions {
+        // post-transform cache entries the triangle order is tuned for
+        uint32_t cache_size = 16;
+        // also sort the clusters the cache pass produces so the ones facing away from the
+        // centre of the mesh are drawn first and hide the rest (less overdraw)
+        bool overdraw = true;
+    };
+
+    // Post-transform cache behaviour of the index buffer, simulated as a FIFO of cache_size
+    // entries that is flushed between submeshes.
+    // acmr: vertices transformed per triangle, 3 is the worst, about 0.5 the best a big grid
+    // can get. atvr: vertices transformed per vertex used, 1 is the best.
+    struct VertexCacheStats {
+        double acmr = 0.0;
+        double atvr = 0.0;
+    };
+
+    VertexCacheStats analyze_vertex_cache(const MeshData& mesh, uint32_t cache_size = 16);
+
+    // Tipsify (Sander, Nehab and Barczak 2007) on the triangles of every submesh, then the
+    // vertices renumbered in the order the index buffer first uses them so fetches walk the
+    // vertex buffer forward.
+    void optimize_mesh(MeshData& mesh, const OptimizeOptions& options = {});
+
+    // Limits of one cluster, the defaults fit the usual meshlet sizes
+    struct ClusterOptions {
+        uint32_t max_vertices  = 64;
+        uint32_t max_triangles = 124;
+        // how much more a neighbour counts as further away when its normal leaves the ones
+        // of the cluster, 0 only looks at the distance; tighter normals make the cone cull
+        float cone_weight = 1.0f;
+        // sort the clusters the way OptimizeOptions::overdraw sorts the cache pass's
+        bool overdraw = true;
+    };
+
+    // Splits the triangles of every submesh into SubMesh::clusters: each one grows from the
+    // first triangle not taken yet through its neighbours, preferring the ones that add the
+    // fewest vertices and lie closest, and gets a bounding sphere and normal cone for culling.
+    // The triangles are stored cluster by cluster (each tipsified again, the clusters in
+    // overdraw order) and the vertices renumbered, so run it after optimize_mesh() and before
+    // build_lods().
+    void build_clusters(MeshData& mesh, const ClusterOptions& options = {});
+
+    // A view brought into model space for cluster culling: the frustum planes (normalised,
+    // pointing inside) and the eye, or the view direction for orthographic projections.
+    // facing is 1 when the pass culls back faces, -1 when it culls front faces, mirrored
+    // transforms flip it.
+    struct ClusterView {
+        std::array<glm::vec4, 6> planes;
+        glm::vec3                eye;
+        glm::vec3                direction;
+        bool                     orthographic;
+        float                    facing;
+    };
+
+    ClusterView make_cluster_view(const glm::mat4& model_view, const glm::mat4& projection,
+                                  bool cull_front_faces);
+    // false when the cluster is outside the frustum or every triangle of it gets face culled
+    bool cluster_visible(const Cluster& cluster, const ClusterView& view);
+
+} // namespace Models
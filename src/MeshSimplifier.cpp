@@ -0,0 +1,319 @@
+#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+
+    // Sum of squared distances to a set of weighted planes, as the upper triangle of the
+    // symmetric 4x4 matrix. error() divides by the total weight, so it is a squared distance.
+    struct Quadric {
+        double a2 = 0, ab = 0, ac = 0, ad = 0;
+        double b2 = 0, bc = 0, bd = 0;
+        double c2 = 0, cd = 0;
+        double d2 = 0;
+        double w  = 0;
+
+        void add_plane(const glm::vec3& normal, const glm::vec3& point, double weight) {
+            const double a = normal.x, b = normal.y, c = normal.z;
+            const double d = -(a * point.x + b * point.y + c * point.z);
+            a2 += weight * a * a;
+            ab += weight * a * b;
+            ac += weight * a * c;
+            ad += weight * a * d;
+            b2 += weight * b * b;
+            bc += weight * b * c;
+            bd += weight * b * d;
+            c2 += weight * c * c;
+            cd += weight * c * d;
+            d2 += weight * d * d;
+            w += weight;
+        }
+
+        void add(const Quadric& q) {
+            a2 += q.a2;
+            ab += q.ab;
+            ac += q.ac;
+            ad += q.ad;
+            b2 += q.b2;
+            bc += q.bc;
+            bd += q.bd;
+            c2 += q.c2;
+            cd += q.cd;
+            d2 += q.d2;
+            w += q.w;
+        }
+
+        // unnormalised
+        double evaluate(const glm::vec3& p) const {
+            const double x = p.x, y = p.y, z = p.z;
+            return a2 * x * x + b2 * y * y + c2 * z * z +
+                   2 * (ab * x * y + ac * x * z + bc * y * z + ad * x + bd * y + cd * z) + d2;
+        }
+    };
+
+    // squared distance from p to the planes of both quadrics
+    double collapse_error(const Quadric& from, const Quadric& to, const glm::vec3& p) {
+        const double w = from.w + to.w;
+        return w > 0 ? std::abs(from.evaluate(p) + to.evaluate(p)) / w : 0.0;
+    }
+
+    // how a vertex may move
+    enum class Kind : uint8_t {
+        Manifold, // onto any neighbour
+        Border,   // along a border edge only
+        Locked,   // never
+    };
+
+    inline uint64_t edge_key(uint32_t a, uint32_t b) {
+        return a < b ? (uint64_t{a} << 32) | b : (uint64_t{b} << 32) | a;
+    }
+
+    struct Collapse {
+        uint32_t from, to;
+        double   error;
+    };
+
+    // border edges pull harder than faces, otherwise open outlines shrink first
+    constexpr double BORDER_WEIGHT = 10.0;
+
+} // namespace
+
+std::vector<uint32_t> Models::simplify(const std::vector<Vertex>& vertices,
+                                       const uint32_t* indices, size_t index_count,
+                                       size_t target_index_count, float target_error,
+                                       float* result_error) {
+    std::vector<uint32_t> result(indices, indices + index_count - index_count % 3);
+    if (result_error)
+        *result_error = 0.0f;
+    if (result.size() <= target_index_count || vertices.empty())
+        return result;
+
+    const size_t vertex_count = vertices.size();
+    glm::vec3    aabb_min = vertices[0].position, aabb_max = aabb_min;
+    for (const auto& v : vertices) {
+        aabb_min = glm::min(aabb_min, v.position);
+        aabb_max = glm::max(aabb_max, v.position);
+    }
+    const double extent = glm::length(aabb_max - aabb_min);
+    if (!(extent > 0.0))
+        return result;
+    const double error_limit = double(target_error) * extent * double(target_error) * extent;
+
+    // vertices sharing a position with another one sit on a UV or normal seam, moving one
+    // side would tear the surface open
+    std::vector<bool>     seam(vertex_count, false);
+    std::vector<uint32_t> by_position(vertex_count);
+    std::iota(by_position.begin(), by_position.end(), 0u);
+    auto position_less = [&](uint32_t a, uint32_t b) {
+        const glm::vec3& p = vertices[a].position;
+        const glm::vec3& q = vertices[b].position;
+        if (p.x != q.x)
+            return p.x < q.x;
+        if (p.y != q.y)
+            return p.y < q.y;
+        return p.z < q.z;
+    };
+    std::sort(by_position.begin(), by_position.end(), position_less);
+    for (size_t i = 1; i < vertex_count; ++i) {
+        if (vertices[by_position[i]].position == vertices[by_position[i - 1]].position)
+            seam[by_position[i]] = seam[by_position[i - 1]] = true;
+    }
+
+    // triangles per edge of the input, borders have one
+    std::unordered_map<uint64_t, uint32_t> edge_triangles;
+    auto count_edges = [&]() {
+        edge_triangles.clear();
+        edge_triangles.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; ++k)
+                ++edge_triangles[edge_key(result[i + k], result[i + (k + 1) % 3])];
+        }
+    };
+    count_edges();
+
+    std::vector<Quadric> quadrics(vertex_count);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        const glm::vec3& p0 = vertices[result[i + 0]].position;
+        const glm::vec3& p1 = vertices[result[i + 1]].position;
+        const glm::vec3& p2 = vertices[result[i + 2]].position;
+        glm::vec3        n  = glm::cross(p1 - p0, p2 - p0);
+        const float      length = glm::length(n);
+        if (!(length > 0.0f))
+            continue;
+        n /= length;
+        for (int k = 0; k < 3; ++k)
+            quadrics[result[i + k]].add_plane(n, p0, 0.5 * length);
+
+        for (int k = 0; k < 3; ++k) {
+            const uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+            if (edge_triangles[edge_key(a, b)] != 1)
+                continue;
+            // plane through the border edge, perpendicular to the triangle
+            const glm::vec3 edge   = vertices[b].position - vertices[a].position;
+            glm::vec3       normal = glm::cross(edge, n);
+            const float     normal_length = glm::length(normal);
+            if (!(normal_length > 0.0f))
+                continue;
+            normal /= normal_length;
+            const double weight = BORDER_WEIGHT * glm::dot(edge, edge);
+            quadrics[a].add_plane(normal, vertices[a].position, weight);
+            quadrics[b].add_plane(normal, vertices[a].position, weight);
+        }
+    }
+
+    std::vector<Kind>     kind(vertex_count);
+    std::vector<uint32_t> offsets(vertex_count + 1), adjacency, fill;
+    std::vector<uint32_t> remap(vertex_count);
+    std::vector<bool>     touched(vertex_count);
+    std::vector<Collapse> candidates;
+    double                max_error = 0.0;
+
+    while (result.size() > target_index_count) {
+        // the topology changed since the last pass
+        std::fill(kind.begin(), kind.end(), Kind::Manifold);
+        for (const auto& [key, count] : edge_triangles) {
+            const Kind edge_kind = count == 1   ? Kind::Border
+                                   : count == 2 ? Kind::Manifold
+                                                : Kind::Locked;
+            for (uint32_t v : {uint32_t(key >> 32), uint32_t(key)})
+                kind[v] = std::max(kind[v], edge_kind);
+        }
+        for (size_t v = 0; v < vertex_count; ++v) {
+            if (seam[v])
+                kind[v] = Kind::Locked;
+        }
+
+        // triangles around every vertex
+        std::fill(offsets.begin(), offsets.end(), 0u);
+        for (uint32_t v : result)
+            ++offsets[v + 1];
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        adjacency.resize(result.size());
+        fill.assign(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i)
+            adjacency[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+
+        candidates.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                const uint32_t a = result[i + k], b = result[i + (k + 1) % 3];
+                const bool     border = edge_triangles[edge_key(a, b)] == 1;
+                for (auto [from, to] : {std::pair{a, b}, std::pair{b, a}}) {
+                    if (kind[from] == Kind::Locked ||
+                        (kind[from] == Kind::Border && (!border || kind[to] == Kind::Manifold)))
+                        continue;
+                    const double error =
+                        collapse_error(quadrics[from], quadrics[to], vertices[to].position);
+                    if (error <= error_limit)
+                        candidates.push_back({from, to, error});
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        // cheapest first; everything a collapse changes is frozen for the rest of the pass so
+        // the checks of the later ones still see the real neighbourhood
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::fill(touched.begin(), touched.end(), false);
+        const size_t needed    = (result.size() - target_index_count + 2) / 3;
+        size_t       removed   = 0;
+        size_t       collapses = 0;
+        for (const auto& c : candidates) {
+            if (removed >= needed)
+                break;
+            if (touched[c.from] || touched[c.to])
+                continue;
+
+            // no triangle that survives may turn over or degenerate
+            const glm::vec3& target = vertices[c.to].position;
+            bool             flips  = false;
+            size_t           dying  = 0;
+            for (uint32_t a = offsets[c.from]; a < offsets[c.from + 1] && !flips; ++a) {
+                const uint32_t* tri = &result[adjacency[a] * 3];
+                if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+                    ++dying;
+                    continue;
+                }
+                glm::vec3 p[3], q[3];
+                for (int k = 0; k < 3; ++k) {
+                    p[k] = vertices[tri[k]].position;
+                    q[k] = tri[k] == c.from ? target : p[k];
+                }
+                const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                const glm::vec3 after  = glm::cross(q[1] - q[0], q[2] - q[0]);
+                flips = glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after);
+            }
+            if (flips)
+                continue;
+
+            remap[c.from] = c.to;
+            touched[c.from] = touched[c.to] = true;
+            for (uint32_t a = offsets[c.from]; a < offsets[c.from + 1]; ++a) {
+                const uint32_t* tri = &result[adjacency[a] * 3];
+                touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+            }
+            quadrics[c.to].add(quadrics[c.from]);
+            max_error = std::max(max_error, c.error);
+            removed += dying;
+            ++collapses;
+        }
+        if (collapses == 0)
+            break;
+
+        size_t kept = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            const uint32_t a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+            if (a == b || b == c || c == a)
+                continue;
+            result[kept++] = a;
+            result[kept++] = b;
+            result[kept++] = c;
+        }
+        result.resize(kept);
+        count_edges();
+    }
+
+    if (result_error)
+        *result_error = static_cast<float>(std::sqrt(max_error) / extent);
+    return result;
+}
+
+void Models::build_lods(MeshData& mesh, const LodOptions& options) {
+    mesh.lod_errors.clear();
+    for (auto& sm : mesh.submeshes)
+        sm.lods.clear();
+
+    std::vector<std::vector<uint32_t>> level(mesh.submeshes.size());
+    float                              error = 0.0f;
+    for (uint32_t l = 0; l < options.max_levels && error < options.max_error; ++l) {
+        size_t before = 0, after = 0;
+        float  level_error = 0.0f;
+        for (size_t s = 0; s < mesh.submeshes.size(); ++s) {
+            const SubMesh& sm    = mesh.submeshes[s];
+            const LodRange last  = sm.lods.empty() ? LodRange{sm.index_offset, sm.index_count}
+                                                   : sm.lods.back();
+            const size_t   target = size_t(last.index_count / 3 * options.ratio) * 3;
+            float          e      = 0.0f;
+            level[s] = simplify(mesh.vertices, mesh.indices.data() + last.index_offset,
+                                last.index_count, target, options.max_error - error, &e);
+            level_error = std::max(level_error, e);
+            before += last.index_count;
+            after += level[s].size();
+        }
+        if (after * 5 > before * 4)
+            break;
+
+        for (size_t s = 0; s < mesh.submeshes.size(); ++s) {
+            mesh.submeshes[s].lods.push_back({static_cast<uint32_t>(mesh.indices.size()),
+                                              static_cast<uint32_t>(level[s].size())});
+            mesh.indices.insert(mesh.indices.end(), level[s].begin(), level[s].end());
+        }
+        // each level was measured against the one before, not against the full mesh
+        error += level_error;
+        mesh.lod_errors.push_back(error);
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Mesh.h"
+#include <cstdint>
+#include <vector>
+
+namespace Models {
+
+    // Quadric error edge collapse (Garland and Heckbert 1997) over the triangles of indices.
+    // A vertex only ever collapses onto one of its neighbours, so the result indexes the same
+    // vertex buffer. Border edges are held in place by extra quadrics and only collapse along
+    // the border; vertices on an attribute seam (several vertices at one position) or on a
+    // non-manifold edge never move.
+    // Stops at target_index_count or before the error would pass target_error, whichever comes
+    // first. Errors are distances relative to the diagonal of the AABB of vertices,
+    // result_error (optional) gets the largest one of the collapses that were made.
+    std::vector<uint32_t> simplify(const std::vector<Vertex>& vertices, const uint32_t* indices,
+                                   size_t index_count, size_t target_index_count,
+                                   float target_error, float* result_error = nullptr);
+
+    struct LodOptions {
+        // levels on top of the full mesh
+        uint32_t max_levels = 3;
+        // triangles of a level relative to the level before
+        float ratio = 0.5f;
+        // no level goes past this error, relative to the AABB diagonal
+        float max_error = 0.02f;
+    };
+
+    // Simplifies every submesh level by level, each from the one before, and appends the
+    // results to mesh.indices as SubMesh::lods with their error in mesh.lod_errors. Stops at
+    // the first level that would keep more than four fifths of the triangles of the last one.
+    void build_lods(MeshData& mesh, const LodOptions& options = {});
+
+} // namespace Models
@@ -1,11 +1,31 @@
 #include "Model.h"
+#include "MeshCache.h"
+#include "TextureRegistry.h"
+#include <stdexcept>
+#include <utility>
 
 static void print_vec3(glm::vec3 v) {
     std::cout << "(" << v.x << "," << v.y << "," << v.z << ")\n";
 }
 
+static GLenum index_type(const SubMesh& sm) {
+    return sm.index_size == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+// the triangles of sm at level lod, the coarsest one it has past its last
+static LodRange lod_range(const SubMesh& sm, uint32_t lod) {
+    if (lod == 0 || sm.lods.empty())
+        return {sm.index_offset, sm.index_count};
+    return sm.lods[std::min<size_t>(lod, sm.lods.size()) - 1];
+}
+
+// base is where the model's indices start in the arena's EBO
+static void* index_offset(const SubMesh& sm, const LodRange& range, size_t base) {
+    return (void*)(base + size_t(range.index_offset) * sm.index_size);
+}
+
 void Models::Model::debug_dump() const {
-    std::cout << "Transforms for: " << label << "\n";
+    std::cout << "Transforms for: " << label_ << "\n";
     if (is_instanced()) {
         for (size_t i = 0; i < instance_transforms.size(); i++) {
             std::cout << "===" << i << "====\n";
@@ -15,27 +35,6 @@ void Models::Model::debug_dump() const {
             print_vec3(instance_aabb_max[i]);
         }
     }
-    // size_t total_indices   = 0;
-    // size_t total_triangles = 0;
-    // for (auto const& sm : submeshes) {
-    //     total_indices   += sm.index_count;
-    //     total_triangles += sm.index_count / 3;
-    // }
-    //
-    // std::cout
-    //   << "  >>> Model built: "
-    //   << unique_vertices.size() << " unique vertices, "
-    //   << total_triangles         << " triangles, "
-    //   << total_indices           << " indices total\n"
-    //   << "      Submeshes: "     << submeshes.size() << "\n"
-    //   << "      AABB local min = ("
-    //      << localaabbmin.x << ", "
-    //      << localaabbmin.y << ", "
-    //      << localaabbmin.z << ")\n"
-    //   << "      AABB local max = ("
-    //      << localaabbmax.x << ", "
-    //      << localaabbmax.y << ", "
-    //      << localaabbmax.z << ")" << std::endl;
 }
 
 void Models::Model::move_relative_to(const glm::vec3& direction) {
@@ -62,10 +61,11 @@ Models::Model::Model(const std::vector<glm::vec3>& positions,
     , world_transform(1.0f)
     , localaabbmin(std::numeric_limits<float>::max())
     , localaabbmax(std::numeric_limits<float>::lowest())
-    , label(std::move(label))
+    , label_(std::move(label))
 {
 
-    unique_vertices.reserve(positions.size());
+    std::vector<Vertex> vertices;
+    vertices.reserve(positions.size());
     for (size_t i = 0; i < positions.size(); ++i) {
         Vertex vert;
         vert.position = positions[i];
@@ -77,7 +77,7 @@ Models::Model::Model(const std::vector<glm::vec3>& positions,
                         : glm::vec2(0.0f);
 
         vert.tangent  = glm::vec4(0.0f);
-        unique_vertices.push_back(vert);
+        vertices.push_back(vert);
 
         localaabbmin = glm::min(localaabbmin, vert.position);
         localaabbmax = glm::max(localaabbmax, vert.position);
@@ -89,297 +89,238 @@ Models::Model::Model(const std::vector<glm::vec3>& positions,
     sm.index_count  = static_cast<GLuint>(indices.size());
     submeshes.push_back(sm);
 
-    std::vector<glm::vec3> tan1(unique_vertices.size(), glm::vec3(0.0f));
-    std::vector<glm::vec3> tan2(unique_vertices.size(), glm::vec3(0.0f));
-
-    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
-        GLuint i0 = indices[i + 0];
-        GLuint i1 = indices[i + 1];
-        GLuint i2 = indices[i + 2];
-
-        const auto& v0 = unique_vertices[i0];
-        const auto& v1 = unique_vertices[i1];
-        const auto& v2 = unique_vertices[i2];
-
-        auto [T, B] = calculate_tangent_bitangent(v0, v1, v2);
-
-        tan1[i0] += T;  tan1[i1] += T;  tan1[i2] += T;
-        tan2[i0] += B;  tan2[i1] += B;  tan2[i2] += B;
-    }
-
-    for (size_t i = 0; i < unique_vertices.size(); ++i) {
-        orthogonalize_and_normalize_tb(unique_vertices[i], tan1, tan2, i);
-    }
-
-    GLCall(glGenVertexArrays(1, &vao));
-    GLCall(glGenBuffers(1,         &vbo));
-    GLCall(glGenBuffers(1,         &ebo));
-
-    GLCall(glBindVertexArray(vao));
-
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, vbo));
-    GLCall(glBufferData(GL_ARRAY_BUFFER,
-                        unique_vertices.size() * sizeof(Vertex),
-                        unique_vertices.data(),
-                        GL_STATIC_DRAW));
-
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo));
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                        indices.size() * sizeof(GLuint),
-                        indices.data(),
-                        GL_STATIC_DRAW));
-
-    GLCall(glEnableVertexAttribArray(0));
-    GLCall(glVertexAttribPointer(
-        0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-        (void*)offsetof(Vertex, position)));
-
-    GLCall(glEnableVertexAttribArray(1));
-    GLCall(glVertexAttribPointer(
-        1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-        (void*)offsetof(Vertex, texcoord)));
-
-    GLCall(glEnableVertexAttribArray(2));
-    GLCall(glVertexAttribPointer(
-        2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-        (void*)offsetof(Vertex, normal)));
-
-    GLCall(glEnableVertexAttribArray(3));
-    GLCall(glVertexAttribPointer(
-        3, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-        (void*)offsetof(Vertex, tangent)));
-
-    GLCall(glBindVertexArray(0));
+    compute_tangents(vertices, indices);
+    MeshData mesh;
+    mesh.vertices = std::move(vertices);
+    mesh.indices  = indices;
+    upload_buffers(mesh);
 }
 
 Models::Model::Model(const std::string& objFile, const std::string& label)
     : local_transform(1.0f), world_transform(1.0f), localaabbmin(std::numeric_limits<float>::max()),
-      localaabbmax(-std::numeric_limits<float>::max()), label(label) {
-    ObjectLoader::OBJLoader loader;
-    auto model_data = loader.read_from_file(objFile);
-
-    // build unique_vertices & a cache
-    std::unordered_map<Vertex, GLuint, VertexHasher> cache;
-    cache.reserve(model_data->m_faces.size() * 4);
+      localaabbmax(-std::numeric_limits<float>::max()), label_(label) {
+    // baked on first load, shared between every Model of the same file after that
+    auto mesh = MeshCache::load(objFile);
+
+    submeshes    = mesh->submeshes;
+    lod_errors   = mesh->lod_errors;
+    localaabbmin = mesh->aabb_min;
+    localaabbmax = mesh->aabb_max;
+    // The textures are held by the models, not the cached mesh, so they leave VRAM with the
+    // last model using them. The registry hands every model of a file the same ones; they are
+    // decoded here but reach the GPU when the render loop drains the queue.
+    for (auto& sm : submeshes) {
+        request_material_textures(sm.mat);
+    }
 
-    // bucket indices by material_id
-    std::unordered_map<int, std::vector<GLuint>> buckets;
+    upload_buffers(*mesh);
+}
 
-    auto add_vertex = [&](int vi, int ti, int ni) {
-        Vertex vert;
-        vert.position = glm::vec3(model_data->m_vertices[vi]);
-        if(ti >= 0 && ti < (int) model_data->m_texture_coords.size()) {
-            vert.texcoord = model_data->m_texture_coords[ti];
-        } else {
-            vert.texcoord = glm::vec2{0.0f, 0.0f};
+void Models::Model::upload_buffers(const MeshData& mesh) {
+    const MeshData::BakedStreams& baked        = mesh.baked;
+    const Vertex*                 vertices     = mesh.vertex_data();
+    const size_t                  vertex_count = mesh.vertex_count();
+    const size_t                  index_count  = mesh.index_count();
+    // indices half the size when every vertex can be reached with a GLushort, a baked mesh
+    // already has them that wide
+    const bool short_indices = vertex_count <= size_t{std::numeric_limits<GLushort>::max()} + 1;
+    const size_t index_size  = short_indices ? sizeof(GLushort) : sizeof(GLuint);
+    std::vector<GLushort> narrow;
+    const void*           index_data = baked.upload_indices;
+    if (!index_data && short_indices) {
+        narrow.assign(mesh.indices.begin(), mesh.indices.end());
+        index_data = narrow.data();
+    } else if (!index_data) {
+        index_data = mesh.indices.data();
+    }
+    for (auto& sm : submeshes) {
+        sm.index_size = static_cast<uint32_t>(index_size);
+    }
+    index_stats.bytes += index_count * index_size;
+    index_stats.saved += index_count * (sizeof(GLuint) - index_size);
+
+    const auto vertex_count32 = static_cast<uint32_t>(vertex_count);
+    const auto index_bytes    = static_cast<uint32_t>(index_count * index_size);
+    vertex_format = pack_vertices ? VertexFormat::Packed : VertexFormat::Float;
+    if (pack_vertices && baked.packed) {
+        packed_bounds = baked.packed_bounds;
+        arena_range   = MeshArena::shared().allocate(VertexFormat::Packed, baked.packed,
+                                                     vertex_count32, index_data, index_bytes);
+    } else if (pack_vertices) {
+        packed_bounds = Models::packed_bounds(mesh.vertices);
+        std::vector<PackedVertex> packed;
+        packed.reserve(vertex_count);
+        for (const auto& v : mesh.vertices) {
+            packed.push_back(pack_vertex(v, packed_bounds));
         }
+        arena_range = MeshArena::shared().allocate(VertexFormat::Packed, packed.data(),
+                                                   vertex_count32, index_data, index_bytes);
+    } else {
+        packed_bounds = PackedBounds{};
+        arena_range   = MeshArena::shared().allocate(VertexFormat::Float, vertices,
+                                                     vertex_count32, index_data, index_bytes);
+    }
+    vao = arena_range.vao();
+
+    const size_t vertex_bytes = vertex_count * sizeof(Vertex);
+    if (keep_vertices) {
+        unique_vertices.assign(vertices, vertices + vertex_count);
+        vertex_stats.kept += vertex_bytes;
+    } else {
+        vertex_stats.released += vertex_bytes;
+    }
+}
 
-        if(ni >= 0 && ni < (int) model_data->m_vertex_normals.size()) {
-            vert.normal = model_data->m_vertex_normals[ni];
-        } else {
-            vert.normal = glm::vec3{0.0f, 0.0f, 1.0f};
-        }
+void Models::Model::set_unpack_uniforms(Shader& shader, bool texcoords) const {
+    shader.set_vec3("uPosOffset", packed_bounds.position_offset);
+    shader.set_vec3("uPosScale", packed_bounds.position_scale);
+    if (texcoords) {
+        shader.set_vec2("uTexOffset", packed_bounds.texcoord_offset);
+        shader.set_vec2("uTexScale", packed_bounds.texcoord_scale);
+    }
+}
 
-        auto [it, inserted] = cache.emplace(vert, (GLuint)unique_vertices.size());
-        if (inserted) {
-            unique_vertices.push_back(vert);
+float Models::Model::projected_extent(const glm::mat4& view, const glm::mat4& projection,
+                                      InstanceSpan instances) const {
+    const glm::vec3 center = 0.5f * (localaabbmin + localaabbmax);
+    const float     radius = 0.5f * glm::length(localaabbmax - localaabbmin);
+    // clip w of a view space point, 1 for orthographic projections
+    const glm::vec3 w_row(projection[0][3], projection[1][3], projection[2][3]);
+    const float     w_slope = glm::length(w_row);
+
+    float largest = 0.0f;
+    auto  measure = [&](const glm::mat4& transform) {
+        const float scale = std::max({glm::length(glm::vec3(transform[0])),
+                                      glm::length(glm::vec3(transform[1])),
+                                      glm::length(glm::vec3(transform[2]))});
+        const glm::vec3 eye_center = glm::vec3(view * transform * glm::vec4(center, 1.0f));
+        // w at the point of the bounding sphere closest to the eye
+        const float w = glm::dot(w_row, eye_center) + projection[3][3] - radius * scale * w_slope;
+        if (w <= 1e-4f) {
+            largest = std::numeric_limits<float>::infinity();
+            return;
         }
-        return it->second;
+        // NDC is 2 units high
+        largest = std::max(largest, radius * scale * projection[1][1] / w);
     };
 
-    // for (auto const& face : loader.model_data.m_faces) {
-    for(auto const& face: model_data->m_faces) {
-        int material_id = face.material_id;
-        // unpack up to 4 verts; 3 if w == -1
-        int vertex_count = (face.vertices.w == -1 ? 3 : 4);
-        // first tri
-        buckets[material_id].push_back(
-            add_vertex(face.vertices[0], face.texcoords[0], face.normals[0]));
-        buckets[material_id].push_back(
-            add_vertex(face.vertices[1], face.texcoords[1], face.normals[1]));
-        buckets[material_id].push_back(
-            add_vertex(face.vertices[2], face.texcoords[2], face.normals[2]));
-        // second tri if quad
-        if (vertex_count == 4) {
-            buckets[material_id].push_back(
-                add_vertex(face.vertices[0], face.texcoords[0], face.normals[0]));
-            buckets[material_id].push_back(
-                add_vertex(face.vertices[2], face.texcoords[2], face.normals[2]));
-            buckets[material_id].push_back(
-                add_vertex(face.vertices[3], face.texcoords[3], face.normals[3]));
-        }
+    if (!is_instanced()) {
+        measure(world_transform);
+        return largest;
     }
+    for (uint32_t i : instances)
+        measure(instance_transforms[i]);
+    return largest;
+}
 
-    // flatten buckets → one big index array, record submeshes
-    std::vector<GLuint> all_indices;
-    all_indices.reserve(std::accumulate(buckets.begin(), buckets.end(), 0u,
-                                        [](auto sum, auto& p) { return sum + p.second.size(); }));
-
-    for (auto& [material_id, indexes] : buckets) {
-        SubMesh sm;
-        if (material_id >= 0) {
-            sm.mat = model_data->m_materials[material_id];
-        } else {
-            sm.mat = Material{};
-        }
-        sm.index_offset = (GLuint)all_indices.size();
-        sm.index_count  = (GLuint)indexes.size();
+uint32_t& Models::Model::lod_level_of(uint32_t view_id) {
+    if (view_lod_levels.size() <= view_id)
+        view_lod_levels.resize(view_id + 1, 0);
+    return view_lod_levels[view_id];
+}
 
-        all_indices.insert(all_indices.end(), indexes.begin(), indexes.end());
-        submeshes.push_back(sm);
+uint32_t Models::Model::select_lod(const glm::mat4& view, const glm::mat4& projection,
+                                   uint32_t& current, InstanceSpan instances) const {
+    if (!lod_settings.enabled || lod_errors.empty()) {
+        current = 0;
+        return current;
     }
+    const float extent    = projected_extent(view, projection, instances);
+    const float threshold = lod_settings.max_screen_error;
+    auto        error     = [&](uint32_t lod) {
+        return lod == 0 ? 0.0f : lod_errors[lod - 1] * extent;
+    };
 
-    // storage for accumulating each shared vertex's contributions
-    std::vector<glm::vec3> tan1(unique_vertices.size(), glm::vec3(0.0f));
-    std::vector<glm::vec3> tan2(unique_vertices.size(), glm::vec3(0.0f));
-    
-    for (size_t i = 0; i + 2 < all_indices.size(); i += 3) {
-        GLuint i0 = all_indices[i+0];
-        GLuint i1 = all_indices[i+1];
-        GLuint i2 = all_indices[i+2];
-    
-        auto& v0 = unique_vertices[i0];
-        auto& v1 = unique_vertices[i1];
-        auto& v2 = unique_vertices[i2];
-    
-        auto [T, B] = calculate_tangent_bitangent(v0, v1, v2);
-    
-        tan1[i0] += T;  tan1[i1] += T;  tan1[i2] += T;
-        tan2[i0] += B;  tan2[i1] += B;  tan2[i2] += B;
-    }
+    // the coarsest level that is good enough
+    uint32_t lod = static_cast<uint32_t>(lod_errors.size());
+    while (lod > 0 && !(error(lod) <= threshold))
+        --lod;
+    // going coarser needs the margin, going finer happens right away
+    const uint32_t last = std::min<uint32_t>(current, static_cast<uint32_t>(lod_errors.size()));
+    while (lod > last && !(error(lod) <= threshold * (1.0f - lod_settings.hysteresis)))
+        --lod;
+    current = lod;
+    return current;
+}
 
-    for(int i = 0; i < unique_vertices.size(); i++){
-        orthogonalize_and_normalize_tb(unique_vertices[i], tan1, tan2, i);
-    }
+Models::Model::Model(Model&& other) noexcept {
+    *this = std::move(other);
+}
 
-    // create & upload VAO/VBO/EBO
-    GLCall(glGenVertexArrays(1, &vao));
-    GLCall(glGenBuffers(1, &vbo));
-    GLCall(glGenBuffers(1, &ebo));
-
-    GLCall(glBindVertexArray(vao));
-
-    // VBO
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, vbo));
-    GLCall(glBufferData(GL_ARRAY_BUFFER, unique_vertices.size() * sizeof(Vertex),
-                        unique_vertices.data(), GL_STATIC_DRAW));
-
-    // EBO
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo));
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, all_indices.size() * sizeof(GLuint),
-                        all_indices.data(), GL_STATIC_DRAW));
-
-    // attributes (pos, tex, norm) …
-    GLCall(glEnableVertexAttribArray(0));
-    GLCall(glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                                 (void*)offsetof(Vertex, position)));
-    GLCall(glEnableVertexAttribArray(1));
-    GLCall(glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                                 (void*)offsetof(Vertex, texcoord)));
-    GLCall(glEnableVertexAttribArray(2));
-    GLCall(glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                                 (void*)offsetof(Vertex, normal)));
-    GLCall(glEnableVertexAttribArray(3));
-    GLCall(glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                             (void*)offsetof(Vertex, tangent)));
-
-    GLCall(glBindVertexArray(0));
-
-    // compute local AABB
-    for (auto const& v : unique_vertices) {
-        localaabbmin = glm::min(localaabbmin, v.position);
-        localaabbmax = glm::max(localaabbmax, v.position);
+Models::Model& Models::Model::operator=(Model&& other) noexcept {
+    if (this == &other)
+        return *this;
+    release_instancing();
+
+    unique_vertices       = std::move(other.unique_vertices);
+    submeshes             = std::move(other.submeshes);
+    label_                = std::move(other.label_);
+    local_transform       = other.local_transform;
+    world_transform       = other.world_transform;
+    transform_dirty       = other.transform_dirty;
+    parent_world          = other.parent_world;
+    instance_suffixes     = std::move(other.instance_suffixes);
+    instance_transforms   = std::move(other.instance_transforms);
+    instance_attributes   = std::move(other.instance_attributes);
+    instance_aabb_min     = std::move(other.instance_aabb_min);
+    instance_aabb_max     = std::move(other.instance_aabb_max);
+    instance_slot_of      = std::move(other.instance_slot_of);
+    instance_slots        = std::move(other.instance_slots);
+    free_instance_slots   = std::move(other.free_instance_slots);
+    instance_by_suffix    = std::move(other.instance_by_suffix);
+    instance_version      = other.instance_version;
+    view_instances        = std::move(other.view_instances);
+    instance_scratch      = std::move(other.instance_scratch);
+    instance_attrib_first = other.instance_attrib_first;
+    instance_buffer       = other.instance_buffer;
+    lod_errors            = std::move(other.lod_errors);
+    view_lod_levels       = std::move(other.view_lod_levels);
+    cluster_counts        = std::move(other.cluster_counts);
+    cluster_offsets       = std::move(other.cluster_offsets);
+    cluster_base_vertices = std::move(other.cluster_base_vertices);
+    cluster_views         = std::move(other.cluster_views);
+    packed_bounds         = other.packed_bounds;
+    // the VAO goes with the instancing state, other must not delete it
+    is_instanced_         = std::exchange(other.is_instanced_, false);
+    vao                   = std::exchange(other.vao, 0);
+    arena_range           = std::move(other.arena_range);
+    vertex_format         = other.vertex_format;
+    texture_id            = other.texture_id;
+    localaabbmin          = other.localaabbmin;
+    localaabbmax          = other.localaabbmax;
+    aabbmin               = other.aabbmin;
+    aabbmax               = other.aabbmax;
+    interactable          = other.interactable;
+    flags                 = other.flags;
+    material_variants     = std::move(other.material_variants);
+    variants_version      = other.variants_version;
+    active                = other.active;
+    children              = std::move(other.children);
+    return *this;
+}
+
+void Models::Model::release_instancing() {
+    // only instanced models have a VAO of their own, the rest use the arena's
+    if (is_instanced_ && vao) {
+        if (bound_vertex_array() == vao)
+            bind_vertex_array(0);
+        GLCall(glDeleteVertexArrays(1, &vao));
     }
+    vao           = 0;
+    is_instanced_ = false;
 }
 
 Models::Model::~Model() {
     // Tear down instancing first (reverse of creation)
-    if (instance_vbo) {
-        GLCall(glDeleteBuffers(1, &instance_vbo));
-        instance_vbo = 0;
-    }
-    is_instanced_ = false;
+    release_instancing();
 
     // Clear all CPU‐side instance arrays
     instance_suffixes.clear();
     instance_transforms.clear();
+    instance_attributes.clear();
     instance_aabb_min.clear();
     instance_aabb_max.clear();
-    instance_modifications.clear();
-
-    // Then tear down your regular VAO/VBO/EBO in reverse creation order
-    if (ebo) {
-        GLCall(glDeleteBuffers(1, &ebo));
-        ebo = 0;
-    }
-    if (vbo) {
-        GLCall(glDeleteBuffers(1, &vbo));
-        vbo = 0;
-    }
-    if (vao) {
-        GLCall(glDeleteVertexArrays(1, &vao));
-        vao = 0;
-    }
-}
-
-void Models::Model::orthogonalize_and_normalize_tb(
-    Models::Vertex& vertex,
-    const std::vector<glm::vec3>& accumulated_tangent, 
-    const std::vector<glm::vec3>& accumulated_bitangent,
-    const size_t index
-) {
-    const glm::vec3& normal    = vertex.normal;
-    const glm::vec3& tangent   = accumulated_tangent[index];
-    const glm::vec3& bitangent = accumulated_bitangent[index];
-
-    //
-    // Gram–Schmidt orthogonalize the tangent against the normal
-    glm::vec3 orth_tangent = glm::normalize(
-        tangent - normal * glm::dot(normal, tangent)
-    );
-
-    // Compute handedness (±1) so we can reconstruct the bi‐tangent in‐shader if desired
-    float handedness = (glm::dot(glm::cross(normal, orth_tangent), bitangent) < 0.0f)
-                       ? -1.0f
-                       : 1.0f;
-
-    // Store the results back into the vertex
-    vertex.tangent   = glm::vec4(orth_tangent, handedness);
-}
-
-std::pair<glm::vec3, glm::vec3> Models::Model::calculate_tangent_bitangent(
-    Models::Vertex v0, 
-    Models::Vertex v1, 
-    Models::Vertex v2
-){
-
-    glm::vec3 edge1 = v1.position - v0.position;
-    glm::vec3 edge2 = v2.position - v0.position;
-    glm::vec2 uv0   = v0.texcoord;
-    glm::vec2 uv1   = v1.texcoord;
-    glm::vec2 uv2   = v2.texcoord;
-
-    glm::vec2 delta_uv1 = uv1 - uv0;
-    glm::vec2 delta_uv2 = uv2 - uv0;
-    // Compute the inverse of the determinant of the UV matrix (Δ)
-    // This is equivalent to: Δ = 1 / (s1 * t2 - s2 * t1)
-    float r = 1.0f / (delta_uv1.x * delta_uv2.y  - delta_uv2.x * delta_uv1.y);
-
-    // Compute the tangent direction vector (T)
-    // This solves: T = (t2 * Q1 - t1 * Q2) / Δ
-    glm::vec3 tangent = {0.0f, 0.0f, 0.0f};
-    // Compute the bitangent direction vector (B)
-    // This solves: B = (-s2 * Q1 + s1 * Q2) / Δ
-    glm::vec3 bitangent = {0.0f, 0.0f, 0.0f};
-
-    tangent.x = r * (delta_uv2.y * edge1.x - delta_uv1.y * edge2.x);
-    tangent.y = r * (delta_uv2.y * edge1.y- delta_uv1.y * edge2.y);
-    tangent.z = r * (delta_uv2.y * edge1.z - delta_uv1.y * edge2.z);
-    bitangent.x = r * (-delta_uv2.x * edge1.x + delta_uv1.x * edge2.x);
-    bitangent.y = r * (-delta_uv2.x * edge1.y + delta_uv1.x * edge2.y);
-    bitangent.z = r * (-delta_uv2.x * edge1.z + delta_uv1.x * edge2.z);
-
-    return {tangent, bitangent};
+    // the vertex and index ranges go back to the arena with arena_range
 }
 
 void Models::Model::add_child(Model* child) {
@@ -388,12 +329,18 @@ void Models::Model::add_child(Model* child) {
 
 void Models::Model::set_local_transform(const glm::mat4& local_transform) {
     this->local_transform = local_transform;
+    transform_dirty       = true;
 }
 
 void Models::Model::update_world_transform(const glm::mat4& parent_transform) {
-    world_transform = parent_transform * local_transform;
-
-    compute_aabb();
+    if (transform_dirty || parent_transform != parent_world) {
+        world_transform = parent_transform * local_transform;
+        parent_world    = parent_transform;
+        transform_dirty = false;
+        compute_aabb();
+        ++frame_counts.transforms;
+    }
+    // children may have moved on their own
     for (Model* child : children) {
         child->update_world_transform(world_transform);
     }
@@ -401,18 +348,26 @@ void Models::Model::update_world_transform(const glm::mat4& parent_transform) {
 //I could remove this from the public API
 //and have it be an impl detail, as both draws are called with the same params
 void Models::Model::draw_instanced(const glm::mat4& view, const glm::mat4& projection,
-                                   std::shared_ptr<Shader> shader){
-
-    //CARE WITH THIS IS MIGHT CAUSE A BUG
-    //if(instance_data_dirty) update_instance_data();
-    update_instance_data();
-
+                                   std::shared_ptr<Shader> shader, InstanceSpan visible,
+                                   uint32_t view_id) {
+    const InstanceRange& instances = stream_instances(view_id, visible);
+    if (instances.count == 0)
+        return;
 
     shader->set_mat4("uView", view);
     shader->set_mat4("uProj", projection);
     shader->set_bool("uUseInstancing", true);
+    set_unpack_uniforms(*shader, true);
+    // the models sharing the program only upload their table when it is not the one there
+    const auto variant_count = static_cast<GLsizei>(material_variants.size());
+    if (shader->set_vec4_array("materialVariants", material_variants.data(), variant_count,
+                               variants_version)) {
+        shader->set_int("materialVariantCount", variant_count);
+    }
+    const uint32_t lod = select_lod(view, projection, lod_level_of(view_id), visible);
+    make_instance_cluster_views(view, projection, visible, false);
 
-    GLCall(glBindVertexArray(vao));
+    frame_counts.vao_binds += bind_vertex_array(vao);
     for (auto const& sm : submeshes) {
         shader->set_vec3("material.ambient", sm.mat.Ka);
         shader->set_vec3("material.diffuse", sm.mat.Kd);
@@ -422,45 +377,45 @@ void Models::Model::draw_instanced(const glm::mat4& view, const glm::mat4& proje
         shader->set_float("material.opacity", sm.mat.d);
         shader->set_int("material.illumModel", sm.mat.illum);
         shader->set_float("material.ior", sm.mat.Ni);
-        shader->set_bool("material.useBumpMap", sm.mat.use_bump_map);
+        // textures that are still waiting in the upload queue are treated as missing
+        GLuint bump_id = gl_id(sm.mat.tex_Bump);
+        shader->set_bool("material.useBumpMap", sm.mat.use_bump_map && bump_id);
 
-        if (sm.mat.tex_Ka) {
-            shader->set_texture("ambientMap", sm.mat.tex_Ka, GL_TEXTURE1);
+        if (GLuint id = gl_id(sm.mat.tex_Ka)) {
+            shader->set_texture("ambientMap", id, GL_TEXTURE1);
             shader->set_bool("useAmbientMap", true);
         } else {
             shader->set_bool("useAmbientMap", false);
         }
 
-        if (sm.mat.tex_Kd) {
-            shader->set_texture("diffuseMap", sm.mat.tex_Kd, GL_TEXTURE2);
+        if (GLuint id = gl_id(sm.mat.tex_Kd)) {
+            shader->set_texture("diffuseMap", id, GL_TEXTURE2);
             shader->set_bool("useDiffuseMap", true);
         } else {
             shader->set_bool("useDiffuseMap", false);
         }
 
-        if (sm.mat.tex_Ks) {
-            shader->set_texture("specularMap", sm.mat.tex_Ks, GL_TEXTURE3);
+        if (GLuint id = gl_id(sm.mat.tex_Ks)) {
+            shader->set_texture("specularMap", id, GL_TEXTURE3);
             shader->set_bool("useSpecularMap", true);
         } else {
             shader->set_bool("useSpecularMap", false);
         }
 
-        if(sm.mat.tex_Bump) {
-           shader->set_texture("bumpMap", sm.mat.tex_Bump, GL_TEXTURE4);
+        if(bump_id) {
+           shader->set_texture("bumpMap", bump_id, GL_TEXTURE4);
            shader->set_float("bumpScale", 4.0f);
         } 
 
-        void* offsetPtr = (void*)(sm.index_offset * sizeof(GLuint));
-        GLCall(glDrawElementsInstanced(GL_TRIANGLES, sm.index_count, GL_UNSIGNED_INT, offsetPtr,
-                                       instance_transforms.size()));
+        frame_counts.triangles += draw_submesh_instanced(sm, lod, instances);
     }
-    GLCall(glBindVertexArray(0));
 }
 
 void Models::Model::draw(const glm::mat4& view, const glm::mat4& projection,
-                         std::shared_ptr<Shader> shader){
+                         std::shared_ptr<Shader> shader, InstanceSpan instances,
+                         uint32_t view_id) {
     if(is_instanced_) {
-        draw_instanced(view,projection,shader);
+        draw_instanced(view, projection, shader, instances, view_id);
         return;
     }
 
@@ -469,8 +424,12 @@ void Models::Model::draw(const glm::mat4& view, const glm::mat4& projection,
     shader->set_mat4("uProj", projection);
     shader->set_mat4("uModel", world_transform);
     shader->set_bool("uUseInstancing", false);
+    shader->set_int("uFlags", static_cast<int>(flags));
+    set_unpack_uniforms(*shader, true);
+    const uint32_t    lod      = select_lod(view, projection, lod_level_of(view_id));
+    const ClusterView clusters = make_cluster_view(view * world_transform, projection, false);
 
-    GLCall(glBindVertexArray(vao));
+    frame_counts.vao_binds += bind_vertex_array(vao);
     for (auto const& sm : submeshes) {
         shader->set_vec3("material.ambient", sm.mat.Ka);
         shader->set_vec3("material.diffuse", sm.mat.Kd);
@@ -480,41 +439,122 @@ void Models::Model::draw(const glm::mat4& view, const glm::mat4& projection,
         shader->set_float("material.opacity", sm.mat.d);
         shader->set_int("material.illumModel", sm.mat.illum);
         shader->set_float("material.ior", sm.mat.Ni);
-        shader->set_bool("material.useBumpMap", sm.mat.use_bump_map);
+        // textures that are still waiting in the upload queue are treated as missing
+        GLuint bump_id = gl_id(sm.mat.tex_Bump);
+        shader->set_bool("material.useBumpMap", sm.mat.use_bump_map && bump_id);
 
-        if (sm.mat.tex_Ka) {
-            shader->set_texture("ambientMap", sm.mat.tex_Ka, GL_TEXTURE1);
+        if (GLuint id = gl_id(sm.mat.tex_Ka)) {
+            shader->set_texture("ambientMap", id, GL_TEXTURE1);
             shader->set_bool("useAmbientMap", true);
         } else {
             shader->set_bool("useAmbientMap", false);
         }
 
-        if (sm.mat.tex_Kd) {
-            shader->set_texture("diffuseMap", sm.mat.tex_Kd, GL_TEXTURE2);
+        if (GLuint id = gl_id(sm.mat.tex_Kd)) {
+            shader->set_texture("diffuseMap", id, GL_TEXTURE2);
             shader->set_bool("useDiffuseMap", true);
         } else {
             shader->set_bool("useDiffuseMap", false);
         }
 
-        if (sm.mat.tex_Ks) {
-            shader->set_texture("specularMap", sm.mat.tex_Ks, GL_TEXTURE3);
+        if (GLuint id = gl_id(sm.mat.tex_Ks)) {
+            shader->set_texture("specularMap", id, GL_TEXTURE3);
             shader->set_bool("useSpecularMap", true);
         } else {
             shader->set_bool("useSpecularMap", false);
         }
 
-        if(sm.mat.tex_Bump) {
-           shader->set_texture("bumpMap", sm.mat.tex_Bump, GL_TEXTURE4);
+        if(bump_id) {
+           shader->set_texture("bumpMap", bump_id, GL_TEXTURE4);
            shader->set_float("bumpScale", 4.0f);
         } 
 
-        void* offsetPtr = (void*)(sm.index_offset * sizeof(GLuint));
-        GLCall(glDrawElements(GL_TRIANGLES, sm.index_count, GL_UNSIGNED_INT, offsetPtr));
+        frame_counts.triangles += draw_submesh(sm, lod, clusters);
+    }
+}
+
+size_t Models::Model::draw_submesh(const SubMesh& sm, uint32_t lod, const ClusterView& view) {
+    const size_t base_index = arena_range.index_byte_offset();
+    if (lod != 0 || !cull_clusters || sm.clusters.size() < 2) {
+        const LodRange range = lod_range(sm, lod);
+        GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, range.index_count, index_type(sm),
+                                        index_offset(sm, range, base_index),
+                                        arena_range.base_vertex()));
+        return range.index_count / 3;
+    }
+
+    cluster_counts.clear();
+    cluster_offsets.clear();
+    cluster_base_vertices.clear();
+    size_t   triangles = 0;
+    uint32_t end       = sm.index_offset;
+    for (const auto& cluster : sm.clusters) {
+        if (!cluster_visible(cluster, view))
+            continue;
+        if (!cluster_counts.empty() && cluster.index_offset == end) {
+            cluster_counts.back() += cluster.index_count;
+        } else {
+            cluster_counts.push_back(cluster.index_count);
+            cluster_offsets.push_back(index_offset(sm, {cluster.index_offset, 0}, base_index));
+            cluster_base_vertices.push_back(arena_range.base_vertex());
+        }
+        end = cluster.index_offset + cluster.index_count;
+        triangles += cluster.index_count / 3;
+    }
+    if (!cluster_counts.empty()) {
+        GLCall(glMultiDrawElementsBaseVertex(GL_TRIANGLES, cluster_counts.data(), index_type(sm),
+                                             cluster_offsets.data(),
+                                             static_cast<GLsizei>(cluster_counts.size()),
+                                             cluster_base_vertices.data()));
+    }
+    return triangles;
+}
+
+void Models::Model::make_instance_cluster_views(const glm::mat4& view,
+                                                const glm::mat4& projection, InstanceSpan visible,
+                                                bool cull_front_faces) {
+    cluster_views.clear();
+    if (!cull_clusters || visible.count > max_cluster_cull_instances)
+        return;
+    for (uint32_t i : visible)
+        cluster_views.push_back(
+            make_cluster_view(view * instance_transforms[i], projection, cull_front_faces));
+}
+
+size_t Models::Model::draw_submesh_instanced(const SubMesh& sm, uint32_t lod,
+                                             const InstanceRange& instances) {
+    if (lod != 0 || cluster_views.empty() || sm.clusters.size() < 2) {
+        const LodRange range = lod_range(sm, lod);
+        draw_instances(sm, range, instances);
+        return range.index_count / 3 * size_t(instances.count);
+    }
+
+    // a cluster is drawn for every instance once any of them sees it
+    size_t   triangles = 0;
+    LodRange run{sm.index_offset, 0};
+    for (const auto& cluster : sm.clusters) {
+        const bool seen = std::any_of(cluster_views.begin(), cluster_views.end(),
+                                      [&](const ClusterView& v) {
+                                          return cluster_visible(cluster, v);
+                                      });
+        if (!seen)
+            continue;
+        if (run.index_count != 0 && cluster.index_offset != run.index_offset + run.index_count) {
+            draw_instances(sm, run, instances);
+            run.index_count = 0;
+        }
+        if (run.index_count == 0)
+            run.index_offset = cluster.index_offset;
+        run.index_count += cluster.index_count;
+        triangles += cluster.index_count / 3 * size_t(instances.count);
     }
-    GLCall(glBindVertexArray(0));
+    if (run.index_count != 0)
+        draw_instances(sm, run, instances);
+    return triangles;
 }
 
-void Models::Model::draw_depth(std::shared_ptr<Shader> shader){
+void Models::Model::draw_depth(std::shared_ptr<Shader> shader, const glm::mat4& view,
+                               const glm::mat4& projection, uint32_t view_id) {
 
     // GLCall(glEnable(GL_CULL_FACE));
     // GLCall(glCullFace(GL_FRONT));
@@ -522,82 +562,61 @@ void Models::Model::draw_depth(std::shared_ptr<Shader> shader){
 
     shader->set_mat4("uModel", world_transform);
     shader->set_bool("uUseInstancing", false);
-    GLCall(glBindVertexArray(vao));
-    for (auto const& sm : submeshes) {
-        void* offset_ptr = (void*)(sm.index_offset * sizeof(GLuint));
-        GLCall(glDrawElements(GL_TRIANGLES, sm.index_count, GL_UNSIGNED_INT, offset_ptr));
-    }
+    set_unpack_uniforms(*shader, false);
+    const uint32_t lod = select_lod(view, projection, lod_level_of(view_id));
+    // the shadow passes cull front faces
+    const ClusterView clusters = make_cluster_view(view * world_transform, projection, true);
+    frame_counts.vao_binds += bind_vertex_array(vao);
+    for (auto const& sm : submeshes)
+        frame_counts.shadow_triangles += draw_submesh(sm, lod, clusters);
     // GLCall(glCullFace(GL_BACK));
     // GLCall(glColorMask(GL_TRUE,  GL_TRUE,  GL_TRUE,  GL_TRUE));
-    GLCall(glBindVertexArray(0));
 }
 
-void Models::Model::draw_depth_instanced(std::shared_ptr<Shader> shader){
-    //if(instance_data_dirty) update_instance_data();
-    update_instance_data();
+void Models::Model::draw_depth_instanced(std::shared_ptr<Shader> shader, const glm::mat4& view,
+                                         const glm::mat4& projection, InstanceSpan visible,
+                                         uint32_t view_id) {
+    const InstanceRange& instances = stream_instances(view_id, visible);
+    if (instances.count == 0)
+        return;
+
     shader->set_bool("uUseInstancing", true);
     shader->set_mat4("uModel", world_transform);
-
-    GLCall(glBindVertexArray(vao));
-
-    for (auto const& sm : submeshes) {
-        void* offset_ptr = (void*)(sm.index_offset * sizeof(GLuint));
-        GLCall(glDrawElementsInstanced(GL_TRIANGLES, sm.index_count, GL_UNSIGNED_INT, offset_ptr,
-                                       static_cast<GLsizei>(instance_transforms.size())));
-    }
-    GLCall(glBindVertexArray(0));
+    set_unpack_uniforms(*shader, false);
+    const uint32_t lod = select_lod(view, projection, lod_level_of(view_id), visible);
+    // the shadow passes cull front faces
+    make_instance_cluster_views(view, projection, visible, true);
+
+    frame_counts.vao_binds += bind_vertex_array(vao);
+    for (auto const& sm : submeshes)
+        frame_counts.shadow_triangles += draw_submesh_instanced(sm, lod, instances);
 }
 
 void Models::Model::compute_aabb() {
-    // 1) Initialize to extreme opposites
-    glm::vec3 world_min(FLT_MAX);
-    glm::vec3 world_max(-FLT_MAX);
-
-    // 2) Transform each unique-vertex into world space and accumulate
-    for (auto const& v : unique_vertices) {
-        glm::vec4 wc = world_transform * glm::vec4(v.position, 1.0f);
-        glm::vec3 w  = glm::vec3(wc);
-        world_min    = glm::min(world_min, w);
-        world_max    = glm::max(world_max, w);
-    }
-
-    // 3) If truly planar (min == max in Y), pad by a tiny ε so your sphere
-    //    test doesn’t see it as a zero-thickness plane.
-    const float eps = 0.001f;
-    if (glm::epsilonEqual(world_min.y, world_max.y, glm::epsilon<float>())) {
-        world_min.y -= eps;
-        world_max.y += eps;
-    }
-
-    // 4) Store
-    aabbmin = world_min;
-    aabbmax = world_max;
+    compute_transformed_aabb(world_transform, aabbmin, aabbmax);
 }
 
 void Models::Model::compute_transformed_aabb(
                                      const glm::mat4& xf, glm::vec3& out_min, glm::vec3& out_max) {
-    // all 8 corners of the local box
-    glm::vec3 corners[8] = {
-            {localaabbmin.x, localaabbmin.y, localaabbmin.z},
-            {localaabbmin.x, localaabbmin.y, localaabbmax.z},
-            {localaabbmin.x, localaabbmax.y, localaabbmin.z},
-            {localaabbmin.x, localaabbmax.y, localaabbmax.z},
-
-            {localaabbmax.x, localaabbmin.y, localaabbmin.z},
-            {localaabbmax.x, localaabbmin.y, localaabbmax.z},
-            {localaabbmax.x, localaabbmax.y, localaabbmin.z},
-            {localaabbmax.x, localaabbmax.y, localaabbmax.z},
-    };
-
-    out_min = glm::vec3(FLT_MAX);
-    out_max = glm::vec3(-FLT_MAX);
+    if (localaabbmin.x > localaabbmax.x) {
+        // no vertices
+        out_min = glm::vec3(FLT_MAX);
+        out_max = glm::vec3(-FLT_MAX);
+        return;
+    }
 
-    for (auto& c : corners) {
-        glm::vec3 w = glm::vec3(xf * glm::vec4(c, 1.0f));
-        out_min = glm::min(out_min, w);
-        out_max = glm::max(out_max, w);
+    // Arvo: the box of the 8 transformed corners without transforming them, every column of
+    // xf moves each world axis by the smaller/larger of its products with the local extent
+    out_min = out_max = glm::vec3(xf[3]);
+    for (int axis = 0; axis < 3; ++axis) {
+        const glm::vec3 a = glm::vec3(xf[axis]) * localaabbmin[axis];
+        const glm::vec3 b = glm::vec3(xf[axis]) * localaabbmax[axis];
+        out_min += glm::min(a, b);
+        out_max += glm::max(a, b);
     }
 
+    // If truly planar (min == max in Y), pad by a tiny ε so the sphere
+    // test doesn’t see it as a zero-thickness plane.
     const float eps = 0.001f;
     if (glm::epsilonEqual(out_min.y, out_max.y, glm::epsilon<float>())) {
         out_min.y -= eps;
@@ -606,74 +625,98 @@ void Models::Model::compute_transformed_aabb(
 }
 
 void Models::Model::init_instancing(size_t max_instances) {
-    // Generate the instance‐buffer
-    GLCall(glGenBuffers(1, &instance_vbo));
-    GLCall(glBindVertexArray(vao));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, instance_vbo));
-    // allocate enough space for max_instances matrices
-    GLCall(
-        glBufferData(GL_ARRAY_BUFFER, max_instances * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW));
-
-    // Set up the four vec4 attributes (one per column of the mat4)
-    constexpr GLuint loc = 4; // choose free attribute locations
-    for (int i = 0; i < 4; ++i) {
-        GLuint attrib = loc + i;
-        GLCall(glEnableVertexAttribArray(attrib));
-        GLCall(glVertexAttribPointer(attrib, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
-                                     (void*)(sizeof(glm::vec4) * i)));
-        // tell GL this is per-instance, not per-vertex:
-        GLCall(glVertexAttribDivisor(attrib, 1));
-    }
+    // the instance attributes need a VAO of their own, over the same arena buffers
+    GLCall(glGenVertexArrays(1, &vao));
+    bind_vertex_array(vao);
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, arena_range.vbo()));
+    set_vertex_attributes(vertex_format);
+    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena_range.ebo()));
+    // the transforms are streamed per view, see stream_instances()
+    instance_buffer = InstanceStream::shared().buffer();
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, instance_buffer));
+    instance_attrib_first = 0;
+
+    bind_instance_attributes(0);
     is_instanced_ = true;
     instance_suffixes.reserve(max_instances);
     instance_transforms.reserve(max_instances);
+    instance_attributes.reserve(max_instances);
     instance_aabb_min.reserve(max_instances);
     instance_aabb_max.reserve(max_instances);
-    instance_modifications.reserve(max_instances);
-    instance_in_frustum.reserve(max_instances);
-    GLCall(glBindVertexArray(0));
+    instance_slot_of.reserve(max_instances);
+    instance_slots.reserve(max_instances);
+    instance_by_suffix.reserve(max_instances);
 }
 
-//void Models::Model::update_instance_data() const {
-//    // Map & write only the portion we need (could also use glBufferSubData)
-//    GLCall(glBindBuffer(GL_ARRAY_BUFFER, instance_vbo));
-//    void* ptr = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-//    memcpy(ptr, instance_transforms.data(), instance_transforms.size() * sizeof(glm::mat4));
-//    GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
-//}
-
-void Models::Model::update_instance_data(){
-    // build a temporary list of only the active transforms
-    std::vector<glm::mat4> active;
-    active.reserve(instance_transforms.size());
-    for (size_t i = 0; i < instance_transforms.size(); ++i) {
-
-        if(instance_modifications[i] == InstanceModifiedTypes::REMOVED){
-            continue;
-        }
-
-        if(!instance_in_frustum[i]){
-            continue;
-        }
-
-        active.push_back(instance_transforms[i]);
+const Models::InstanceRange& Models::Model::stream_instances(uint32_t     view_id,
+                                                           InstanceSpan instances) {
+    if (view_instances.size() <= view_id)
+        view_instances.resize(view_id + 1);
+    InstanceList& list = view_instances[view_id];
+
+    auto& stream = InstanceStream::shared();
+    if (list.version != instance_version || list.slots.size() != instances.count ||
+        !std::equal(instances.begin(), instances.end(), list.slots.begin()) ||
+        !stream.valid(list.range)) {
+        instance_scratch.clear();
+        for (uint32_t i : instances)
+            instance_scratch.push_back({instance_transforms[i], instance_attributes[i]});
+        list.range =
+            stream.write(instance_scratch.data(), static_cast<uint32_t>(instance_scratch.size()));
+        list.version = instance_version;
+        list.slots.assign(instances.begin(), instances.end());
+        frame_counts.instance_bytes += instance_scratch.size() * sizeof(InstanceData);
     }
+    stream.use(list.range);
+    return list.range;
+}
 
-    // upload only the active list
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, instance_vbo));
-    GLCall(glBufferData(
-      GL_ARRAY_BUFFER,
-      active.size() * sizeof(glm::mat4),
-      active.data(),
-      GL_STREAM_DRAW));
-    // GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
-    // remember how many instances we’ll actually draw
-    gl_instance_count = (GLuint)active.size();
-    instance_data_dirty = false;
+void Models::Model::draw_instances(const SubMesh& sm, const LodRange& range,
+                                   const InstanceRange& instances) {
+    void*          indices = index_offset(sm, range, arena_range.index_byte_offset());
+    const GLuint   buffer  = InstanceStream::shared().buffer();
+    const uint32_t first   = GLEW_ARB_base_instance ? 0 : instances.first;
+    if (instance_attrib_first != first || instance_buffer != buffer) {
+        // 3.3 has no base instance, the attributes start at the range instead. The stream can
+        // also have moved to a new buffer.
+        GLCall(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+        bind_instance_attributes(first);
+        instance_attrib_first = first;
+        instance_buffer       = buffer;
+    }
+    if (GLEW_ARB_base_instance) {
+        GLCall(glDrawElementsInstancedBaseVertexBaseInstance(
+            GL_TRIANGLES, range.index_count, index_type(sm), indices,
+            static_cast<GLsizei>(instances.count), arena_range.base_vertex(), instances.first));
+        return;
+    }
+    GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.index_count, index_type(sm),
+                                             indices, static_cast<GLsizei>(instances.count),
+                                             arena_range.base_vertex()));
 }
 
-void Models::Model::add_instance_transform(const glm::mat4& xf, const std::string& suffix){
+Models::InstanceHandle
+Models::Model::add_instance_transform(const glm::mat4& xf, const std::string& suffix,
+                                      const InstanceAttributes& attributes) {
+    // names are how handlers and remove_instance_transform() find an instance, they are unique
+    if (instance_by_suffix.count(suffix)) {
+        throw std::runtime_error("Instance suffix already used by " + label_ + ": " + suffix);
+    }
+    uint32_t slot;
+    if (!free_instance_slots.empty()) {
+        slot = free_instance_slots.back();
+        free_instance_slots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(instance_slots.size());
+        instance_slots.push_back({0, 0});
+    }
+    InstanceSlot& entry = instance_slots[slot];
+    entry.index         = static_cast<uint32_t>(instance_transforms.size());
+    entry.generation += 1;
+    const InstanceHandle handle{slot, entry.generation};
+
     instance_transforms.push_back(xf);
+    instance_attributes.push_back(attributes);
 
     glm::vec3 wmin, wmax;
     compute_transformed_aabb(xf, wmin, wmax);
@@ -681,9 +724,87 @@ void Models::Model::add_instance_transform(const glm::mat4& xf, const std::strin
     instance_aabb_min.push_back(wmin);
     instance_aabb_max.push_back(wmax);
     instance_suffixes.push_back(suffix);
-    instance_modifications.push_back(InstanceModifiedTypes::NOT_MODIFIED);
-    instance_in_frustum.push_back(true);
-    instance_data_dirty = true;
+    instance_slot_of.push_back(slot);
+    instance_by_suffix.emplace(suffix, handle);
+    ++instance_version;
+    return handle;
+}
+
+bool Models::Model::remove_instance(InstanceHandle handle) {
+    const int found = instance_index(handle);
+    if (found < 0)
+        return false;
+
+    // the last instance moves into the hole, its handle follows it
+    const uint32_t index = static_cast<uint32_t>(found);
+    const uint32_t last  = static_cast<uint32_t>(instance_transforms.size() - 1);
+    auto it = instance_by_suffix.find(instance_suffixes[index]);
+    if (it != instance_by_suffix.end() && it->second.slot == handle.slot)
+        instance_by_suffix.erase(it);
+    if (index != last) {
+        instance_transforms[index] = instance_transforms[last];
+        instance_attributes[index] = instance_attributes[last];
+        instance_aabb_min[index]   = instance_aabb_min[last];
+        instance_aabb_max[index]   = instance_aabb_max[last];
+        instance_suffixes[index].swap(instance_suffixes[last]);
+        instance_slot_of[index]                 = instance_slot_of[last];
+        instance_slots[instance_slot_of[index]].index = index;
+    }
+    instance_transforms.pop_back();
+    instance_attributes.pop_back();
+    instance_aabb_min.pop_back();
+    instance_aabb_max.pop_back();
+    instance_suffixes.pop_back();
+    instance_slot_of.pop_back();
+
+    // handles to the slot stop resolving here, the generation moves on when it is reused
+    instance_slots[handle.slot].generation += 1;
+    free_instance_slots.push_back(handle.slot);
+    ++instance_version;
+    return true;
+}
+
+bool Models::Model::set_instance_transform(InstanceHandle handle, const glm::mat4& xf) {
+    const int index = instance_index(handle);
+    if (index < 0)
+        return false;
+    instance_transforms[index] = xf;
+    compute_transformed_aabb(xf, instance_aabb_min[index], instance_aabb_max[index]);
+    ++instance_version;
+    return true;
+}
+
+bool Models::Model::set_instance_attributes(InstanceHandle            handle,
+                                            const InstanceAttributes& attributes) {
+    const int index = instance_index(handle);
+    if (index < 0)
+        return false;
+    instance_attributes[index] = attributes;
+    ++instance_version;
+    return true;
+}
+
+void Models::Model::set_material_variants(const std::vector<glm::vec4>& variants) {
+    if (variants.size() > max_material_variants) {
+        throw std::runtime_error("Too many material variants for " + label_ + ": " +
+                                 std::to_string(variants.size()));
+    }
+    material_variants = variants;
+    variants_version  = variants.empty() ? 1 : next_variants_version++;
+}
+
+void Models::Model::set_instance_transforms(const std::vector<glm::mat4>& transforms) {
+    const size_t count = std::min(transforms.size(), instance_transforms.size());
+    for (size_t i = 0; i < count; ++i) {
+        instance_transforms[i] = transforms[i];
+        compute_transformed_aabb(transforms[i], instance_aabb_min[i], instance_aabb_max[i]);
+    }
+    ++instance_version;
+}
+
+Models::InstanceHandle Models::Model::find_instance(const std::string& suffix) const {
+    auto it = instance_by_suffix.find(suffix);
+    return it == instance_by_suffix.end() ? InstanceHandle{} : it->second;
 }
 
 std::pair<float,int> Models::Model::distance_from_point_using_AABB(const glm::vec3& point)
@@ -703,8 +824,6 @@ std::pair<float,int> Models::Model::distance_from_point_using_AABB(const glm::ve
     int best_idx = -1;
 
     for (int i = 0; i < get_instance_count(); ++i) {
-        if (instance_modifications[i] == InstanceModifiedTypes::REMOVED)
-            continue;
         const auto& min_i = get_instance_aabb_min(i);
         const auto& max_i = get_instance_aabb_max(i);
         glm::vec3 closest = glm::clamp(offset_cen, min_i, max_i);
@@ -735,62 +854,10 @@ std::tuple<std::string, bool, float> Models::Model::is_closer_than_current_model
     return {name(instance_index), squared_distance < current_distance_to_closest_model, squared_distance};
 }
 
-bool Models::Model::aabb_in_frustum(const std::array<glm::vec4,6>& P, const glm::vec3& minB, const glm::vec3& maxB) const{
-    for (auto& plane : P) {
-        // pick the “positive‐vertex” for this plane normal
-        glm::vec3 n(plane);
-        glm::vec3 positive = {
-            n.x > 0.0f ? maxB.x : minB.x,
-            n.y > 0.0f ? maxB.y : minB.y,
-            n.z > 0.0f ? maxB.z : minB.z
-        };
-        // if that vertex is outside, the whole box is outside
-        if (glm::dot(n, positive) + plane.w < 0.0f)
-            return false;
-    }
-    return true;
-}
-
-void Models::Model::in_frustum(const std::array<glm::vec4,6>& P){
-    // clear previous state
-    inside_frustum_ = false;
-    if (is_instanced())
-        instance_in_frustum.assign(get_instance_count(), false);
-
-    // non-instanced: single AABB
-    if (!is_instanced()) {
-        inside_frustum_ = aabb_in_frustum(P, aabbmin, aabbmax);
-        return;
-    }
-
-    // instanced: test each live instance
-    int N = get_instance_count();
-    for (int i = 0; i < N; ++i) {
-        if (instance_modifications[i] == InstanceModifiedTypes::REMOVED)
-            continue;
-
-        auto minB = get_instance_aabb_min(i);
-        auto maxB = get_instance_aabb_max(i);
-        bool inside = aabb_in_frustum(P, minB, maxB);
-        instance_in_frustum[i] = inside;
-        if (inside)
-            inside_frustum_ = true;  // model is “in” if any instance is
-    }
-}
-
-
-
 void Models::Model::remove_instance_transform(const std::string& suffix){
-    auto it = std::find(instance_suffixes.begin(), instance_suffixes.end(), suffix);
-    if (it == instance_suffixes.end()) {
+    if (!remove_instance(find_instance(suffix))) {
         std::cerr << "Instance suffix not found: " << suffix << "\n";
-        return;
     }
-
-    size_t i = std::distance(instance_suffixes.begin(), it);
-    instance_modifications[i] = InstanceModifiedTypes::REMOVED;
-    instance_in_frustum[i] = false;
-    instance_data_dirty = true;
 }
 
 Models::Model Models::createFloor(float roomSize) {
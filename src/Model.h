@@ -1,8 +1,13 @@
 #pragma once
 
+#include "InstanceStream.h"
+#include "Mesh.h"
+#include "MeshArena.h"
+#include "MeshOptimizer.h"
 #include "OBJLoader.h"
 #include "Shader.h"
 #include "SubMesh.h"
+#include "Visibility.h"
 #include <GL/glew.h>
 #include <cfloat>
 #include <functional>
@@ -22,66 +27,93 @@ namespace Models {
 
     using namespace GlHelpers;
 
-    enum class InstanceModifiedTypes{
-        NOT_MODIFIED,
-        REMOVED,
+    // Names one instance of a Model for as long as it lives. The slot is reused after the
+    // instance is removed, with a new generation, so old handles stop resolving.
+    struct InstanceHandle {
+        uint32_t slot       = 0;
+        uint32_t generation = 0; // slots start at 1, a default handle never resolves
     };
 
-    struct Vertex {
-        glm::vec3 position;
-        glm::vec2 texcoord;
-        glm::vec3 normal;
-        glm::vec4 tangent;
+    // EBO bytes of every model created so far, and how many of them 16-bit indices saved
+    struct IndexBufferStats {
+        size_t bytes = 0;
+        size_t saved = 0;
+    };
 
-        bool operator==(Vertex const& o) const {
-            return glm::all(glm::epsilonEqual(position, o.position, glm::epsilon<float>())) &&
-                glm::all(glm::epsilonEqual(texcoord, o.texcoord, glm::epsilon<float>())) &&
-                glm::all(glm::epsilonEqual(normal, o.normal, glm::epsilon<float>()));
-        }
+    // CPU copies of vertex data: the ones Models dropped once the VBO was filled, and the ones
+    // kept because set_keep_cpu_vertices() asked for them
+    struct VertexMemoryStats {
+        size_t kept     = 0;
+        size_t released = 0;
     };
 
-    struct VertexHasher {
-        // TODO I don't know if thats good enough
-        size_t operator()(Vertex const& v) const noexcept {
-            auto h = std::hash<float>{};
-            // xor mixes the bits together
-            // while shifting them reduces collisions so they can be
-            // distributed evenly across buckets
-            size_t h0 = h(v.position.x) ^ (h(v.position.y) << 1) ^ (h(v.position.z) << 2);
-            size_t h1 = h(v.texcoord.x) ^ (h(v.texcoord.y) << 1);
-            size_t h2 = h(v.normal.x) ^ (h(v.normal.y) << 1) ^ (h(v.normal.z) << 2);
-            return h0 ^ (h1 << 1) ^ (h2 << 2);
-        }
+    // How a Model picks its level of detail: the coarsest one whose simplification error,
+    // projected on screen, stays under max_screen_error (a fraction of the viewport height).
+    // A coarser level is only taken once its error is under max_screen_error * (1 - hysteresis),
+    // so a model sitting right at the threshold does not switch back and forth every frame.
+    struct LodSettings {
+        bool  enabled          = true;
+        float max_screen_error = 1.0f / 720.0f;
+        float hysteresis       = 0.25f;
+    };
+
+    // Triangles submitted since the last reset_frame_stats()
+    struct FrameStats {
+        size_t triangles        = 0;
+        size_t shadow_triangles = 0; // depth passes, every cube face counts
+        size_t transforms       = 0; // world transforms (and AABBs) recomputed
+        size_t vao_binds        = 0; // models that had to bind another VAO to draw
+        size_t instance_bytes   = 0; // instance transforms written to the InstanceStream
+    };
+
+    // What one view of an instanced Model streamed last: the instance slots it drew, the
+    // instance_version they were taken at and where in the InstanceStream they went
+    struct InstanceList {
+        std::vector<uint32_t> slots;
+        uint32_t              version = 0;
+        InstanceRange         range;
     };
 
     class Model {
     public:
-        void draw_depth(std::shared_ptr<Shader> shader);
-        void draw_depth_instanced(std::shared_ptr<Shader> shader);
+        // view/projection of the shadow map, only used to pick the level of detail, view_id the
+        // index of the view in the frame's Visibility
+        void draw_depth(std::shared_ptr<Shader> shader, const glm::mat4& view,
+                        const glm::mat4& projection, uint32_t view_id);
+        // instances are the slots the view sees, view_id the index of the view in the
+        // frame's Visibility, each view streams its instances to a range of its own
+        void draw_depth_instanced(std::shared_ptr<Shader> shader, const glm::mat4& view,
+                                  const glm::mat4& projection, InstanceSpan instances,
+                                  uint32_t view_id);
         void draw(const glm::mat4& view, const glm::mat4& projection,
-                std::shared_ptr<Shader> shader);
+                std::shared_ptr<Shader> shader, InstanceSpan instances = {},
+                uint32_t view_id = 0);
         void draw_instanced(const glm::mat4& view, const glm::mat4& projection,
-                std::shared_ptr<Shader> shader);
+                std::shared_ptr<Shader> shader, InstanceSpan instances, uint32_t view_id);
         void set_local_transform(const glm::mat4& local_transform);
         void update_world_transform(const glm::mat4& parent_transform);
         void compute_aabb();
         void add_child(Model* child);
         void debug_dump() const;
         void move_relative_to(const glm::vec3& direction);
-        std::pair<glm::vec3, glm::vec3> calculate_tangent_bitangent(Models::Vertex v0, Models::Vertex v1, Models::Vertex v2);
-        void orthogonalize_and_normalize_tb(Models::Vertex& vertex, const std::vector<glm::vec3>& accumulated_tangent, const std::vector<glm::vec3>& accumulated_bitangent, const size_t index);
-        void add_instance_transform(const glm::mat4& transform,const std::string& suffix);
+        // throws when suffix already names an instance of this model
+        InstanceHandle add_instance_transform(const glm::mat4& transform,const std::string& suffix,
+                                              const InstanceAttributes& attributes = {});
         void compute_transformed_aabb(const glm::mat4& xf, glm::vec3& out_min, glm::vec3& out_max);
         void init_instancing(size_t max_instances);
-        void update_instance_data();
-        void in_frustum(const std::array<glm::vec4,6>& P);
-        bool aabb_in_frustum(const std::array<glm::vec4,6>& P, const glm::vec3& minB, const glm::vec3& maxB) const;
 
         std::tuple<std::string, bool, float> is_closer_than_current_model(const glm::vec3& point_to_check, float current_distance_from_closest_model);
         std::pair<bool, int> intersect_sphere_aabb(const glm::vec3& point, float radius);
         std::pair<float, int> distance_from_point_using_AABB(const glm::vec3& point);
 
         void remove_instance_transform(const std::string& suffix);
+        // false when handle does not name a live instance (anymore)
+        bool remove_instance(InstanceHandle handle);
+        bool set_instance_transform(InstanceHandle handle, const glm::mat4& transform);
+        // tint, flags and material variant, streamed with the transform
+        bool set_instance_attributes(InstanceHandle handle, const InstanceAttributes& attributes);
+        // a default handle when no live instance has suffix
+        InstanceHandle find_instance(const std::string& suffix) const;
 
         inline bool intersectAABB(const glm::vec3& minA, const glm::vec3& maxA, const glm::vec3& minB,
                                 const glm::vec3& maxB) {
@@ -97,6 +129,7 @@ namespace Models {
 
         inline void set_local_transform(glm::mat4&& local_transform) {
             this->local_transform = std::move(local_transform);
+            transform_dirty       = true;
         }
 
         inline glm::mat4 get_local_transform() {
@@ -119,19 +152,26 @@ namespace Models {
             this->interactable = is_interactive;
         }
 
-        inline bool is_in_frustum() const{
-
-            if(!is_instanced()){
-                return inside_frustum_;
-            }
+        inline bool can_interact() {
+            return interactable;
+        }
 
-            return std::any_of(instance_in_frustum.begin(), instance_in_frustum.end(), [](bool v){return v;});
+        // InstanceFlags of a model that is not instanced, its instances carry their own
+        inline void set_flags(uint32_t flags) {
+            this->flags = flags;
         }
 
-        inline bool can_interact() {
-            return interactable;
+        inline uint32_t get_flags() const {
+            return flags;
         }
 
+        // Variant n > 0 of an instance (InstanceAttributes::variant) scales the diffuse colour
+        // of every submesh by variants[n - 1].rgb and the specular one by .a, variants past
+        // the table draw the material as it is. Throws past max_material_variants.
+        void set_material_variants(const std::vector<glm::vec4>& variants);
+        // MAX_MATERIAL_VARIANTS of blinnphong.frag
+        static constexpr size_t max_material_variants = 4;
+
         inline bool is_active() const {
             return this->active;
         }
@@ -150,11 +190,18 @@ namespace Models {
 
         inline void set_scale(const glm::vec3& s) {
             local_transform = glm::scale(glm::mat4(1.0f), s) * local_transform;
+            transform_dirty = true;
+        }
+
+        // the transforms of the live instances in their current order
+        void set_instance_transforms(const std::vector<glm::mat4>& instance_transforms);
+
+        const glm::mat4& get_instance_transform(size_t i) const {
+            return instance_transforms[i];
         }
 
-        inline void set_instance_transforms(const std::vector<glm::mat4> instance_transforms) {
-            this->instance_transforms = instance_transforms;
-            instance_data_dirty = true;
+        const InstanceAttributes& get_instance_attributes(size_t i) const {
+            return instance_attributes[i];
         }
 
         const glm::vec3& get_instance_aabb_min(size_t i) const {
@@ -165,18 +212,18 @@ namespace Models {
             return instance_aabb_max[i];
         }
 
+        // live instances, indices 0 to count - 1 of the instance arrays. Removing one moves the
+        // last into its place, so indices are only good until the next removal.
         inline size_t get_instance_count() const {
             return instance_transforms.size();
         }
 
-        inline size_t get_active_instance_count() const {
-            return std::count_if(
-                instance_modifications.begin(),
-                instance_modifications.end(),
-                [](InstanceModifiedTypes m) {
-                    return m != InstanceModifiedTypes::REMOVED;
-                }
-            );
+        // -1 when handle does not name a live instance
+        inline int instance_index(InstanceHandle handle) const {
+            if (handle.slot >= instance_slots.size() ||
+                instance_slots[handle.slot].generation != handle.generation)
+                return -1;
+            return static_cast<int>(instance_slots[handle.slot].index);
         }
 
         inline glm::mat4 get_world_transform() const{
@@ -185,9 +232,14 @@ namespace Models {
 
         inline std::string name(std::size_t instance_index = 0) const {
             if (is_instanced() && instance_index >= 0 && instance_index < instance_suffixes.size()) {
-                return label + instance_suffixes[instance_index];
+                return label_ + instance_suffixes[instance_index];
             }
-            return label;
+            return label_;
+        }
+
+        // the name the model was created with, instances add their suffix to it
+        inline const std::string& label() const {
+            return label_;
         }
 
         Model(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
@@ -196,37 +248,174 @@ namespace Models {
 
         Model(const std::string& objFile, const std::string& label);
 
+        // Upload vertices as PackedVertex (20 bytes) instead of Vertex (48), on by default.
+        // Only affects models created afterwards.
+        inline static void set_packed_vertices(bool packed) {
+            pack_vertices = packed;
+        }
+
+        // Draw only the SubMesh::clusters that are in view and not facing away, on by default
+        inline static void set_cluster_culling(bool enabled) {
+            cull_clusters = enabled;
+        }
+
+        // Keep a CPU copy of the vertices after upload, for consumers such as collision
+        // baking, off by default. Only affects models created afterwards.
+        inline static void set_keep_cpu_vertices(bool keep) {
+            keep_vertices = keep;
+        }
+
+        // empty unless the model was created with set_keep_cpu_vertices(true)
+        inline const std::vector<Vertex>& cpu_vertices() const {
+            return unique_vertices;
+        }
+
+        inline static VertexMemoryStats vertex_memory_stats() {
+            return vertex_stats;
+        }
+
+        inline static IndexBufferStats index_buffer_stats() {
+            return index_stats;
+        }
+
+        inline static void set_lod_settings(const LodSettings& settings) {
+            lod_settings = settings;
+        }
+
+        inline static const LodSettings& get_lod_settings() {
+            return lod_settings;
+        }
+
+        inline static FrameStats frame_stats() {
+            return frame_counts;
+        }
+
+        inline static void reset_frame_stats() {
+            frame_counts = FrameStats{};
+        }
+
+        // moves only, the arena ranges and an instanced model's VAO have a single owner; the
+        // moved-from model is left without either
+        Model(Model&& other) noexcept;
+        Model& operator=(Model&& other) noexcept;
         ~Model();
 
     private:
+        // only filled with set_keep_cpu_vertices(true), the AABBs come from the local box
         std::vector<Vertex>  unique_vertices;
         std::vector<SubMesh> submeshes;
-        std::string          label;
+        std::string          label_;
         // where the model is located
         // relative to its parent
         glm::mat4 local_transform;
         // where the model is actually placed
         // in the world after applying all parent transforms
         glm::mat4              world_transform;
+        // world_transform and the AABB are only recomputed when the local transform changed
+        // or the parent passes a different one than last time
+        bool      transform_dirty = true;
+        glm::mat4 parent_world    = glm::mat4(1.0f);
 
+        // the live instances, dense: removal swaps the last one into the hole
         std::vector<std::string> instance_suffixes;
         std::vector<glm::mat4> instance_transforms;
+        std::vector<InstanceAttributes> instance_attributes;
         std::vector<glm::vec3> instance_aabb_min;
         std::vector<glm::vec3> instance_aabb_max;
-        std::vector<InstanceModifiedTypes> instance_modifications;
-        std::vector<bool> instance_in_frustum;
-
-        bool inside_frustum_ = true;
-        bool instance_data_dirty = true;
-
+        std::vector<uint32_t>  instance_slot_of; // the handle slot of each dense index
+
+        // handle slot -> dense index, with the generation a handle has to match
+        struct InstanceSlot {
+            uint32_t index      = 0;
+            uint32_t generation = 0;
+        };
+        std::vector<InstanceSlot>                       instance_slots;
+        std::vector<uint32_t>                           free_instance_slots;
+        std::unordered_map<std::string, InstanceHandle> instance_by_suffix;
+
+        // bumped whenever an instance is added, removed, moved or its attributes change
+        uint32_t instance_version = 1;
+        // by view_id
+        std::vector<InstanceList> view_instances;
+        // stream_instances() scratch
+        std::vector<InstanceData> instance_scratch;
+        // where attributes 4-9 of the VAO start reading, in records, without base instance
+        uint32_t instance_attrib_first = 0;
+        // the InstanceStream buffer they read
+        GLuint instance_buffer = 0;
+
+        // deletes the VAO init_instancing() created, if any
+        void release_instancing();
         void draw_instanced(const glm::mat4& view, const glm::mat4& projection,
                             std::shared_ptr<Shader> shader) const;
+        // the transforms of instances in the InstanceStream, written again only when they
+        // differ from what the view_id's list holds or its range was recycled
+        const InstanceRange& stream_instances(uint32_t view_id, InstanceSpan instances);
+        // range of sm for every instance of instances, offset with base instance when the
+        // driver has it and by moving the instance attributes otherwise
+        void draw_instances(const SubMesh& sm, const LodRange& range,
+                            const InstanceRange& instances);
+        // copies the mesh's vertices and indices into MeshArena::shared(), the indices are 16-bit
+        // when every vertex fits and the submeshes' index_size says which. A baked mesh is
+        // uploaded from its mapped, already packed and narrowed streams. The vertices end up in
+        // unique_vertices only when keep_vertices is set.
+        void upload_buffers(const MeshData& mesh);
+        // uPosOffset/uPosScale (and uTexOffset/uTexScale when the shader samples textures),
+        // how the vertex shaders get packed attributes back
+        void set_unpack_uniforms(Shader& shader, bool texcoords) const;
+
+        // Fraction of the viewport height the mesh's AABB diagonal covers at most, over the
+        // world transform or the instances; infinite once the eye is inside the box.
+        float projected_extent(const glm::mat4& view, const glm::mat4& projection,
+                               InstanceSpan instances) const;
+        // the level view_id drew last time, grown to fit
+        uint32_t& lod_level_of(uint32_t view_id);
+        // the level to draw from view, current is the one drawn last time and is updated
+        uint32_t select_lod(const glm::mat4& view, const glm::mat4& projection,
+                            uint32_t& current, InstanceSpan instances = {}) const;
+
+        // the triangles of sm at level lod, at level 0 only its clusters that survive view,
+        // neighbouring ones merged into one range of a glMultiDrawElements. Returns the
+        // triangles drawn.
+        size_t draw_submesh(const SubMesh& sm, uint32_t lod, const ClusterView& view);
+        // fills cluster_views with one view per instance of visible, or leaves it empty (no
+        // cluster culling) when there are more than max_cluster_cull_instances of them
+        void make_instance_cluster_views(const glm::mat4& view, const glm::mat4& projection,
+                                         InstanceSpan visible, bool cull_front_faces);
+        // sm at level lod for every instance of instances. At level 0 only the clusters one of
+        // cluster_views sees are drawn, one instanced draw per run of neighbouring ones, as
+        // there is no multi-draw of instanced ranges. Returns the triangles drawn.
+        size_t draw_submesh_instanced(const SubMesh& sm, uint32_t lod,
+                                      const InstanceRange& instances);
+
+        inline static bool              pack_vertices = true;
+        inline static bool              cull_clusters = true;
+        inline static bool              keep_vertices = false;
+        inline static VertexMemoryStats vertex_stats;
+        inline static IndexBufferStats  index_stats;
+        inline static LodSettings       lod_settings;
+        inline static FrameStats        frame_counts;
+
+        // of every SubMesh::lods level, relative to the local AABB diagonal
+        std::vector<float> lod_errors;
+        // the level each view_id drew last, every view keeps its own hysteresis
+        std::vector<uint32_t> view_lod_levels;
+        // draw_submesh() scratch, kept to not allocate every frame
+        std::vector<GLsizei>     cluster_counts;
+        std::vector<const void*> cluster_offsets;
+        std::vector<GLint>       cluster_base_vertices;
+        std::vector<ClusterView> cluster_views;
+        // testing every cluster against every instance costs more than it saves past this
+        static constexpr size_t max_cluster_cull_instances = 16;
+        // identity for float vertices
+        PackedBounds packed_bounds;
 
-        GLuint instance_vbo  = 0;
         bool   is_instanced_ = false;
-        GLuint vao, vbo, ebo = 0;
+        // the arena block's VAO, or one of the model's own once it is instanced
+        GLuint         vao = 0;
+        MeshAllocation arena_range;
+        VertexFormat   vertex_format = VertexFormat::Packed;
         GLuint texture_id = 0;
-        GLuint gl_instance_count = 0;
 
         // 1) Object-space AABB (min/max corners in mesh local coords)
         glm::vec3 localaabbmin;
@@ -237,6 +426,12 @@ namespace Models {
         glm::vec3 aabbmax;
 
         bool                interactable = false;
+        uint32_t            flags        = 0;
+        std::vector<glm::vec4> material_variants;
+        // tags the table for Shader::set_vec4_array(), 1 is the empty table every model
+        // starts with
+        uint64_t               variants_version = 1;
+        inline static uint64_t next_variants_version = 2;
         bool                active       = true;
         std::vector<Model*> children;
     };
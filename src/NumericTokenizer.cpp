@@ -0,0 +1,734 @@
+#include "NumericTokenizer.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TOKENIZER_X86 1
+#include <immintrin.h>
+#define TOKENIZER_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TOKENIZER_TARGET_AVX2 __attribute__((target("avx2")))
+// the SIMD loads read a little around a record, see Window
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define TOKENIZER_X86 0
+#endif
+
+namespace {
+
+    using ObjectLoader::Corner;
+    using ObjectLoader::TokenizerIsa;
+
+    inline bool is_digit(char c) {
+        return static_cast<unsigned char>(c - '0') <= 9;
+    }
+
+    inline bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+    }
+
+    constexpr double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    // Sets out to the float nearest to mantissa * 10^exp10 when that can be had from one
+    // correctly rounded double operation: both operands are exact doubles (mantissa <= 2^53,
+    // |exp10| <= 22), so the division/multiplication rounds once to the nearest double and the
+    // conversion rounds that to the nearest float. The second rounding only differs from
+    // rounding the exact value when the double landed exactly halfway between two floats,
+    // those are left to std::from_chars. The range also keeps clear of float overflow and
+    // denormals. Not used where float math runs at a wider precision (x87).
+    inline bool exact_float(uint64_t mantissa, int exp10, bool negative, float& out) {
+#if FLT_EVAL_METHOD == 0
+        if (mantissa == 0) {
+            out = negative ? -0.0f : 0.0f;
+            return true;
+        }
+        if (mantissa > (uint64_t{1} << 53) || exp10 < -22 || exp10 > 22)
+            return false;
+        double value = exp10 < 0 ? static_cast<double>(mantissa) / POW10[-exp10]
+                                 : static_cast<double>(mantissa) * POW10[exp10];
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        // the 29 mantissa bits a float drops are exactly one half
+        if ((bits & 0x1FFFFFFF) == 0x10000000)
+            return false;
+        float rounded = static_cast<float>(value);
+        out           = negative ? -rounded : rounded;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // --- scalar ---------------------------------------------------------------------------
+
+    size_t scalar_floats(const char* p, const char* end, float* out, size_t n) {
+        size_t count = 0;
+        while (count < n) {
+            auto [next, ec] = ObjectLoader::parse_float(p, end, out[count]);
+            if (ec != std::errc())
+                break;
+            ++count;
+            p = next;
+            while (p < end && is_space(*p))
+                ++p;
+        }
+        return count;
+    }
+
+    // parse_index(), inlined into the corner loop
+    inline std::from_chars_result read_index(const char* first, const char* last, int32_t& out) {
+        const char* p        = first;
+        const bool  negative = p < last && *p == '-';
+        p += negative;
+
+        int32_t value  = 0;
+        int     digits = 0;
+        for (; p < last && is_digit(*p) && digits < 9; ++p, ++digits)
+            value = value * 10 + (*p - '0');
+        // nothing to read or possibly out of range
+        if (digits == 0 || (p < last && is_digit(*p)))
+            return std::from_chars(first, last, out);
+        out = negative ? -value : value;
+        return {p, std::errc()};
+    }
+
+    size_t scalar_corners(const char* p, const char* end, std::vector<Corner>& out) {
+        const size_t first = out.size();
+        while (p < end && !is_space(*p) && *p != '#') {
+            Corner corner{0, 0, 0};
+            auto [p1, ec1] = read_index(p, end, corner.vertex);
+            if (ec1 != std::errc())
+                break;
+
+            p = p1;
+            // v/vt, v/vt/vn or v//vn
+            if (p < end && *p == '/') {
+                ++p;
+                if (p < end && *p == '/') {
+                    ++p;
+                    auto [p2, ec2] = read_index(p, end, corner.normal);
+                    if (ec2 != std::errc())
+                        corner.normal = 0;
+                    p = p2;
+                } else {
+                    auto [p2, ec2] = read_index(p, end, corner.texcoord);
+                    if (ec2 != std::errc())
+                        corner.texcoord = 0;
+                    p = p2;
+                    if (p < end && *p == '/') {
+                        ++p;
+                        auto [p3, ec3] = read_index(p, end, corner.normal);
+                        if (ec3 != std::errc())
+                            corner.normal = 0;
+                        p = p3;
+                    }
+                }
+            }
+            out.push_back(corner);
+
+            while (p < end && is_space(*p))
+                ++p;
+        }
+        return out.size() - first;
+    }
+
+#if TOKENIZER_X86
+    // --- SIMD -----------------------------------------------------------------------------
+    // A record is classified WINDOW bytes at a time into one bit per byte for every character
+    // class its tokens are made of. Token boundaries come straight out of the whitespace bits,
+    // each token is then checked against the plain forms with a few mask operations and its
+    // digits are converted with multiply-adds, 16 at a time. Tokens of any other form are
+    // left to the scalar code (from the first such token on, so both always agree), tokens
+    // cut by the end of a window are read again from the start of the next one.
+
+    constexpr size_t WINDOW  = 64;
+    constexpr size_t PADDING = 16; // readable bytes before a window, digit runs are loaded
+                                   // right aligned
+
+    struct Classes {
+        uint64_t digit = 0;
+        uint64_t space = 0;
+        uint64_t dot   = 0;
+        uint64_t minus = 0;
+        uint64_t slash = 0;
+    };
+
+    // Up to WINDOW bytes of a record starting at base, with PADDING bytes before them.
+    // Mapped files and heap buffers are read in place when the bytes around the record are
+    // on the same page as it; they are never used, only loaded. Near a page boundary the
+    // record is copied into a zero padded buffer instead.
+    struct Window {
+        alignas(16) char buffer[PADDING + WINDOW];
+        const char*      text;
+        size_t           length;
+        bool             last; // the record ends inside this window
+        uint64_t         valid; // one bit per byte of the record in the window
+    };
+
+    inline void fill_window(Window& window, std::string_view record,
+                                                size_t base) {
+        const char* start = record.data() + base;
+        window.length     = std::min(record.size() - base, WINDOW);
+        window.last       = base + window.length == record.size();
+        window.valid      = window.length == WINDOW ? ~uint64_t{0}
+                                                    : (uint64_t{1} << window.length) - 1;
+
+        const uintptr_t first = reinterpret_cast<uintptr_t>(start) - PADDING;
+        const uintptr_t last  = reinterpret_cast<uintptr_t>(start) + WINDOW - 1;
+        if (first >> 12 == last >> 12) {
+            window.text = start;
+            return;
+        }
+        std::memset(window.buffer, 0, sizeof(window.buffer));
+        std::memcpy(window.buffer + PADDING, start, window.length);
+        window.text = window.buffer + PADDING;
+    }
+
+    inline bool has(uint64_t mask, size_t pos) {
+        return pos < WINDOW && (mask >> pos) & 1;
+    }
+
+    // bits [from, to) of a mask, to <= WINDOW
+    inline uint64_t span(size_t from, size_t to) {
+        if (from >= to)
+            return 0;
+        uint64_t below_to = to == WINDOW ? ~uint64_t{0} : (uint64_t{1} << to) - 1;
+        return below_to & ~((uint64_t{1} << from) - 1);
+    }
+
+    // Value of the decimal digits in the lanes of `digits` (0-9 each, zero elsewhere), lane
+    // 15 being the last digit. Pairs, then quads, then two halves of 8 digits.
+    TOKENIZER_TARGET_SSE42 inline uint64_t digit_value(__m128i digits) {
+        __m128i pairs = _mm_maddubs_epi16(
+            digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+        __m128i quads  = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+        __m128i packed = _mm_packus_epi32(quads, quads);
+        __m128i eights =
+            _mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+        uint64_t high = static_cast<uint32_t>(_mm_cvtsi128_si32(eights));
+        uint64_t low  = static_cast<uint32_t>(_mm_extract_epi32(eights, 1));
+        return high * 100000000ull + low;
+    }
+
+    // the 16 bytes ending at end as digits, lanes before the last count ones zeroed
+    NO_SANITIZE_ADDRESS TOKENIZER_TARGET_SSE42 inline __m128i load_digits(const char* end,
+                                                                          size_t      count) {
+        const __m128i lane = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m128i keep = _mm_cmpgt_epi8(lane, _mm_set1_epi8(static_cast<char>(15 - count)));
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(end - 16));
+        return _mm_and_si128(_mm_sub_epi8(chars, _mm_set1_epi8('0')), keep);
+    }
+
+    // Shuffles that drop lane `dot` by moving the lanes before it up by one.
+    struct DropLane {
+        alignas(16) int8_t shuffle[16][16];
+
+        constexpr DropLane() : shuffle{} {
+            for (int dot = 0; dot < 16; ++dot) {
+                for (int lane = 0; lane < 16; ++lane) {
+                    shuffle[dot][lane] = lane > dot ? lane : lane == 0 ? -1 : lane - 1;
+                }
+            }
+        }
+    };
+    constexpr DropLane DROP_LANE;
+
+    // bytes in [lo, lo + span]
+    TOKENIZER_TARGET_SSE42 inline __m128i in_range(__m128i chars, char lo, char span) {
+        __m128i offset = _mm_sub_epi8(chars, _mm_set1_epi8(lo));
+        return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(span)), offset);
+    }
+
+    TOKENIZER_TARGET_AVX2 inline __m256i in_range(__m256i chars, char lo, char span) {
+        __m256i offset = _mm256_sub_epi8(chars, _mm256_set1_epi8(lo));
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(span)), offset);
+    }
+
+    NO_SANITIZE_ADDRESS TOKENIZER_TARGET_SSE42 Classes classify_sse42(const char* text,
+                                                                      size_t      length) {
+        // pcmpestrm matches the whitespace set in one instruction
+        const __m128i spaces = _mm_setr_epi8(' ', '\t', '\r', '\n', '\v', '\f', 0, 0, 0, 0, 0, 0,
+                                             0, 0, 0, 0);
+        constexpr int set_mode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+
+        Classes out;
+        for (int block = 0; block * 16 < static_cast<int>(length); ++block) {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + block * 16));
+            const int shift = block * 16;
+            out.digit |= uint64_t{static_cast<uint16_t>(_mm_movemask_epi8(in_range(chars, '0', 9)))}
+                         << shift;
+            out.space |= uint64_t{static_cast<uint16_t>(
+                             _mm_cvtsi128_si32(_mm_cmpestrm(spaces, 6, chars, 16, set_mode)))}
+                         << shift;
+            out.dot |= uint64_t{static_cast<uint16_t>(
+                           _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('.'))))}
+                       << shift;
+            out.minus |= uint64_t{static_cast<uint16_t>(
+                             _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('-'))))}
+                         << shift;
+            out.slash |= uint64_t{static_cast<uint16_t>(
+                             _mm_movemask_epi8(_mm_cmpeq_epi8(chars, _mm_set1_epi8('/'))))}
+                         << shift;
+        }
+        return out;
+    }
+
+    NO_SANITIZE_ADDRESS TOKENIZER_TARGET_AVX2 Classes classify_avx2(const char* text,
+                                                                    size_t      length) {
+        Classes out;
+        for (int half = 0; half * 32 < static_cast<int>(length); ++half) {
+            __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + half * 32));
+            __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')),
+                                            in_range(chars, '\t', '\r' - '\t'));
+            const int shift = half * 32;
+            out.digit |= uint64_t{static_cast<uint32_t>(
+                             _mm256_movemask_epi8(in_range(chars, '0', 9)))}
+                         << shift;
+            out.space |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(space))} << shift;
+            out.dot |= uint64_t{static_cast<uint32_t>(
+                           _mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('.'))))}
+                       << shift;
+            out.minus |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(
+                             _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('-'))))}
+                         << shift;
+            out.slash |= uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(
+                             _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/'))))}
+                         << shift;
+        }
+        return out;
+    }
+
+    // The tokens of a window: starts has a bit on the first byte of each, ends on the byte
+    // after each. Bytes past the record count as whitespace.
+    struct Tokens {
+        uint64_t starts;
+        uint64_t ends;
+    };
+
+    inline Tokens find_tokens(const Classes& classes, uint64_t valid) {
+        const uint64_t solid = ~classes.space & valid;
+        return {solid & ~(solid << 1), ~solid & (solid << 1)};
+    }
+
+    // first token end after a token starting at start, WINDOW if it reaches the end
+    inline size_t token_end(const Tokens& tokens, size_t start) {
+        uint64_t after = tokens.ends >> start;
+        return after ? start + __builtin_ctzll(after) : WINDOW;
+    }
+
+    // A token of the form [-]digits[.digits] with at most 15 digits, whose value is the
+    // integer of its digits over 10^places.
+    struct PlainFloat {
+        uint32_t start;
+        uint32_t end;
+        uint32_t length;   // of the digits and point, without the sign
+        int32_t  dot_lane; // of the point in the 16 bytes ending at end, -1 if none
+        uint32_t places;
+        bool     negative;
+    };
+
+    // the 16 digits register of a token, right aligned, point dropped
+    NO_SANITIZE_ADDRESS TOKENIZER_TARGET_SSE42 inline __m128i
+    token_digits(const char* text, const PlainFloat& token) {
+        __m128i digits = load_digits(text + token.end, token.length);
+        if (token.dot_lane >= 0) {
+            digits = _mm_shuffle_epi8(digits, _mm_load_si128(reinterpret_cast<const __m128i*>(
+                                                  DROP_LANE.shuffle[token.dot_lane])));
+        }
+        return digits;
+    }
+
+    // Mantissas below 2^52 to doubles: they fill the low bits of 2^52's mantissa exactly.
+    constexpr int64_t TWO_POW_52_BITS = 0x4330000000000000;
+    constexpr double  TWO_POW_52      = 4503599627370496.0;
+
+    // The last step of exact_float() for several tokens at once, doubles that landed exactly
+    // halfway between two floats are redone by std::from_chars.
+    inline void finish_halfway(const char* text, const PlainFloat* tokens, int halfway,
+                               float* out) {
+        for (int i = 0; halfway; ++i, halfway >>= 1) {
+            if (halfway & 1)
+                std::from_chars(text + tokens[i].start, text + tokens[i].end, out[i]);
+        }
+    }
+
+    // Two tokens per register: the digits of both are weighted together, the two 8 digit
+    // halves of each are combined in 64-bit lanes, scaled as doubles and narrowed to floats.
+    NO_SANITIZE_ADDRESS TOKENIZER_TARGET_SSE42 void
+    convert_floats_sse42(const char* text, const PlainFloat* tokens, size_t count, float* out) {
+        const __m128i pair_weights = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10,
+                                                   1, 10, 1);
+        const __m128i quad_weights  = _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1);
+        const __m128i eight_weights = _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1);
+        const __m128i magic         = _mm_set1_epi64x(TWO_POW_52_BITS);
+        const __m128i half_mask     = _mm_set1_epi64x(0x1FFFFFFF);
+        const __m128i half          = _mm_set1_epi64x(0x10000000);
+
+        for (size_t i = 0; i < count; i += 2) {
+            const PlainFloat& a    = tokens[i];
+            const bool        pair = i + 1 < count;
+            const PlainFloat& b    = tokens[pair ? i + 1 : i];
+
+            __m128i quads_a = _mm_madd_epi16(
+                _mm_maddubs_epi16(token_digits(text, a), pair_weights), quad_weights);
+            __m128i quads_b = _mm_madd_epi16(
+                _mm_maddubs_epi16(token_digits(text, b), pair_weights), quad_weights);
+            // a_high a_low b_high b_low
+            __m128i eights =
+                _mm_madd_epi16(_mm_packus_epi32(quads_a, quads_b), eight_weights);
+            __m128i mantissas = _mm_add_epi64(_mm_mul_epu32(eights, _mm_set1_epi64x(100000000)),
+                                              _mm_srli_epi64(eights, 32));
+
+            __m128d values = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(mantissas, magic)),
+                                        _mm_set1_pd(TWO_POW_52));
+            values = _mm_div_pd(values, _mm_setr_pd(POW10[a.places], POW10[b.places]));
+
+            __m128i bits   = _mm_castpd_si128(values);
+            int     halfway = _mm_movemask_pd(
+                _mm_castsi128_pd(_mm_cmpeq_epi64(_mm_and_si128(bits, half_mask), half)));
+            __m128 floats = _mm_cvtpd_ps(values);
+            floats        = _mm_xor_ps(floats, _mm_castsi128_ps(_mm_setr_epi32(
+                                                   a.negative ? INT32_MIN : 0,
+                                                   b.negative ? INT32_MIN : 0, 0, 0)));
+
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, floats);
+            out[i] = lanes[0];
+            if (pair)
+                out[i + 1] = lanes[1];
+            finish_halfway(text, tokens + i, pair ? halfway : halfway & 1, out + i);
+        }
+    }
+
+    // Four tokens at once: tokens 0 and 1 share one 256-bit register, 2 and 3 the other.
+    NO_SANITIZE_ADDRESS TOKENIZER_TARGET_AVX2 void
+    convert_floats_avx2(const char* text, const PlainFloat* tokens, size_t count, float* out) {
+        const __m256i pair_weights  = _mm256_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                                                       10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1,
+                                                       10, 1, 10, 1, 10, 1, 10, 1);
+        const __m256i quad_weights  = _mm256_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1, 100, 1,
+                                                        100, 1, 100, 1, 100, 1);
+        const __m256i eight_weights = _mm256_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1,
+                                                        10000, 1, 10000, 1, 10000, 1, 10000, 1);
+
+        for (size_t i = 0; i < count; i += 4) {
+            // a short batch repeats its last token
+            const size_t      batch = std::min<size_t>(count - i, 4);
+            const PlainFloat& t0    = tokens[i];
+            const PlainFloat& t1    = tokens[i + std::min<size_t>(1, batch - 1)];
+            const PlainFloat& t2    = tokens[i + std::min<size_t>(2, batch - 1)];
+            const PlainFloat& t3    = tokens[i + batch - 1];
+
+            __m256i low_tokens  = _mm256_set_m128i(token_digits(text, t1), token_digits(text, t0));
+            __m256i high_tokens = _mm256_set_m128i(token_digits(text, t3), token_digits(text, t2));
+            __m256i quads_low   = _mm256_madd_epi16(
+                _mm256_maddubs_epi16(low_tokens, pair_weights), quad_weights);
+            __m256i quads_high = _mm256_madd_epi16(
+                _mm256_maddubs_epi16(high_tokens, pair_weights), quad_weights);
+            // per 128-bit lane: the high and low halves of token 0 and 2, then of 1 and 3
+            __m256i eights =
+                _mm256_madd_epi16(_mm256_packus_epi32(quads_low, quads_high), eight_weights);
+            __m256i mantissas =
+                _mm256_add_epi64(_mm256_mul_epu32(eights, _mm256_set1_epi64x(100000000)),
+                                 _mm256_srli_epi64(eights, 32));
+            mantissas = _mm256_permute4x64_epi64(mantissas, _MM_SHUFFLE(3, 1, 2, 0));
+
+            __m256d values =
+                _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(
+                                  mantissas, _mm256_set1_epi64x(TWO_POW_52_BITS))),
+                              _mm256_set1_pd(TWO_POW_52));
+            values = _mm256_div_pd(values, _mm256_setr_pd(POW10[t0.places], POW10[t1.places],
+                                                          POW10[t2.places], POW10[t3.places]));
+
+            __m256i bits    = _mm256_castpd_si256(values);
+            int     halfway = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(
+                _mm256_and_si256(bits, _mm256_set1_epi64x(0x1FFFFFFF)),
+                _mm256_set1_epi64x(0x10000000))));
+            __m128 floats = _mm_xor_ps(
+                _mm256_cvtpd_ps(values),
+                _mm_castsi128_ps(_mm_setr_epi32(-static_cast<int32_t>(t0.negative) & INT32_MIN,
+                                                -static_cast<int32_t>(t1.negative) & INT32_MIN,
+                                                -static_cast<int32_t>(t2.negative) & INT32_MIN,
+                                                -static_cast<int32_t>(t3.negative) & INT32_MIN)));
+
+            if (batch == 4) {
+                _mm_storeu_ps(out + i, floats);
+            } else {
+                alignas(16) float lanes[4];
+                _mm_store_ps(lanes, floats);
+                std::memcpy(out + i, lanes, batch * sizeof(float));
+            }
+            finish_halfway(text, tokens + i, halfway & ((1 << batch) - 1), out + i);
+        }
+    }
+
+    template <Classes (*Classify)(const char*, size_t),
+              void (*Convert)(const char*, const PlainFloat*, size_t, float*)>
+    NO_SANITIZE_ADDRESS TOKENIZER_TARGET_SSE42 size_t simd_floats(std::string_view record,
+                                                                  float* out, size_t n) {
+        Window     window;
+        PlainFloat plain[WINDOW / 2];
+        size_t     count = 0;
+        size_t     base  = 0;
+        while (count < n && base < record.size()) {
+            fill_window(window, record, base);
+            const char*   text    = window.text;
+            Classes       classes = Classify(text, window.length);
+            Tokens        tokens  = find_tokens(classes, window.valid);
+            // like from_chars, whitespace where the first number should be fails it
+            if (base == 0 && has(classes.space, 0))
+                return 0;
+
+            size_t found  = 0;
+            size_t resume = window.length; // where the next window starts
+            bool   scalar = false;
+            for (; tokens.starts && count + found < n; tokens.starts &= tokens.starts - 1) {
+                const size_t start = __builtin_ctzll(tokens.starts);
+                const size_t end   = token_end(tokens, start);
+                if (end >= window.length && !window.last) {
+                    resume = start;
+                    scalar = start == 0;
+                    break;
+                }
+
+                const bool     negative = has(classes.minus, start);
+                const size_t   first    = start + negative;
+                const uint64_t body     = span(first, end);
+                const uint64_t dots     = classes.dot & body;
+                const size_t   length   = end - first;
+                if ((body & ~(classes.digit | dots)) || (dots & (dots - 1)) ||
+                    !has(classes.digit, first) || length > 16 || (!dots && length > 15)) {
+                    resume = start;
+                    scalar = true;
+                    break;
+                }
+
+                PlainFloat& token = plain[found++];
+                token.start       = static_cast<uint32_t>(start);
+                token.end         = static_cast<uint32_t>(end);
+                token.length      = static_cast<uint32_t>(length);
+                token.negative    = negative;
+                if (dots) {
+                    const size_t dot = __builtin_ctzll(dots);
+                    token.dot_lane   = static_cast<int32_t>(dot + 16 - end);
+                    token.places     = static_cast<uint32_t>(end - dot - 1);
+                } else {
+                    token.dot_lane = -1;
+                    token.places   = 0;
+                }
+            }
+
+            if (found) {
+                Convert(text, plain, found, out + count);
+                count += found;
+            }
+            if (scalar) {
+                const char* rest = record.data() + base + resume;
+                return count + scalar_floats(rest, record.data() + record.size(), out + count,
+                                             n - count);
+            }
+            if (window.last)
+                break;
+            base += resume;
+        }
+        return count;
+    }
+
+    // One index of a corner in [from, to): [-]digits, at most 9 so it fits an int32_t.
+    NO_SANITIZE_ADDRESS TOKENIZER_TARGET_SSE42 inline bool
+    plain_index(const char* text, const Classes& classes, size_t from, size_t to, int32_t& out) {
+        const bool   negative = has(classes.minus, from);
+        const size_t digits   = to - from - negative;
+        if (digits == 0 || digits > 9 || (span(from + negative, to) & ~classes.digit))
+            return false;
+        int32_t value = static_cast<int32_t>(digit_value(load_digits(text + to, digits)));
+        out           = negative ? -value : value;
+        return true;
+    }
+
+    // v, v/vt, v/vt/vn or v//vn made of plain indices
+    template <Classes (*Classify)(const char*, size_t)>
+    NO_SANITIZE_ADDRESS TOKENIZER_TARGET_SSE42 size_t simd_corners(std::string_view    record,
+                                                                   std::vector<Corner>& out) {
+        const size_t first = out.size();
+        Window       window;
+        size_t       base = 0;
+        while (base < record.size()) {
+            fill_window(window, record, base);
+            const char*   text    = window.text;
+            Classes       classes = Classify(text, window.length);
+            Tokens        tokens  = find_tokens(classes, window.valid);
+            if (base == 0 && has(classes.space, 0))
+                return 0;
+
+            size_t resume = window.length;
+            bool   scalar = false;
+            for (; tokens.starts; tokens.starts &= tokens.starts - 1) {
+                const size_t start = __builtin_ctzll(tokens.starts);
+                const size_t end   = token_end(tokens, start);
+                if (end >= window.length && !window.last) {
+                    resume = start;
+                    scalar = start == 0;
+                    break;
+                }
+
+                uint64_t slashes = classes.slash & span(start, end);
+                Corner   corner{0, 0, 0};
+                // at most two
+                uint64_t extra = slashes & (slashes - 1);
+                bool     plain = (extra & (extra - 1)) == 0;
+                if (plain && !slashes) {
+                    plain = plain_index(text, classes, start, end, corner.vertex);
+                } else if (plain) {
+                    const size_t slash = __builtin_ctzll(slashes);
+                    slashes &= slashes - 1;
+                    plain = plain_index(text, classes, start, slash, corner.vertex);
+                    if (!slashes) {
+                        plain = plain &&
+                                plain_index(text, classes, slash + 1, end, corner.texcoord);
+                    } else {
+                        const size_t second = __builtin_ctzll(slashes);
+                        plain = plain && (second == slash + 1 ||
+                                          plain_index(text, classes, slash + 1, second,
+                                                      corner.texcoord)) &&
+                                plain_index(text, classes, second + 1, end, corner.normal);
+                    }
+                }
+                if (!plain) {
+                    resume = start;
+                    scalar = true;
+                    break;
+                }
+                out.push_back(corner);
+            }
+
+            if (scalar) {
+                scalar_corners(record.data() + base + resume, record.data() + record.size(), out);
+                return out.size() - first;
+            }
+            if (window.last)
+                break;
+            base += resume;
+        }
+        return out.size() - first;
+    }
+#endif
+
+    TokenizerIsa detect_isa() {
+#if TOKENIZER_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return TokenizerIsa::AVX2;
+        if (__builtin_cpu_supports("sse4.2"))
+            return TokenizerIsa::SSE42;
+#endif
+        return TokenizerIsa::Scalar;
+    }
+
+    // Scalar until asked otherwise: on the short records of the game's assets the SIMD versions
+    // measure slower than the scalar fast path, see OBJLoaderBench --tokenizer
+    std::atomic<TokenizerIsa>& active_isa() {
+        static std::atomic<TokenizerIsa> isa{TokenizerIsa::Scalar};
+        return isa;
+    }
+
+} // namespace
+
+ObjectLoader::TokenizerIsa ObjectLoader::best_tokenizer_isa() {
+    static const TokenizerIsa best = detect_isa();
+    return best;
+}
+
+ObjectLoader::TokenizerIsa ObjectLoader::tokenizer_isa() {
+    return active_isa().load(std::memory_order_relaxed);
+}
+
+void ObjectLoader::set_tokenizer_isa(TokenizerIsa isa) {
+    if (static_cast<int>(isa) > static_cast<int>(best_tokenizer_isa()))
+        isa = best_tokenizer_isa();
+    active_isa().store(isa, std::memory_order_relaxed);
+}
+
+const char* ObjectLoader::tokenizer_isa_name(TokenizerIsa isa) {
+    switch (isa) {
+    case TokenizerIsa::SSE42:
+        return "sse4.2";
+    case TokenizerIsa::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+std::from_chars_result ObjectLoader::parse_float(const char* first, const char* last,
+                                                 float& out) {
+    const char* p        = first;
+    const bool  negative = p < last && *p == '-';
+    p += negative;
+
+    uint64_t mantissa = 0;
+    int      digits   = 0;
+    for (; p < last && is_digit(*p); ++p, ++digits)
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+    const int whole_digits = digits;
+
+    int exp10 = 0;
+    if (p < last && *p == '.') {
+        for (++p; p < last && is_digit(*p); ++p, ++digits)
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        exp10 = whole_digits - digits;
+    }
+
+    // "1e5", "1.5E-3": only a well formed exponent of a few digits is taken here
+    bool plain = whole_digits > 0 && digits <= 19;
+    if (plain && p < last && (*p == 'e' || *p == 'E')) {
+        const char* q        = p + 1;
+        const bool  exp_sign = q < last && (*q == '-' || *q == '+');
+        q += exp_sign;
+        int exponent = 0, exp_digits = 0;
+        for (; q < last && is_digit(*q) && exp_digits < 4; ++q, ++exp_digits)
+            exponent = exponent * 10 + (*q - '0');
+        plain = exp_digits > 0 && !(q < last && is_digit(*q));
+        exp10 += exp_sign && p[1] == '-' ? -exponent : exponent;
+        p = q;
+    }
+
+    if (plain && exact_float(mantissa, exp10, negative, out))
+        return {p, std::errc()};
+    return std::from_chars(first, last, out);
+}
+
+std::from_chars_result ObjectLoader::parse_index(const char* first, const char* last,
+                                                 int32_t& out) {
+    return read_index(first, last, out);
+}
+
+size_t ObjectLoader::parse_floats(std::string_view record, float* out, size_t n) {
+    switch (tokenizer_isa()) {
+#if TOKENIZER_X86
+    case TokenizerIsa::AVX2:
+        return simd_floats<classify_avx2, convert_floats_avx2>(record, out, n);
+    case TokenizerIsa::SSE42:
+        return simd_floats<classify_sse42, convert_floats_sse42>(record, out, n);
+#endif
+    default:
+        return scalar_floats(record.data(), record.data() + record.size(), out, n);
+    }
+}
+
+size_t ObjectLoader::parse_corners(std::string_view record, std::vector<Corner>& out) {
+    switch (tokenizer_isa()) {
+#if TOKENIZER_X86
+    case TokenizerIsa::AVX2:
+        return simd_corners<classify_avx2>(record, out);
+    case TokenizerIsa::SSE42:
+        return simd_corners<classify_sse42>(record, out);
+#endif
+    default:
+        return scalar_corners(record.data(), record.data() + record.size(), out);
+    }
+}
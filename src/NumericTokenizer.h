@@ -0,0 +1,50 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace ObjectLoader {
+
+// One corner of an 'f' record. parse_corners() stores the raw OBJ indices (1-based, negative
+// for relative, 0 where the corner leaves one out), resolve_index() turns them into 0-based
+// ones with -1 for "not given" before a face reaches FaceStreams.
+struct Corner {
+    int32_t vertex   = -1;
+    int32_t texcoord = -1;
+    int32_t normal   = -1;
+};
+
+// Instruction sets the numeric tokenizer has an implementation for.
+enum class TokenizerIsa { Scalar, SSE42, AVX2 };
+
+// The best one this CPU runs, detected once.
+TokenizerIsa best_tokenizer_isa();
+// The one parse_floats()/parse_corners() use. Scalar unless changed: the records in .obj/.mtl
+// files are too short for the SIMD versions to win, see obj_bench --tokenizer.
+TokenizerIsa tokenizer_isa();
+// For benchmarks: anything the CPU does not support falls back to best_tokenizer_isa().
+void        set_tokenizer_isa(TokenizerIsa isa);
+const char* tokenizer_isa_name(TokenizerIsa isa);
+
+// Drop-in replacements for std::from_chars on one number: same value (bit for bit), same
+// end pointer and same error. The plain decimal forms found in .obj/.mtl files are converted
+// directly, everything else (exponents that do not fit, long mantissas, inf/nan, ...) is
+// handed to std::from_chars.
+std::from_chars_result parse_float(const char* first, const char* last, float& out);
+std::from_chars_result parse_index(const char* first, const char* last, int32_t& out);
+
+// Reads up to n whitespace separated floats from the start of record into out, the way
+// repeated parse_float() calls with the whitespace skipped in between would, and stops at the
+// first one that fails. Returns how many were read. The SIMD versions classify a record 64
+// bytes at a time and convert the digit runs of every token with a couple of multiply-adds,
+// all of them give the values parse_float() does.
+size_t parse_floats(std::string_view record, float* out, size_t n);
+
+// Appends the corners of the data of an 'f' record to out as raw OBJ indices (1-based,
+// negative for relative, 0 where a corner leaves one out), stopping at a '#' or at the first
+// token that does not start with an index. Returns how many were appended.
+size_t parse_corners(std::string_view record, std::vector<Corner>& out);
+
+} // namespace ObjectLoader
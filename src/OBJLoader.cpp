@@ -1,68 +1,61 @@
 #include "OBJLoader.h"
-#include "tiffio.h"
-#define STB_IMAGE_IMPLEMENTATION
-#include "GlMacros.h"
-#include "stb_image.h"
-#include <GL/glew.h>
-
-void ObjectLoader::OBJLoader::clear_cache() {
-  model_cache.clear();
-}
-
+#include <algorithm>
+#include <thread>
 
-std::shared_ptr<ObjectLoader::ModelData> ObjectLoader::OBJLoader::read_from_file(const std::string& filename) {
+std::shared_ptr<const ObjectLoader::ModelData>
+ObjectLoader::OBJLoader::read_from_file(const std::string& filename) {
 #ifdef DEBUG_OBJLOADER
     std::cout << "Reading .obj file from: " << filename << "\n";
 #endif
 
-    auto from_cache = model_cache.find(filename);
-    if (from_cache != model_cache.end()) {
-        std::cout << "Found it from cache\n";
-        return from_cache->second;
-    } else {
+    return model_cache.get_or_load(filename, [&] {
+#ifdef DEBUG_OBJLOADER
         std::cout << "Did not find it from cache, reading file normally\n";
-    }
+#endif
+        parse(filename);
+        ModelData parsed = std::move(model_data);
+        model_data       = ModelData{};
+        return parsed;
+    });
+}
 
-    std::ifstream in(filename);
-    if (!in.is_open()) {
-        throw std::runtime_error("Failed to open OBJ file: " + filename);
-    }
+size_t ObjectLoader::OBJLoader::parse(const std::string& filename) {
+    // throws if the file cannot be opened
+    MappedFile       file{filename};
+    std::string_view text = file.view();
 
 #ifdef DEBUG_OBJLOADER
-    std::cout << "File is open\n";
+    std::cout << "File is mapped (" << text.size() << " bytes)\n";
 #endif
-    std::string line;
+
+    if (text.size() >= PARALLEL_PARSE_MIN_BYTES) {
+        unsigned threads = parse_threads != 0 ? parse_threads : std::thread::hardware_concurrency();
+        size_t   chunks  = std::min<size_t>(threads, text.size() / PARALLEL_PARSE_MIN_CHUNK);
+        if (chunks > 1) {
+#ifdef DEBUG_OBJLOADER
+            std::cout << "Parsing in " << chunks << " chunks, per-record logging is skipped\n";
+#endif
+            parse_parallel(text, filename, chunks);
+            return text.size();
+        }
+    }
 
     int current_mat_id   = -1;
     int current_group_id = -1;
 
-    while (std::getline(in, line)) {
-
-        if (line.empty())
-            continue;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        std::string_view data;
+        LineType         type = next_record(text, pos, data);
 
-        // Convert line to c pointer
-        const char* p = line.c_str();
-        // skip any whitespaces
-        while (std::isspace(*p))
-            ++p;
-        // Mark the start of a keyword
-        const char* kw_start = p;
-        // find the end of keyword
-        while (*p && !std::isspace(*p))
-            ++p;
-        std::string_view keyword{kw_start, size_t(p - kw_start)};
-        // skip any spaces to get to data
-        while (*p && std::isspace(*p))
-            ++p;
-        switch (ObjectLoader::classify_line_type(keyword)) {
+        switch (type) {
         case LineType::Vertex:
 #ifdef DEBUG_OBJLOADER
         {
             std::cout << "Reading Vertex..." << std::endl;
         }
 #endif
-            read_vertex(p);
+            read_vertex(data);
             break;
         case LineType::Texcoord:
 #ifdef DEBUG_OBJLOADER
@@ -70,7 +63,7 @@ std::shared_ptr<ObjectLoader::ModelData> ObjectLoader::OBJLoader::read_from_file
             std::cout << "Reading TexCoord..." << std::endl;
         }
 #endif
-            read_texcoord(p);
+            read_texcoord(data);
             break;
         case LineType::Normal:
 #ifdef DEBUG_OBJLOADER
@@ -78,7 +71,7 @@ std::shared_ptr<ObjectLoader::ModelData> ObjectLoader::OBJLoader::read_from_file
             std::cout << "Reading Normal..." << std::endl;
         }
 #endif
-            read_normal(p);
+            read_normal(data);
             break;
         case LineType::Face:
 #ifdef DEBUG_OBJLOADER
@@ -86,7 +79,7 @@ std::shared_ptr<ObjectLoader::ModelData> ObjectLoader::OBJLoader::read_from_file
             std::cout << "Reading Face..." << std::endl;
         }
 #endif
-            read_faceLimited(p, current_mat_id, current_group_id);
+            read_face(data, current_mat_id, current_group_id);
             break;
         case LineType::Mtllib:
 #ifdef DEBUG_OBJLOADER
@@ -94,7 +87,7 @@ std::shared_ptr<ObjectLoader::ModelData> ObjectLoader::OBJLoader::read_from_file
             std::cout << "Reading MTL lib..." << std::endl;
         }
 #endif
-            read_mtllib(p, filename);
+            read_mtllib(data, filename);
             break;
         case LineType::Group:
 #ifdef DEBUG_OBJLOADER
@@ -102,7 +95,7 @@ std::shared_ptr<ObjectLoader::ModelData> ObjectLoader::OBJLoader::read_from_file
             std::cout << "Reading Group..." << std::endl;
         }
 #endif
-            add_new_group(p, current_group_id);
+            add_new_group(data, current_group_id);
             break;
         case LineType::Usemtl:
 #ifdef DEBUG_OBJLOADER
@@ -110,7 +103,7 @@ std::shared_ptr<ObjectLoader::ModelData> ObjectLoader::OBJLoader::read_from_file
             std::cout << "Reading Use MTL..." << std::endl;
         }
 #endif
-            read_usemtl(p, current_mat_id);
+            read_usemtl(data, current_mat_id);
             break;
         case LineType::Comment:
 #ifdef DEBUG_OBJLOADER
@@ -130,245 +123,449 @@ std::shared_ptr<ObjectLoader::ModelData> ObjectLoader::OBJLoader::read_from_file
         }
     }
 
-    this->load_textures();
-    auto shared_data = std::make_shared<ObjectLoader::ModelData>(model_data);
-    model_cache[filename] = shared_data;
-    return shared_data;
+    return text.size();
 }
 
-GLuint ObjectLoader::load_texture_from_tiff(const std::string& filename) {
-    TIFF* tif = TIFFOpen(filename.c_str(), "r");
-    if (!tif) {
-        std::cerr << "Failed to open TIFF: " << filename << "\n";
-
-        return 1;
+size_t ObjectLoader::OBJLoader::stream(const std::string& filename, const OBJVisitor& visitor) {
+    // throws if the file cannot be opened
+    MappedFile       file{filename};
+    std::string_view text = file.view();
+
+    // relative indices only need to know how many of each came before
+    size_t vertex_count = 0, texcoord_count = 0, normal_count = 0;
+    int    current_mat_id = -1, current_group_id = -1;
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        std::string_view data;
+        switch (next_record(text, pos, data)) {
+        case LineType::Vertex: {
+            glm::vec4 v;
+            if (!parse_vertex(data, v))
+                break;
+            ++vertex_count;
+            if (visitor.on_vertex)
+                visitor.on_vertex(v);
+            break;
+        }
+        case LineType::Texcoord: {
+            glm::vec2 v;
+            if (!parse_texcoord(data, v))
+                break;
+            ++texcoord_count;
+            if (visitor.on_texcoord)
+                visitor.on_texcoord(v);
+            break;
+        }
+        case LineType::Normal: {
+            glm::vec3 v;
+            if (!parse_normal(data, v))
+                break;
+            ++normal_count;
+            if (visitor.on_normal)
+                visitor.on_normal(v);
+            break;
+        }
+        case LineType::Face:
+            if (!visitor.on_face || parse_face(data, face_scratch) < 3)
+                break;
+            for (Corner& c : face_scratch) {
+                c.vertex   = resolve_index(c.vertex, vertex_count);
+                c.texcoord = resolve_index(c.texcoord, texcoord_count);
+                c.normal   = resolve_index(c.normal, normal_count);
+            }
+            visitor.on_face(face_scratch.data(), face_scratch.size());
+            break;
+        case LineType::Mtllib:
+            read_mtllib(data, filename);
+            break;
+        case LineType::Group:
+            add_new_group(data, current_group_id);
+            if (visitor.on_group)
+                visitor.on_group(first_token(data), current_group_id);
+            break;
+        case LineType::Usemtl:
+            read_usemtl(data, current_mat_id);
+            if (visitor.on_material)
+                visitor.on_material(first_token(data), current_mat_id);
+            break;
+        default:
+            break;
+        }
     }
+    return text.size();
+}
 
-    uint32_t width, height;
-    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
-    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+// Output of one worker: the records of a newline-aligned slice of the file.
+// Face runs refer to the chunk-local event that was active when they started
+// (an index into events, -1 meaning "whatever the previous chunk ended on"), the events
+// themselves are resolved serially once every chunk is done.
+// Corner indices are chunk-local too: face_offsets start at 0 and the corners listed in
+// relative_* used negative OBJ indices, so they still need the vertices of earlier chunks
+// added to them.
+struct ObjectLoader::OBJLoader::ParsedChunk {
+    struct Event {
+        LineType         type;
+        std::string_view data;
+    };
 
-    std::vector<uint32_t> raster(width * height);
-    if (!TIFFReadRGBAImage(tif, width, height, raster.data(), 0)) {
-        std::cerr << "Failed to read TIFF image data from: " << filename << "\n";
-        TIFFClose(tif);
-        return 2;
-    }
+    struct Run {
+        uint32_t first_face;
+        int      usemtl_event;
+        int      group_event;
+    };
 
-    // TIFF is bottom-up; reverse vertically if needed
-    std::vector<uint8_t> data(width * height * 4);
-    for (size_t y = 0; y < height; ++y) {
-        for (size_t x = 0; x < width; ++x) {
-            uint32_t pixel                = raster[(height - 1 - y) * width + x];
-            data[4 * (y * width + x) + 0] = TIFFGetR(pixel);
-            data[4 * (y * width + x) + 1] = TIFFGetG(pixel);
-            data[4 * (y * width + x) + 2] = TIFFGetB(pixel);
-            data[4 * (y * width + x) + 3] = TIFFGetA(pixel);
-        }
+    std::vector<glm::vec4> vertices;
+    std::vector<glm::vec2> texcoords;
+    std::vector<glm::vec3> normals;
+    FaceStreams            faces;
+    std::vector<Run>       runs;
+    std::vector<uint32_t>  relative_vertices;
+    std::vector<uint32_t>  relative_texcoords;
+    std::vector<uint32_t>  relative_normals;
+    std::vector<Event>     events;
+};
+
+bool ObjectLoader::FaceStreams::add_face(const Corner* corners, size_t count) {
+    if (count < 3)
+        return false;
+
+    const size_t first         = corner_vertices.size();
+    bool         has_texcoords = false, has_normals = false;
+    for (size_t i = 0; i < count; ++i) {
+        has_texcoords |= corners[i].texcoord >= 0;
+        has_normals |= corners[i].normal >= 0;
     }
-
-    GLuint tex;
-    GLCall(glGenTextures(1, &tex));
-    GLCall(glBindTexture(GL_TEXTURE_2D, tex));
-    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                        data.data()));
-    GLCall(glGenerateMipmap(GL_TEXTURE_2D));
-
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-    GLCall(glBindTexture(GL_TEXTURE_2D, 0));
-
-    TIFFClose(tif);
-    return tex;
+    // the optional streams only appear once some corner needs them
+    const bool with_texcoords = has_texcoords || !corner_texcoords.empty();
+    const bool with_normals   = has_normals || !corner_normals.empty();
+    if (with_texcoords)
+        corner_texcoords.resize(first, -1);
+    if (with_normals)
+        corner_normals.resize(first, -1);
+
+    face_offsets.push_back(static_cast<uint32_t>(first));
+    for (size_t i = 0; i < count; ++i) {
+        corner_vertices.push_back(corners[i].vertex);
+        if (with_texcoords)
+            corner_texcoords.push_back(corners[i].texcoord);
+        if (with_normals)
+            corner_normals.push_back(corners[i].normal);
+    }
+    return true;
 }
 
-bool fileExtensionIs(const std::string& filename, const std::string& extension) {
-    auto pos = filename.rfind(extension);
-
-    if (pos != std::string::npos && (filename.substr(pos, filename.size()) == extension))
-        return true;
+void ObjectLoader::OBJLoader::parse_chunk(std::string_view text, ParsedChunk& out) {
+    struct RelativeIndex {
+        std::vector<int32_t>* stream;
+        uint32_t              corner;
+        int32_t               index;
+    };
 
-    return false;
+    int                        last_usemtl = -1;
+    int                        last_group  = -1;
+    std::vector<Corner>        corners;
+    std::vector<RelativeIndex> relative;
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        std::string_view data;
+        switch (next_record(text, pos, data)) {
+        case LineType::Vertex: {
+            glm::vec4 v;
+            if (parse_vertex(data, v))
+                out.vertices.push_back(v);
+            break;
+        }
+        case LineType::Texcoord: {
+            glm::vec2 vt;
+            if (parse_texcoord(data, vt))
+                out.texcoords.push_back(vt);
+            break;
+        }
+        case LineType::Normal: {
+            glm::vec3 vn;
+            if (parse_normal(data, vn))
+                out.normals.push_back(vn);
+            break;
+        }
+        case LineType::Face: {
+            if (parse_face(data, corners) < 3)
+                break;
+            // relative indices are resolved against this chunk only, remember which corners
+            // need rebasing once the earlier chunks are counted. They go into add_face() as a
+            // placeholder (so the stream they belong to is kept) and are written over after.
+            const uint32_t first = static_cast<uint32_t>(out.faces.corner_count());
+            relative.clear();
+            auto local = [&](int32_t& index, size_t count, std::vector<int32_t>& stream,
+                             std::vector<uint32_t>& rebase, size_t corner) {
+                if (index >= 0) {
+                    index -= 1;
+                    return;
+                }
+                rebase.push_back(first + static_cast<uint32_t>(corner));
+                relative.push_back({&stream, rebase.back(), static_cast<int32_t>(count) + index});
+                index = 0;
+            };
+            for (size_t k = 0; k < corners.size(); ++k) {
+                Corner& c = corners[k];
+                local(c.vertex, out.vertices.size(), out.faces.corner_vertices,
+                      out.relative_vertices, k);
+                local(c.texcoord, out.texcoords.size(), out.faces.corner_texcoords,
+                      out.relative_texcoords, k);
+                local(c.normal, out.normals.size(), out.faces.corner_normals,
+                      out.relative_normals, k);
+            }
+            out.faces.add_face(corners.data(), corners.size());
+            for (const auto& r : relative)
+                (*r.stream)[r.corner] = r.index;
+
+            if (out.runs.empty() || out.runs.back().usemtl_event != last_usemtl ||
+                out.runs.back().group_event != last_group) {
+                out.runs.push_back({static_cast<uint32_t>(out.faces.face_count() - 1),
+                                    last_usemtl, last_group});
+            }
+            break;
+        }
+        case LineType::Usemtl:
+            last_usemtl = static_cast<int>(out.events.size());
+            out.events.push_back({LineType::Usemtl, data});
+            break;
+        case LineType::Group:
+            last_group = static_cast<int>(out.events.size());
+            out.events.push_back({LineType::Group, data});
+            break;
+        case LineType::Mtllib:
+            out.events.push_back({LineType::Mtllib, data});
+            break;
+        default:
+            break;
+        }
+    }
 }
 
-GLuint ObjectLoader::load_texture_from_file(const std::string& filepath) {
-    if (fileExtensionIs(filepath, ".tif")) {
-        return load_texture_from_tiff(filepath);
+void ObjectLoader::OBJLoader::parse_parallel(std::string_view text, const std::string& filename,
+                                             size_t chunk_count) {
+    // cut the file at the first newline after each even split point so no record straddles
+    // two chunks
+    std::vector<size_t> bounds(chunk_count + 1, text.size());
+    bounds[0] = 0;
+    for (size_t i = 1; i < chunk_count; ++i) {
+        size_t cut = std::max(bounds[i - 1], text.size() / chunk_count * i);
+        size_t eol = text.find('\n', cut);
+        bounds[i]  = eol == std::string_view::npos ? text.size() : eol + 1;
     }
-    int width, height, channels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(filepath.c_str(), &width, &height, &channels, 0);
 
-    if (!data) {
-        std::cerr << "Failed to load texture " << filepath << "\n";
-        return 0;
+    std::vector<ParsedChunk> chunks(chunk_count);
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(chunk_count - 1);
+        for (size_t i = 1; i < chunk_count; ++i) {
+            workers.emplace_back([&, i]() {
+                parse_chunk(text.substr(bounds[i], bounds[i + 1] - bounds[i]), chunks[i]);
+            });
+        }
+        parse_chunk(text.substr(0, bounds[1]), chunks[0]);
+        for (auto& worker : workers)
+            worker.join();
     }
 
-    GLenum format = (channels == 4) ? GL_RGBA : GL_RGB;
-    GLuint texture_id;
-    GLCall(glGenTextures(1, &texture_id));
-    GLCall(glBindTexture(GL_TEXTURE_2D, texture_id));
-    GLCall(
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data));
-    GLCall(glGenerateMipmap(GL_TEXTURE_2D));
-
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
-    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-    GLCall(glBindTexture(GL_TEXTURE_2D, 0));
-    stbi_image_free(data);
-
-    return texture_id;
-}
-
-void ObjectLoader::OBJLoader::load_textures() {
-    std::cout << "Now preparing materials\n";
-    for (auto& material : model_data.m_materials) {
-        if (!material.map_Kd.empty()) {
-            GLuint id = load_texture_from_file(material.map_Kd);
-#ifdef DEBUG_OBJLOADER
-            std::cout << "Loaded map_Kd: " << material.map_Kd << " → ID " << id << std::endl;
-#endif
-            material.tex_Kd = id; // if you add it
+    // Replay mtllib/usemtl/g in file order so material and group ids come out exactly as the
+    // serial parser assigns them, and remember what state each chunk starts in.
+    std::vector<std::vector<int>> resolved(chunk_count);
+    std::vector<int>              start_mat(chunk_count), start_group(chunk_count);
+    int                           current_mat_id   = -1;
+    int                           current_group_id = -1;
+    for (size_t i = 0; i < chunk_count; ++i) {
+        start_mat[i]   = current_mat_id;
+        start_group[i] = current_group_id;
+        resolved[i].resize(chunks[i].events.size(), -1);
+        for (size_t e = 0; e < chunks[i].events.size(); ++e) {
+            const auto& event = chunks[i].events[e];
+            if (event.type == LineType::Mtllib) {
+                read_mtllib(event.data, filename);
+            } else if (event.type == LineType::Usemtl) {
+                read_usemtl(event.data, current_mat_id);
+                resolved[i][e] = current_mat_id;
+            } else if (event.type == LineType::Group) {
+                add_new_group(event.data, current_group_id);
+                resolved[i][e] = current_group_id;
+            }
         }
+    }
 
-        if (!material.map_Ka.empty()) {
-            GLuint id = load_texture_from_file(material.map_Ka);
-#ifdef DEBUG_OBJLOADER
-            std::cout << "Loaded map_Ka: " << material.map_Ka << " → ID " << id << std::endl;
-#endif
-            material.tex_Ka = id;
+    // face runs in file order, merging neighbours that resolve to the same state exactly like
+    // read_face() does
+    std::vector<FaceRun>& runs      = model_data.m_face_runs;
+    size_t                face_base = model_data.m_faces.face_count();
+    for (size_t i = 0; i < chunk_count; ++i) {
+        for (const auto& run : chunks[i].runs) {
+            int mat   = run.usemtl_event < 0 ? start_mat[i] : resolved[i][run.usemtl_event];
+            int group = run.group_event < 0 ? start_group[i] : resolved[i][run.group_event];
+            if (runs.empty() || runs.back().material_id != mat || runs.back().group_id != group)
+                runs.push_back({static_cast<uint32_t>(face_base + run.first_face), mat, group});
         }
+        face_base += chunks[i].faces.face_count();
+    }
 
-        if (!material.map_Ks.empty()) {
-            GLuint id = load_texture_from_file(material.map_Ks);
-#ifdef DEBUG_OBJLOADER
-            std::cout << "Loaded map_Ks: " << material.map_Ks << " → ID " << id << std::endl;
-#endif
-            material.tex_Ks = id;
+    // prefix sums give every chunk its slot in the final arrays
+    struct Offsets {
+        size_t v, vt, vn, f, c;
+    };
+    FaceStreams&         faces = model_data.m_faces;
+    std::vector<Offsets> offsets(chunk_count + 1);
+    offsets[0] = {model_data.m_vertices.size(), model_data.m_texture_coords.size(),
+                  model_data.m_vertex_normals.size(), faces.face_count(), faces.corner_count()};
+    bool any_texcoords = !faces.corner_texcoords.empty();
+    bool any_normals   = !faces.corner_normals.empty();
+    for (size_t i = 0; i < chunk_count; ++i) {
+        offsets[i + 1] = {offsets[i].v + chunks[i].vertices.size(),
+                          offsets[i].vt + chunks[i].texcoords.size(),
+                          offsets[i].vn + chunks[i].normals.size(),
+                          offsets[i].f + chunks[i].faces.face_count(),
+                          offsets[i].c + chunks[i].faces.corner_count()};
+        any_texcoords |= !chunks[i].faces.corner_texcoords.empty();
+        any_normals |= !chunks[i].faces.corner_normals.empty();
+    }
+    model_data.m_vertices.resize(offsets[chunk_count].v);
+    model_data.m_texture_coords.resize(offsets[chunk_count].vt);
+    model_data.m_vertex_normals.resize(offsets[chunk_count].vn);
+    faces.face_offsets.resize(offsets[chunk_count].f);
+    faces.corner_vertices.resize(offsets[chunk_count].c);
+    // corners that came before the stream existed (or from chunks without it) get -1
+    if (any_texcoords)
+        faces.corner_texcoords.resize(offsets[chunk_count].c, -1);
+    if (any_normals)
+        faces.corner_normals.resize(offsets[chunk_count].c, -1);
+
+    // copies a chunk's corner stream into place, adding base to the relative indices
+    auto place_corners = [](const std::vector<int32_t>& src, const std::vector<uint32_t>& relative,
+                            size_t base, int32_t* dst) {
+        std::copy(src.begin(), src.end(), dst);
+        for (uint32_t corner : relative) {
+            int32_t index = dst[corner] + static_cast<int32_t>(base);
+            dst[corner]   = index < 0 ? -1 : index;
         }
+    };
 
-        if (!material.map_Bump.empty() && material.map_Bump != material.map_Kd) {
-            // only load a bump map if it's a different file from the diffuse
-            GLuint id             = load_texture_from_file(material.map_Bump);
-            material.tex_Bump     = id;
-            material.use_bump_map = true;
-        } else {
-            // either no bump entry, or they're re-using the diffuse as bump: disable it
-            material.use_bump_map = false;
-        }
-    }
+    auto scatter = [&](size_t i) {
+        const ParsedChunk& chunk = chunks[i];
+        const Offsets&     off   = offsets[i];
+        std::copy(chunk.vertices.begin(), chunk.vertices.end(),
+                  model_data.m_vertices.begin() + off.v);
+        std::copy(chunk.texcoords.begin(), chunk.texcoords.end(),
+                  model_data.m_texture_coords.begin() + off.vt);
+        std::copy(chunk.normals.begin(), chunk.normals.end(),
+                  model_data.m_vertex_normals.begin() + off.vn);
+
+        place_corners(chunk.faces.corner_vertices, chunk.relative_vertices, off.v,
+                      faces.corner_vertices.data() + off.c);
+        if (!chunk.faces.corner_texcoords.empty())
+            place_corners(chunk.faces.corner_texcoords, chunk.relative_texcoords, off.vt,
+                          faces.corner_texcoords.data() + off.c);
+        if (!chunk.faces.corner_normals.empty())
+            place_corners(chunk.faces.corner_normals, chunk.relative_normals, off.vn,
+                          faces.corner_normals.data() + off.c);
+
+        uint32_t* dst = faces.face_offsets.data() + off.f;
+        for (uint32_t first : chunk.faces.face_offsets)
+            *dst++ = first + static_cast<uint32_t>(off.c);
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunk_count - 1);
+    for (size_t i = 1; i < chunk_count; ++i)
+        workers.emplace_back(scatter, i);
+    scatter(0);
+    for (auto& worker : workers)
+        worker.join();
 }
 
-void ObjectLoader::OBJLoader::read_normal(const char* buff) {
+bool ObjectLoader::OBJLoader::parse_normal(std::string_view data, glm::vec3& out) {
     float tmp[3];
-    if (!parse_components<3>(buff, tmp))
+    if (!parse_components_sv<3>(data, tmp))
+        return false;
+    out = glm::vec3{tmp[0], tmp[1], tmp[2]};
+    return true;
+}
+
+bool ObjectLoader::OBJLoader::parse_texcoord(std::string_view data, glm::vec2& out) {
+    float tmp[2];
+    if (!parse_components_sv<2>(data, tmp))
+        return false;
+    out = glm::vec2{tmp[0], tmp[1]};
+    return true;
+}
+
+bool ObjectLoader::OBJLoader::parse_vertex(std::string_view data, glm::vec4& out) {
+    float tmp[4];
+    if (!parse_components_sv<4>(data, tmp))
+        return false;
+    out = glm::vec4{tmp[0], tmp[1], tmp[2], tmp[3]};
+    return true;
+}
+
+size_t ObjectLoader::OBJLoader::parse_face(std::string_view data, std::vector<Corner>& out) {
+    out.clear();
+    return parse_corners(data, out);
+}
+
+void ObjectLoader::OBJLoader::read_normal(std::string_view data) {
+    glm::vec3 v;
+    if (!parse_normal(data, v))
         return;
-    glm::vec3 v{tmp[0], tmp[1], tmp[2]};
 #ifdef DEBUG_OBJLOADER
     print_glmvec3(v);
 #endif
-    // m_vertex_normals.push_back(v);
     model_data.m_vertex_normals.push_back(v);
 }
 
-void ObjectLoader::OBJLoader::read_texcoord(const char* buff) {
-    float tmp[2];
-    if (!parse_components<2>(buff, tmp))
+void ObjectLoader::OBJLoader::read_texcoord(std::string_view data) {
+    glm::vec2 v;
+    if (!parse_texcoord(data, v))
         return;
-    glm::vec2 v{tmp[0], tmp[1]};
 #ifdef DEBUG_OBJLOADER
     print_glmvec2(glm::vec2{v.x, v.y});
 #endif
-    // m_texture_coords.push_back(v);
     model_data.m_texture_coords.push_back(v);
 }
 
-void ObjectLoader::OBJLoader::read_vertex(const char* buff) {
-    float tmp[4];
-    if (!parse_components<4>(buff, tmp))
+void ObjectLoader::OBJLoader::read_vertex(std::string_view data) {
+    glm::vec4 v;
+    if (!parse_vertex(data, v))
         return;
-    glm::vec4 v{tmp[0], tmp[1], tmp[2], tmp[3]};
 #ifdef DEBUG_OBJLOADER
     print_glmvec4(v);
 #endif
     model_data.m_vertices.push_back(v);
 }
 
-void ObjectLoader::OBJLoader::read_faceLimited(const char* buff, int current_mat_id,
-                                               int current_group_id) {
-    // Prepare arrays, defaulting everything to -1
-    glm::ivec4 vIdx(-1), tIdx(-1), nIdx(-1);
-
-    const char* p    = buff;
-    const char* end  = buff + std::strlen(buff);
-    int         slot = 0;
-
-    // Parse up to 4 vertex/texcoord/normal groups
-    while (slot < 4 && p < end && !std::isspace(*p)) {
-        // 1) parse vertex index
-        int vi;
-        auto [p1, ec1] = std::from_chars(p, end, vi);
-        if (ec1 != std::errc())
-            break;
-        vIdx[slot] = vi - 1; // OBJ is 1-based
-
-        p = p1;
-        // 2) if there's a slash, maybe parse vt and/or vn
-        if (p < end && *p == '/') {
-            ++p;
-            // if next also '/', then it's v//vn
-            if (p < end && *p == '/') {
-                ++p;
-                int ni;
-                auto [p2, ec2] = std::from_chars(p, end, ni);
-                if (ec2 == std::errc())
-                    nIdx[slot] = ni - 1;
-                p = p2;
-            } else {
-                // v/vt[/vn]
-                int ti;
-                auto [p2, ec2] = std::from_chars(p, end, ti);
-                if (ec2 == std::errc())
-                    tIdx[slot] = ti - 1;
-                p = p2;
-                // now maybe "/vn"
-                if (p < end && *p == '/') {
-                    ++p;
-                    int ni;
-                    auto [p3, ec3] = std::from_chars(p, end, ni);
-                    if (ec3 == std::errc())
-                        nIdx[slot] = ni - 1;
-                    p = p3;
-                }
-            }
-        }
-
-        // 3) skip any whitespace before next
-        while (p < end && std::isspace(*p))
-            ++p;
-        ++slot;
+void ObjectLoader::OBJLoader::read_face(std::string_view data, int current_mat_id,
+                                        int current_group_id) {
+    [[maybe_unused]] size_t count = parse_face(data, face_scratch);
+    for (Corner& c : face_scratch) {
+        c.vertex   = resolve_index(c.vertex, model_data.m_vertices.size());
+        c.texcoord = resolve_index(c.texcoord, model_data.m_texture_coords.size());
+        c.normal   = resolve_index(c.normal, model_data.m_vertex_normals.size());
     }
 
-    Face f;
-    f.vertices  = vIdx;
-    f.texcoords = tIdx;
-    f.normals   = nIdx;
-
-    f.material_id = current_mat_id;
-    f.group_id    = current_group_id;
-
 #ifdef DEBUG_OBJLOADER
-    std::cout << "Parsed face slot count: " << slot << "\n";
-    std::cout << "  verts: " << vIdx.x << "," << vIdx.y << "," << vIdx.z << "," << vIdx.w << "\n";
-    std::cout << "  tcs:   " << tIdx.x << "," << tIdx.y << "," << tIdx.z << "," << tIdx.w << "\n";
-    std::cout << "  norms: " << nIdx.x << "," << nIdx.y << "," << nIdx.z << "," << nIdx.w << "\n";
+    std::cout << "Parsed face corner count: " << count << "\n";
+    for (const Corner& c : face_scratch) {
+        std::cout << "  v/vt/vn: " << c.vertex << "/" << c.texcoord << "/" << c.normal << "\n";
+    }
 #endif
 
-    model_data.m_faces.push_back(f);
+    FaceStreams& faces = model_data.m_faces;
+    if (!faces.add_face(face_scratch.data(), face_scratch.size()))
+        return;
+
+    auto& runs = model_data.m_face_runs;
+    if (runs.empty() || runs.back().material_id != current_mat_id ||
+        runs.back().group_id != current_group_id) {
+        runs.push_back(
+            {static_cast<uint32_t>(faces.face_count() - 1), current_mat_id, current_group_id});
+    }
 }
 
 void ObjectLoader::OBJLoader::debug_dump() const {
@@ -396,27 +593,18 @@ void ObjectLoader::OBJLoader::debug_dump() const {
         std::cout << " [" << i << "] '" << model_data.m_groups[i] << "'\n";
     }
 
-    // std::cout << "Faces (" << model_data.m_faces.size() << "):\n";
-    // for (size_t i = 0; i < model_data.m_faces.size(); ++i) {
-    //   auto const& F = model_data.m_faces[i];
-    //   std::cout << " ["<<i<<"] mat="<<F.material_id
-    //             << " grp="<<F.group_id
-    //             << " verts=("
-    //                <<F.vertices.x<<","<<F.vertices.y<<","<<F.vertices.z<<","<<F.vertices.w<<")\n";
+    // std::cout << "Faces (" << model_data.m_faces.face_count() << "):\n";
+    // for (size_t i = 0; i < model_data.m_faces.face_count(); ++i) {
+    //   std::cout << " ["<<i<<"] verts=(";
+    //   for (uint32_t c = model_data.m_faces.face_begin(i); c < model_data.m_faces.face_end(i); ++c)
+    //     std::cout << model_data.m_faces.corner_vertices[c] << ",";
+    //   std::cout << ")\n";
     // }
     std::cout << "======================\n\n";
 }
 
-void ObjectLoader::OBJLoader::read_usemtl(const char* buff, int& current_mat_id) {
-    const char* p = buff;
-    while (*p && std::isspace(*p))
-        ++p;
-
-    const char* q = p;
-    while (*q && !std::isspace(*q) && *q != '#')
-        ++q;
-
-    std::string name{p, size_t(q - p)};
+void ObjectLoader::OBJLoader::read_usemtl(std::string_view data, int& current_mat_id) {
+    std::string name{first_token(data)};
     auto        it = model_data.m_mat_name_to_id.find(name);
     if (it != model_data.m_mat_name_to_id.end()) {
         current_mat_id = it->second;
@@ -425,29 +613,21 @@ void ObjectLoader::OBJLoader::read_usemtl(const char* buff, int& current_mat_id)
     }
 }
 
-void ObjectLoader::OBJLoader::read_mtllib(const char* buff, const std::string& obj_filename) {
-    const char* p = buff;
-    while (*p && std::isspace(*p))
-        ++p;
-    const char* q = p;
-    while (*q && !std::isspace(*q) && *q != '#')
-        ++q;
-    std::string mtl_name{p, size_t(q - p)};
+void ObjectLoader::OBJLoader::read_mtllib(std::string_view data, const std::string& obj_filename) {
+    std::string mtl_name{first_token(data)};
 
     auto        slash = obj_filename.find_last_of("/\\");
     std::string dir   = (slash == std::string::npos ? "" : obj_filename.substr(0, slash + 1));
     std::string path  = dir + mtl_name;
+    model_data.m_mtllibs.push_back(path);
 
-    std::ifstream file{path, std::ios::binary};
-    if (!file) {
+    std::unique_ptr<MappedFile> file;
+    try {
+        file = std::make_unique<MappedFile>(path);
+    } catch (const std::runtime_error&) {
         std::cerr << "Failed to open MTL: " << path << "\n";
         return;
     }
-    file.seekg(0, std::ios::end);
-    size_t      sz = file.tellg();
-    std::string contents(sz, '\0');
-    file.seekg(0);
-    file.read(contents.data(), sz);
 
     Material current_mat;
     auto     commit_mat = [&]() {
@@ -459,21 +639,19 @@ void ObjectLoader::OBJLoader::read_mtllib(const char* buff, const std::string& o
         }
     };
 
-    std::string_view view{contents};
-    size_t           pos = 0;
+    std::string_view view = file->view();
+    size_t           pos  = 0;
     while (pos < view.size()) {
-        size_t eol = view.find_first_of("\r\n", pos);
-        auto line = view.substr(pos, eol == std::string_view::npos ? view.size() - pos : eol - pos);
-        pos = (eol == std::string_view::npos ? view.size() : view.find_first_not_of("\r\n", eol));
+        auto line = next_line(view, pos);
 
         size_t i = 0;
-        while (i < line.size() && std::isspace(line[i]))
+        while (i < line.size() && is_space(line[i]))
             ++i;
         if (i >= line.size() || line[i] == '#')
             continue;
 
         size_t key_end = i;
-        while (key_end < line.size() && !std::isspace(line[key_end]))
+        while (key_end < line.size() && !is_space(line[key_end]))
             ++key_end;
         std::string_view key  = line.substr(i, key_end - i);
         size_t           dpos = line.find_first_not_of(" \t", key_end);
@@ -530,16 +708,8 @@ void ObjectLoader::OBJLoader::read_mtllib(const char* buff, const std::string& o
     commit_mat();
 }
 
-void ObjectLoader::OBJLoader::add_new_group(const char* buff, int& current_group_id) {
-    const char* p = buff;
-    while (*p && std::isspace(*p))
-        ++p;
-
-    const char* q = p;
-    while (*q && !std::isspace(*q) && *q != '#')
-        ++q;
-
-    std::string name{p, size_t(q - p)};
+void ObjectLoader::OBJLoader::add_new_group(std::string_view data, int& current_group_id) {
+    std::string name{first_token(data)};
     auto        it = model_data.m_group_name_to_id.find(name);
     if (it == model_data.m_group_name_to_id.end()) {
         int id = model_data.m_groups.size();
@@ -1,11 +1,15 @@
 
 #pragma once
-#include "GlMacros.h"
+#include "AssetRegistry.h"
+#include "MappedFile.h"
 #include "Material.h"
+#include "NumericTokenizer.h"
 #include <cctype>
 #include <charconv>
+#include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -13,6 +17,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #ifndef DEBUG_OBJLOADER
@@ -20,29 +25,112 @@
 #endif
 
 namespace ObjectLoader {
-using namespace GlHelpers;
-
-GLuint load_texture_from_tiff(const std::string& filename);
-GLuint load_texture_from_file(const std::string& filepath);
-struct Face {
-    glm::ivec4 vertices;
-    glm::ivec4 normals;
-    glm::ivec4 texcoords;
-    int        material_id = -1;
-    int        group_id    = -1;
+
+// Bump whenever the parsed ModelData changes for the same input, on-disk mesh caches
+// built by an older loader are then rebuilt.
+constexpr uint32_t LOADER_VERSION = 2;
+
+// Every face of a file as flat index streams rather than one fixed size struct per face.
+// Corner c uses vertex corner_vertices[c] and, when the file has any, texcoord
+// corner_texcoords[c] and normal corner_normals[c] (-1 where that corner has none). The
+// texcoord and normal streams stay empty for files that never use them.
+// Face f owns the corners [face_begin(f), face_end(f)). Polygons of any size are kept whole
+// and fanned around their first corner by for_each_triangle(), which is how the loader
+// triangulates them.
+struct FaceStreams {
+    std::vector<int32_t>  corner_vertices;
+    std::vector<int32_t>  corner_texcoords;
+    std::vector<int32_t>  corner_normals;
+    std::vector<uint32_t> face_offsets; // first corner of every face
+
+    inline size_t face_count() const {
+        return face_offsets.size();
+    }
+
+    inline size_t corner_count() const {
+        return corner_vertices.size();
+    }
+
+    inline uint32_t face_begin(size_t face) const {
+        return face_offsets[face];
+    }
+
+    inline uint32_t face_end(size_t face) const {
+        return face + 1 < face_offsets.size() ? face_offsets[face + 1]
+                                              : static_cast<uint32_t>(corner_vertices.size());
+    }
+
+    inline int32_t texcoord(size_t corner) const {
+        return corner_texcoords.empty() ? -1 : corner_texcoords[corner];
+    }
+
+    inline int32_t normal(size_t corner) const {
+        return corner_normals.empty() ? -1 : corner_normals[corner];
+    }
+
+    // Calls fn(c0, c1, c2) with the corner indices of each triangle of face
+    template <typename Fn> void for_each_triangle(size_t face, Fn&& fn) const {
+        const uint32_t begin = face_begin(face);
+        const uint32_t end   = face_end(face);
+        for (uint32_t c = begin + 1; c + 1 < end; ++c) {
+            fn(begin, c, c + 1);
+        }
+    }
+
+    inline size_t triangle_count() const {
+        // every face of n corners gives n - 2 triangles
+        return corner_count() - 2 * face_count();
+    }
+
+    // Appends a face, faces with fewer than 3 corners are dropped. Returns whether it was added.
+    bool add_face(const Corner* corners, size_t count);
+
+    inline size_t bytes() const {
+        return (corner_vertices.capacity() + corner_texcoords.capacity() +
+                corner_normals.capacity()) *
+                   sizeof(int32_t) +
+               face_offsets.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Material and group in effect from face first_face up to the next run's first_face.
+struct FaceRun {
+    uint32_t first_face  = 0;
+    int      material_id = -1;
+    int      group_id    = -1;
 };
 
 struct ModelData {
     std::vector<glm::vec4> m_vertices;
     std::vector<glm::vec2> m_texture_coords;
     std::vector<glm::vec3> m_vertex_normals;
-    std::vector<Face>      m_faces;
+    FaceStreams            m_faces;
+    std::vector<FaceRun>   m_face_runs;
 
     std::vector<Material>                m_materials;
     std::unordered_map<std::string, int> m_mat_name_to_id;
 
     std::vector<std::string>             m_groups;
     std::unordered_map<std::string, int> m_group_name_to_id;
+
+    // resolved paths of every mtllib the file referenced, found or not
+    std::vector<std::string> m_mtllibs;
+
+    // first face of run, up to the end of run
+    inline size_t run_end(size_t run) const {
+        return run + 1 < m_face_runs.size() ? m_face_runs[run + 1].first_face
+                                            : m_faces.face_count();
+    }
+
+    // approximate heap footprint, what the asset cache budgets against
+    inline size_t bytes() const {
+        return sizeof(ModelData) + m_vertices.capacity() * sizeof(glm::vec4) +
+               m_texture_coords.capacity() * sizeof(glm::vec2) +
+               m_vertex_normals.capacity() * sizeof(glm::vec3) + m_faces.bytes() +
+               m_face_runs.capacity() * sizeof(FaceRun) +
+               m_materials.capacity() * sizeof(Material) +
+               m_groups.capacity() * sizeof(std::string);
+    }
 };
 
 enum class LineType { Vertex, Texcoord, Normal, Face, Mtllib, Usemtl, Group, Comment, Unknown };
@@ -70,69 +158,139 @@ inline LineType classify_line_type(std::string_view kw) {
         return LineType::Unknown;
 }
 
-// Parse exactly N floats from buff into out[0..N-1].
-// Missing trailing floats will be zeroed.
-template <int N>
-bool parse_components(const char* buff, float out[N]) {
-    const char* end = buff + std::strlen(buff);
-    const char* p   = buff;
-    for (int i = 0; i < N; ++i) {
-        // parse next float
-        auto [next, ec] = std::from_chars(p, end, out[i]);
-        if (ec != std::errc()) {
-            // if the very first float failed, give up entirely
-            if (i == 0)
-                return false;
-            // otherwise assume the rest are missing → zero them
-            for (++i; i < N; ++i)
-                out[i] = 0.f;
-            return true;
-        }
-        // skip whitespace before the next read
-        p = next;
-        while (p < end && std::isspace(*p))
-            ++p;
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+// Drops leading whitespace from sv
+inline std::string_view skip_spaces(std::string_view sv) {
+    size_t i = 0;
+    while (i < sv.size() && is_space(sv[i]))
+        ++i;
+    return sv.substr(i);
+}
+
+// Returns the first whitespace/comment delimited token of sv (used for names)
+inline std::string_view first_token(std::string_view sv) {
+    sv       = skip_spaces(sv);
+    size_t i = 0;
+    while (i < sv.size() && !is_space(sv[i]) && sv[i] != '#')
+        ++i;
+    return sv.substr(0, i);
+}
+
+// Reads the record starting at pos, advancing pos past it.
+// data receives everything after the keyword; blank lines come back as Comment.
+inline LineType next_record(std::string_view text, size_t& pos, std::string_view& data) {
+    std::string_view line = skip_spaces(next_line(text, pos));
+    if (line.empty()) {
+        data = {};
+        return LineType::Comment;
     }
-    return true;
+    // find the end of keyword
+    size_t kw_end = 0;
+    while (kw_end < line.size() && !is_space(line[kw_end]))
+        ++kw_end;
+    // skip any spaces to get to data
+    data = skip_spaces(line.substr(kw_end));
+    return classify_line_type(line.substr(0, kw_end));
 }
 
+// Turns a raw OBJ index into a 0-based one given how many elements were defined before it.
+// Negative indices count back from the last one, 0 and anything out of range give -1.
+inline int32_t resolve_index(int32_t raw, size_t count) {
+    if (raw > 0)
+        return static_cast<size_t>(raw) <= count ? raw - 1 : -1;
+    if (raw < 0 && static_cast<size_t>(-static_cast<int64_t>(raw)) <= count)
+        return static_cast<int32_t>(count) + raw;
+    return -1;
+}
+
+// Parse exactly N floats from sv into out[0..N-1].
+// Missing trailing floats will be zeroed.
+// Never reads past the end of sv, so it works directly over mapped file bytes.
 template <int N>
 bool parse_components_sv(std::string_view sv, float out[N]) {
-    const char* ptr = sv.data();
-    const char* end = ptr + sv.size();
-    for (int i = 0; i < N; ++i) {
-        auto [next, ec] = std::from_chars(ptr, end, out[i]);
-        if (ec != std::errc()) {
-            if (i == 0)
-                return false;
-            for (++i; i < N; ++i)
-                out[i] = 0.f;
-            return true;
-        }
-        ptr = next;
-        while (ptr < end && std::isspace(*ptr))
-            ++ptr;
-    }
+    size_t count = parse_floats(sv, out, N);
+    // if the very first float failed, give up entirely
+    if (count == 0)
+        return false;
+    // otherwise assume the rest are missing → zero them
+    for (size_t i = count; i < N; ++i)
+        out[i] = 0.f;
     return true;
 }
 
+// Handlers OBJLoader::stream() calls in file order, unset ones are skipped.
+// Faces come with their corners resolved to 0-based indices (-1 where a corner has none) and
+// fewer than 3 corners are dropped, like in a parse(). The corner pointer is only valid during
+// the call.
+struct OBJVisitor {
+    std::function<void(const glm::vec4&)>            on_vertex;
+    std::function<void(const glm::vec2&)>            on_texcoord;
+    std::function<void(const glm::vec3&)>            on_normal;
+    std::function<void(const Corner*, size_t count)> on_face;
+    // usemtl: id into model_data.m_materials, -1 for a name no mtllib defined
+    std::function<void(std::string_view name, int material_id)> on_material;
+    // g: id into model_data.m_groups
+    std::function<void(std::string_view name, int group_id)> on_group;
+};
+
 class OBJLoader {
   private:
-    void load_textures();
-    void read_normal(const char* buff);
-    void read_vertex(const char* buff);
-    void read_texcoord(const char* buff);
-
-    void read_faceLimited(const char* buff, int current_mat_id, int current_group_id);
-    void read_mtllib(const char* buff, const std::string& filename);
-    void read_usemtl(const char* buff, int& current_mat_id);
-    void add_new_group(const char* buff, int& current_group_id);
-    static void clear_cache();
-    inline static std::unordered_map<std::string,std::shared_ptr<ModelData>> model_cache = {};
+    // Files smaller than this are parsed on the calling thread, the spawn/merge cost
+    // outweighs the gain. Chunks are never made smaller than PARALLEL_PARSE_MIN_CHUNK.
+    static constexpr size_t PARALLEL_PARSE_MIN_BYTES = 512 * 1024;
+    static constexpr size_t PARALLEL_PARSE_MIN_CHUNK = 256 * 1024;
+    // default for model_cache, change it through cache().set_budget()
+    static constexpr size_t MODEL_CACHE_BUDGET = 256 * 1024 * 1024;
+
+    struct ParsedChunk;
+
+    static bool parse_normal(std::string_view data, glm::vec3& out);
+    static bool parse_vertex(std::string_view data, glm::vec4& out);
+    static bool parse_texcoord(std::string_view data, glm::vec2& out);
+    // Reads the corners of an 'f' record into out as raw OBJ indices (1-based, negative for
+    // relative, 0 where a corner leaves one out), returns how many were read.
+    static size_t parse_face(std::string_view data, std::vector<Corner>& out);
+    static void parse_chunk(std::string_view text, ParsedChunk& out);
+    void parse_parallel(std::string_view text, const std::string& filename, size_t chunk_count);
+
+    void read_normal(std::string_view data);
+    void read_vertex(std::string_view data);
+    void read_texcoord(std::string_view data);
+
+    void read_face(std::string_view data, int current_mat_id, int current_group_id);
+    void read_mtllib(std::string_view data, const std::string& filename);
+    void read_usemtl(std::string_view data, int& current_mat_id);
+    void add_new_group(std::string_view data, int& current_group_id);
+    // 0 picks std::thread::hardware_concurrency()
+    unsigned            parse_threads = 0;
+    std::vector<Corner> face_scratch;
+    inline static AssetRegistry<ModelData> model_cache{MODEL_CACHE_BUDGET};
+
   public:
     void debug_dump() const;
 
-    std::shared_ptr<ModelData> read_from_file(const std::string& filename);
+    // Parses filename unless it is already cached and moves the result into the shared
+    // model cache, model_data is left empty.
+    std::shared_ptr<const ModelData> read_from_file(const std::string& filename);
+    // budget, counters and eviction of the models read_from_file shares
+    inline static AssetRegistry<ModelData>& cache() {
+        return model_cache;
+    }
+    // Parses the .obj (and its .mtl) into model_data, bypassing the cache and textures.
+    // Returns the number of bytes that were parsed.
+    size_t parse(const std::string& filename);
+    // Walks filename calling the handlers of visitor instead of building model_data, so memory
+    // stays bounded by what the handlers keep. Only materials, groups and mtllib paths (small)
+    // are still collected in model_data. Always serial. Returns the number of bytes parsed.
+    size_t stream(const std::string& filename, const OBJVisitor& visitor);
+    // Large files are split into newline-aligned chunks parsed on up to this many threads.
+    // The result is identical to a serial parse, 1 forces the serial path.
+    inline void set_parse_threads(unsigned threads) {
+        parse_threads = threads;
+    }
     ModelData model_data;
 
     void parseFace(const std::string& line);
@@ -0,0 +1,1127 @@
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "OBJLoader.h"
+#include "RangeAllocator.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+template <typename T> static bool same_bytes(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+// The threaded parse must reproduce the serial one exactly, bit for bit.
+static bool same_model(const ObjectLoader::ModelData& a, const ObjectLoader::ModelData& b) {
+    if (!same_bytes(a.m_vertices, b.m_vertices) ||
+        !same_bytes(a.m_texture_coords, b.m_texture_coords) ||
+        !same_bytes(a.m_vertex_normals, b.m_vertex_normals) || a.m_groups != b.m_groups ||
+        a.m_materials.size() != b.m_materials.size())
+        return false;
+    for (size_t i = 0; i < a.m_materials.size(); ++i) {
+        if (a.m_materials[i].name != b.m_materials[i].name)
+            return false;
+    }
+    const auto &fa = a.m_faces, &fb = b.m_faces;
+    if (fa.corner_vertices != fb.corner_vertices || fa.corner_texcoords != fb.corner_texcoords ||
+        fa.corner_normals != fb.corner_normals || fa.face_offsets != fb.face_offsets ||
+        a.m_face_runs.size() != b.m_face_runs.size())
+        return false;
+    for (size_t i = 0; i < a.m_face_runs.size(); ++i) {
+        const auto &ra = a.m_face_runs[i], &rb = b.m_face_runs[i];
+        if (ra.first_face != rb.first_face || ra.material_id != rb.material_id ||
+            ra.group_id != rb.group_id)
+            return false;
+    }
+    return true;
+}
+
+// Whether the baked upload streams are what Model::upload_buffers() makes of mesh
+static bool same_upload_streams(const Models::MeshData& mesh,
+                                const Models::MeshData::BakedStreams& baked) {
+    const Models::PackedBounds bounds = Models::packed_bounds(mesh.vertices);
+    if (std::memcmp(&bounds, &baked.packed_bounds, sizeof(bounds)) != 0)
+        return false;
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        Models::PackedVertex packed = Models::pack_vertex(mesh.vertices[i], bounds);
+        if (std::memcmp(&packed, &baked.packed[i], sizeof(packed)) != 0)
+            return false;
+    }
+    for (size_t i = 0; i < mesh.indices.size(); ++i) {
+        uint32_t index = baked.index_size == 2
+                             ? static_cast<const uint16_t*>(baked.upload_indices)[i]
+                             : static_cast<const uint32_t*>(baked.upload_indices)[i];
+        if (index != mesh.indices[i])
+            return false;
+    }
+    return true;
+}
+
+// Cold (parse + dedup + tangents + bake) against warm (map the baked file) mesh loads.
+static void bench_mesh_cache(const std::vector<std::string>& files, int repeat) {
+    const std::string dir = "obj_bench_mesh_cache";
+    std::filesystem::remove_all(dir);
+    Models::MeshCache::set_directory(dir);
+
+    double total_cold = 0.0, total_warm = 0.0;
+    for (const auto& file : files) {
+        bool baked = false;
+        auto start = std::chrono::steady_clock::now();
+        auto mesh  = Models::MeshCache::read_or_build(file, &baked);
+        auto stop  = std::chrono::steady_clock::now();
+        double cold = std::chrono::duration<double>(stop - start).count();
+
+        double warm = 1e30;
+        for (int r = 0; r < repeat; ++r) {
+            start     = std::chrono::steady_clock::now();
+            auto again = Models::MeshCache::read_or_build(file, &baked);
+            stop      = std::chrono::steady_clock::now();
+            warm      = std::min(warm, std::chrono::duration<double>(stop - start).count());
+            if (!baked || again.vertex_count() != mesh.vertices.size() ||
+                again.index_count() != mesh.indices.size() ||
+                std::memcmp(again.vertex_data(), mesh.vertices.data(),
+                            mesh.vertices.size() * sizeof(Models::Vertex)) != 0 ||
+                std::memcmp(again.index_data(), mesh.indices.data(),
+                            mesh.indices.size() * sizeof(uint32_t)) != 0 ||
+                !same_upload_streams(mesh, again.baked)) {
+                std::cerr << "baked mesh does not round trip: " << file << "\n";
+            }
+        }
+        total_cold += cold;
+        total_warm += warm;
+        std::printf("%-64s %8zu verts  cold %8.3f ms  warm %8.3f ms\n", file.c_str(),
+                    mesh.vertices.size(), cold * 1e3, warm * 1e3);
+    }
+    std::printf("total: cold %.3f ms, warm %.3f ms (%.1fx)\n", total_cold * 1e3,
+                total_warm * 1e3, total_cold / total_warm);
+    std::filesystem::remove_all(dir);
+}
+
+// build_mesh() with and without the near weld, and how the triplet table behaved.
+static void bench_weld(const std::vector<std::string>& files, int repeat) {
+    std::printf("%-48s %8s %8s %7s %7s %5s %7s %9s %9s\n", "file", "corners", "triplets",
+                "load", "probes", "max", "welded", "build ms", "+weld ms");
+    for (const auto& file : files) {
+        ObjectLoader::OBJLoader loader;
+        loader.parse(file);
+
+        Models::WeldStats stats;
+        double            times[2] = {1e30, 1e30};
+        for (int r = 0; r < repeat; ++r) {
+            for (int weld = 0; weld < 2; ++weld) {
+                Models::WeldOptions options;
+                options.near_weld = weld;
+                auto start        = std::chrono::steady_clock::now();
+                Models::build_mesh(loader.model_data, options, &stats);
+                auto   stop = std::chrono::steady_clock::now();
+                double time = std::chrono::duration<double>(stop - start).count();
+                times[weld] = std::min(times[weld], time);
+            }
+        }
+        std::printf("%-48s %8zu %8zu %7.2f %7.3f %5zu %7zu %9.3f %9.3f\n", file.c_str(),
+                    stats.corners, stats.triplets, double(stats.triplets) / stats.slots,
+                    stats.corners ? double(stats.probes) / stats.corners : 0.0, stats.max_probe,
+                    stats.near_welded, times[0] * 1e3, times[1] * 1e3);
+    }
+}
+
+// compute_tangents() against the per-triangle loop it replaced (calculate_tangent_bitangent()
+// and orthogonalize_and_normalize_tb() over the AoS vertices), once on one thread and once on
+// threads (0: all). All three must store the same tangents. degen: triangles that add no
+// tangent (no UV or no position area), nan: vertices the loop left without a finite tangent
+// before the UV guard.
+static int bench_tangents(const std::vector<std::string>& files, int repeat, unsigned threads) {
+    std::printf("%-48s %8s %8s %6s %6s %9s %9s %9s\n", "file", "tris", "verts", "degen", "nan",
+                "loop ms", "soa ms", "soa/N ms");
+    int failures = 0;
+    for (const auto& file : files) {
+        ObjectLoader::OBJLoader loader;
+        loader.parse(file);
+        const Models::MeshData mesh    = Models::build_mesh(loader.model_data);
+        const auto&            indices = mesh.indices;
+
+        size_t degenerate = 0;
+        std::vector<bool> unguarded(mesh.vertices.size(), false);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const glm::vec2 uv0 = mesh.vertices[indices[i]].texcoord;
+            const glm::vec2 d1  = mesh.vertices[indices[i + 1]].texcoord - uv0;
+            const glm::vec2 d2  = mesh.vertices[indices[i + 2]].texcoord - uv0;
+            if (auto [T, B] = Models::calculate_tangent_bitangent(
+                    mesh.vertices[indices[i]], mesh.vertices[indices[i + 1]],
+                    mesh.vertices[indices[i + 2]]);
+                T == glm::vec3(0.0f) && B == glm::vec3(0.0f))
+                ++degenerate;
+            // 1 / 0 poisoned every vertex of the triangle
+            if (d1.x * d2.y - d2.x * d1.y == 0.0f)
+                unguarded[indices[i]] = unguarded[indices[i + 1]] = unguarded[indices[i + 2]] =
+                    true;
+        }
+
+        std::vector<Models::Vertex> results[3];
+        double                      times[3] = {1e30, 1e30, 1e30};
+        for (int r = 0; r < repeat; ++r) {
+            for (int run = 0; run < 3; ++run) {
+                std::vector<Models::Vertex> vertices = mesh.vertices;
+                auto                        start    = std::chrono::steady_clock::now();
+                if (run == 0) {
+                    std::vector<glm::vec3> tan1(vertices.size(), glm::vec3(0.0f));
+                    std::vector<glm::vec3> tan2(vertices.size(), glm::vec3(0.0f));
+                    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+                        auto [T, B] = Models::calculate_tangent_bitangent(
+                            vertices[indices[i]], vertices[indices[i + 1]],
+                            vertices[indices[i + 2]]);
+                        for (int k = 0; k < 3; ++k) {
+                            tan1[indices[i + k]] += T;
+                            tan2[indices[i + k]] += B;
+                        }
+                    }
+                    for (size_t i = 0; i < vertices.size(); ++i)
+                        Models::orthogonalize_and_normalize_tb(vertices[i], tan1, tan2, i);
+                } else {
+                    Models::compute_tangents(vertices, indices, run == 1 ? 1 : threads);
+                }
+                auto   stop = std::chrono::steady_clock::now();
+                double time = std::chrono::duration<double>(stop - start).count();
+                times[run]   = std::min(times[run], time);
+                results[run] = std::move(vertices);
+            }
+        }
+
+        bool same = true, finite = true;
+        for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+            const glm::vec4& t = results[1][v].tangent;
+            same   = same && results[0][v].tangent == t && results[2][v].tangent == t;
+            finite = finite && std::isfinite(t.x) && std::isfinite(t.y) && std::isfinite(t.z);
+        }
+        if (!same || !finite) {
+            std::cerr << (same ? "non-finite tangents in " : "tangents differ for ") << file
+                      << "\n";
+            ++failures;
+        }
+        std::printf("%-48s %8zu %8zu %6zu %6zu %9.3f %9.3f %9.3f\n", file.c_str(),
+                    indices.size() / 3, mesh.vertices.size(), degenerate,
+                    size_t(std::count(unguarded.begin(), unguarded.end(), true)), times[0] * 1e3,
+                    times[1] * 1e3, times[2] * 1e3);
+    }
+    return failures == 0 ? 0 : 2;
+}
+
+// The triangles of a submesh as sorted vertex bytes, each rotated to start at its smallest
+// vertex, so meshes that draw the same triangles in another order compare equal.
+static std::vector<std::string> triangle_set(const Models::MeshData& mesh, const SubMesh& sm) {
+    std::vector<std::string> triangles;
+    for (uint32_t i = sm.index_offset; i + 2 < sm.index_offset + sm.index_count; i += 3) {
+        std::string corners[3];
+        for (int k = 0; k < 3; ++k)
+            corners[k].assign(reinterpret_cast<const char*>(&mesh.vertices[mesh.indices[i + k]]),
+                              sizeof(Models::Vertex));
+        int first = int(std::min_element(corners, corners + 3) - corners);
+        triangles.push_back(corners[first] + corners[(first + 1) % 3] + corners[(first + 2) % 3]);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// ACMR/ATVR of every mesh before and after optimize_mesh(), which must keep its triangles.
+static int bench_vertex_cache(const std::vector<std::string>& files) {
+    std::printf("%-48s %8s %13s %13s %9s\n", "file", "tris", "acmr", "atvr", "ms");
+    double before_total[2] = {0.0, 0.0}, after_total[2] = {0.0, 0.0};
+    size_t triangle_total  = 0;
+    int    mismatches      = 0;
+    for (const auto& file : files) {
+        ObjectLoader::OBJLoader loader;
+        loader.parse(file);
+        Models::MeshData mesh   = Models::build_mesh(loader.model_data);
+        auto             before = Models::analyze_vertex_cache(mesh);
+
+        Models::MeshData optimized = mesh;
+        auto             start     = std::chrono::steady_clock::now();
+        Models::optimize_mesh(optimized);
+        auto stop  = std::chrono::steady_clock::now();
+        auto after = Models::analyze_vertex_cache(optimized);
+
+        bool same = optimized.vertices.size() == mesh.vertices.size() &&
+                    optimized.submeshes.size() == mesh.submeshes.size();
+        for (size_t i = 0; same && i < mesh.submeshes.size(); ++i)
+            same = triangle_set(mesh, mesh.submeshes[i]) ==
+                   triangle_set(optimized, optimized.submeshes[i]);
+        if (!same) {
+            std::cerr << "optimize_mesh changed the triangles of " << file << "\n";
+            ++mismatches;
+        }
+
+        const size_t triangles = mesh.indices.size() / 3;
+        triangle_total += triangles;
+        before_total[0] += before.acmr * triangles;
+        after_total[0] += after.acmr * triangles;
+        before_total[1] += before.atvr * triangles;
+        after_total[1] += after.atvr * triangles;
+        std::printf("%-48s %8zu %5.3f->%5.3f %5.3f->%5.3f %9.3f\n", file.c_str(), triangles,
+                    before.acmr, after.acmr, before.atvr, after.atvr,
+                    std::chrono::duration<double>(stop - start).count() * 1e3);
+    }
+    if (triangle_total) {
+        std::printf("triangle weighted: acmr %.3f -> %.3f, atvr %.3f -> %.3f\n",
+                    before_total[0] / triangle_total, after_total[0] / triangle_total,
+                    before_total[1] / triangle_total, after_total[1] / triangle_total);
+    }
+    return mismatches == 0 ? 0 : 2;
+}
+
+// Cluster stats per mesh and how much of it the cluster culling keeps, in percent of the
+// triangles, averaged over 8 views from outside (on the AABB corner directions, 1.5 diagonals
+// out, looking at the centre) and 4 from the centre looking along +-x and +-z, all 45 degree
+// 16:9 perspectives. The triangles must stay the same and every cluster inside the limits.
+static int bench_clusters(const std::vector<std::string>& files) {
+    std::printf("%-48s %8s %8s %7s %13s %9s %9s %8s %8s\n", "file", "tris", "clusters",
+                "tris/cl", "acmr", "outside%", "inside%", "ms", "flat ms");
+    const Models::ClusterOptions limits;
+    double kept_total[2] = {0.0, 0.0};
+    size_t triangle_total = 0;
+    int    failures       = 0;
+    for (const auto& file : files) {
+        ObjectLoader::OBJLoader loader;
+        loader.parse(file);
+        Models::MeshData mesh = Models::build_mesh(loader.model_data);
+        Models::optimize_mesh(mesh);
+        Models::MeshData clustered = mesh;
+        auto             start     = std::chrono::steady_clock::now();
+        Models::build_clusters(clustered);
+        auto   stop = std::chrono::steady_clock::now();
+        double time = std::chrono::duration<double>(stop - start).count();
+
+        // the same triangles sharing no vertex, as a flat shaded export has them: every
+        // cluster grows through the loose triangle lookup
+        Models::MeshData flat = mesh;
+        flat.vertices.clear();
+        for (uint32_t& index : flat.indices) {
+            flat.vertices.push_back(mesh.vertices[index]);
+            index = static_cast<uint32_t>(flat.vertices.size() - 1);
+        }
+        start = std::chrono::steady_clock::now();
+        Models::build_clusters(flat);
+        stop             = std::chrono::steady_clock::now();
+        double flat_time = std::chrono::duration<double>(stop - start).count();
+        auto before = Models::analyze_vertex_cache(mesh);
+        auto after  = Models::analyze_vertex_cache(clustered);
+
+        size_t clusters = 0;
+        bool   ok       = true;
+        for (size_t i = 0; i < mesh.submeshes.size(); ++i) {
+            const SubMesh& sm = clustered.submeshes[i];
+            ok = ok && triangle_set(mesh, mesh.submeshes[i]) == triangle_set(clustered, sm);
+            uint32_t next = sm.index_offset;
+            for (const auto& cluster : sm.clusters) {
+                std::vector<uint32_t> vertices(clustered.indices.begin() + cluster.index_offset,
+                                               clustered.indices.begin() + cluster.index_offset +
+                                                   cluster.index_count);
+                std::sort(vertices.begin(), vertices.end());
+                vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+                ok = ok && cluster.index_offset == next &&
+                     cluster.index_count <= limits.max_triangles * 3 &&
+                     vertices.size() <= limits.max_vertices;
+                next += cluster.index_count;
+            }
+            ok = ok && next == sm.index_offset + sm.index_count;
+            clusters += sm.clusters.size();
+        }
+        if (!ok) {
+            std::cerr << "build_clusters broke the triangles or the limits of " << file << "\n";
+            ++failures;
+        }
+
+        const glm::vec3 center = 0.5f * (mesh.aabb_min + mesh.aabb_max);
+        const float     extent = glm::length(mesh.aabb_max - mesh.aabb_min);
+        const glm::mat4 projection =
+            glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.01f * extent, 4.0f * extent);
+        auto kept = [&](const glm::vec3& eye, const glm::vec3& target) {
+            const glm::vec3 up = std::abs(glm::normalize(target - eye).y) > 0.99f
+                                     ? glm::vec3(0.0f, 0.0f, 1.0f)
+                                     : glm::vec3(0.0f, 1.0f, 0.0f);
+            const auto view = Models::make_cluster_view(glm::lookAt(eye, target, up), projection,
+                                                        false);
+            size_t drawn = 0;
+            for (const auto& sm : clustered.submeshes) {
+                for (const auto& cluster : sm.clusters)
+                    drawn += Models::cluster_visible(cluster, view) ? cluster.index_count : 0;
+            }
+            return mesh.indices.empty() ? 0.0
+                                             : 100.0 * drawn / double(mesh.indices.size());
+        };
+        double outside = 0.0, inside = 0.0;
+        if (extent > 0.0f) {
+            for (int corner = 0; corner < 8; ++corner) {
+                const glm::vec3 direction(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f,
+                                          corner & 4 ? 1.0f : -1.0f);
+                outside += kept(center + glm::normalize(direction) * 1.5f * extent, center) / 8.0;
+            }
+            const glm::vec3 axes[4] = {{1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}};
+            for (const auto& axis : axes)
+                inside += kept(center, center + axis) / 4.0;
+        }
+
+        const size_t triangles = mesh.indices.size() / 3;
+        triangle_total += triangles;
+        kept_total[0] += outside * triangles;
+        kept_total[1] += inside * triangles;
+        std::printf("%-48s %8zu %8zu %7.1f %5.3f->%5.3f %9.1f %9.1f %8.2f %8.2f\n",
+                    file.c_str(), triangles, clusters,
+                    clusters ? double(triangles) / clusters : 0.0, before.acmr, after.acmr,
+                    outside, inside, time * 1e3, flat_time * 1e3);
+    }
+    if (triangle_total) {
+        std::printf("triangle weighted: %.1f%% kept from outside, %.1f%% from inside\n",
+                    kept_total[0] / triangle_total, kept_total[1] / triangle_total);
+    }
+    return failures == 0 ? 0 : 2;
+}
+
+// Distance from p to the triangle abc (Ericson, Real-Time Collision Detection 5.1.5)
+static float point_triangle_distance(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b,
+                                     const glm::vec3& c) {
+    const glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+    const float     d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return glm::length(p - a);
+    const glm::vec3 bp = p - b;
+    const float     d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+        return glm::length(p - b);
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return glm::length(p - (a + ab * (d1 / (d1 - d3))));
+    const glm::vec3 cp = p - c;
+    const float     d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+        return glm::length(p - c);
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return glm::length(p - (a + ac * (d2 / (d2 - d6))));
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return glm::length(p - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))));
+    const float denom = 1.0f / (va + vb + vc);
+    return glm::length(p - (a + ab * (vb * denom) + ac * (vc * denom)));
+}
+
+// Triangles and error of every level build_lods() makes. "measured" is the largest distance
+// from (up to 1000 of) the full mesh's vertices to the level's surface, relative to the AABB
+// diagonal like the error build_lods() reports.
+static int bench_lod(const std::vector<std::string>& files) {
+    std::printf("%-48s %9s %s\n", "file", "ms", "tris (error / measured) per level");
+    size_t totals[4] = {0, 0, 0, 0};
+    int    failures  = 0;
+    for (const auto& file : files) {
+        ObjectLoader::OBJLoader loader;
+        loader.parse(file);
+        Models::MeshData mesh = Models::build_mesh(loader.model_data);
+        Models::optimize_mesh(mesh);
+        auto start = std::chrono::steady_clock::now();
+        Models::build_lods(mesh);
+        auto stop = std::chrono::steady_clock::now();
+
+        const float extent = glm::length(mesh.aabb_max - mesh.aabb_min);
+        std::string row;
+        size_t      triangles = 0;
+        for (size_t level = 0; level <= mesh.lod_errors.size(); ++level) {
+            float                 measured = 0.0f;
+            std::vector<uint32_t> surface;
+            for (const auto& sm : mesh.submeshes) {
+                const LodRange range = level ? sm.lods[level - 1]
+                                             : LodRange{sm.index_offset, sm.index_count};
+                surface.insert(surface.end(), mesh.indices.begin() + range.index_offset,
+                               mesh.indices.begin() + range.index_offset + range.index_count);
+            }
+            // level 0 is the input, some exports come with degenerate triangles
+            for (size_t i = 0; level && i < surface.size(); i += 3) {
+                if (surface[i] == surface[i + 1] || surface[i + 1] == surface[i + 2] ||
+                    surface[i + 2] == surface[i]) {
+                    std::cerr << "degenerate triangle in level " << level << " of " << file
+                              << "\n";
+                    ++failures;
+                    break;
+                }
+            }
+            triangles = surface.size() / 3;
+            if (level && extent > 0.0f) {
+                const size_t step = std::max<size_t>(1, mesh.vertices.size() / 1000);
+                for (size_t v = 0; v < mesh.vertices.size(); v += step) {
+                    float nearest = std::numeric_limits<float>::max();
+                    for (size_t i = 0; i < surface.size(); i += 3) {
+                        nearest = std::min(nearest, point_triangle_distance(
+                                                        mesh.vertices[v].position,
+                                                        mesh.vertices[surface[i]].position,
+                                                        mesh.vertices[surface[i + 1]].position,
+                                                        mesh.vertices[surface[i + 2]].position));
+                    }
+                    measured = std::max(measured, nearest / extent);
+                }
+            }
+            totals[level] += triangles;
+            char cell[64];
+            if (level) {
+                std::snprintf(cell, sizeof(cell), " %8zu (%.4f / %.4f)", triangles,
+                              mesh.lod_errors[level - 1], measured);
+            } else {
+                std::snprintf(cell, sizeof(cell), " %8zu", triangles);
+            }
+            row += cell;
+        }
+        for (size_t level = mesh.lod_errors.size() + 1; level < 4; ++level)
+            totals[level] += triangles;
+        std::printf("%-48s %9.3f%s\n", file.c_str(),
+                    std::chrono::duration<double>(stop - start).count() * 1e3, row.c_str());
+    }
+    std::printf("triangles per level, meshes without a level count their last one: %zu",
+                totals[0]);
+    for (int level = 1; level < 4; ++level)
+        std::printf(" / %zu", totals[level]);
+    std::printf("\n");
+    return failures == 0 ? 0 : 2;
+}
+
+// Quantisation round trip of the packed vertex format: every vertex is packed, unpacked the
+// way the shader reads it and compared with the float one, on the CPU, nothing is rendered.
+// Position error is given in pixels with the mesh filling a 1080 pixel high view, texcoord
+// error in texels of a 2048 texture and shading error in 8-bit levels of a Blinn-Phong term
+// lit and viewed from fixed directions.
+static int check_packed_round_trip(const std::vector<std::string>& files) {
+    const glm::vec3 light = glm::normalize(glm::vec3(0.3f, 0.8f, 0.5f));
+    const glm::vec3 half  = glm::normalize(light + glm::vec3(0.0f, 0.0f, 1.0f));
+    auto            shade = [&](const glm::vec3& normal) {
+        glm::vec3 n = glm::normalize(normal);
+        return std::max(glm::dot(n, light), 0.0f) +
+               std::pow(std::max(glm::dot(n, half), 0.0f), 32.0f);
+    };
+
+    std::printf("%-48s %8s %10s %10s %8s %8s %8s %6s\n", "file", "verts", "float KB", "packed KB",
+                "pos px", "uv texel", "shade", "flips");
+    size_t float_total = 0, packed_total = 0;
+    int    failures    = 0;
+    for (const auto& file : files) {
+        ObjectLoader::OBJLoader loader;
+        loader.parse(file);
+        Models::MeshData     mesh   = Models::build_mesh(loader.model_data);
+        Models::PackedBounds bounds = Models::packed_bounds(mesh.vertices);
+        const float          extent = glm::length(mesh.aabb_max - mesh.aabb_min);
+
+        double position_px = 0.0, uv_texels = 0.0, shading = 0.0;
+        size_t flips = 0;
+        for (const auto& v : mesh.vertices) {
+            Models::Vertex back = Models::unpack_vertex(Models::pack_vertex(v, bounds), bounds);
+            if (extent > 0.0f) {
+                double error = glm::length(back.position - v.position) / extent * 1080.0;
+                position_px  = std::max(position_px, error);
+            }
+            glm::vec2 uv = glm::abs(back.texcoord - v.texcoord);
+            uv_texels    = std::max<double>(uv_texels, std::max(uv.x, uv.y) * 2048.0);
+            if (glm::length(v.normal) > 0.0f) {
+                double error = std::abs(shade(back.normal) - shade(v.normal)) * 255.0;
+                shading      = std::max(shading, error);
+            }
+            flips += (back.tangent.w < 0.0f) != (v.tangent.w < 0.0f);
+        }
+
+        const size_t float_bytes  = mesh.vertices.size() * sizeof(Models::Vertex);
+        const size_t packed_bytes = mesh.vertices.size() * sizeof(Models::PackedVertex);
+        float_total += float_bytes;
+        packed_total += packed_bytes;
+        // half a pixel, a texel, two shading levels
+        bool ok = position_px <= 0.5 && uv_texels <= 1.0 && shading <= 2.0 && flips == 0;
+        failures += !ok;
+        std::printf("%-48s %8zu %10.1f %10.1f %8.3f %8.3f %8.2f %6zu%s\n", file.c_str(),
+                    mesh.vertices.size(), float_bytes / 1024.0, packed_bytes / 1024.0,
+                    position_px, uv_texels, shading, flips, ok ? "" : "  FAIL");
+    }
+    if (packed_total) {
+        std::printf("vertex memory: %.1f KB -> %.1f KB (%.2fx)\n", float_total / 1024.0,
+                    packed_total / 1024.0, double(float_total) / packed_total);
+    }
+    return failures == 0 ? 0 : 2;
+}
+
+// The loops the numeric tokenizer replaced, kept as the reference for --tokenizer.
+static size_t from_chars_floats(std::string_view sv, float* out, size_t n) {
+    const char* p     = sv.data();
+    const char* end   = p + sv.size();
+    size_t      count = 0;
+    while (count < n) {
+        auto [next, ec] = std::from_chars(p, end, out[count]);
+        if (ec != std::errc())
+            break;
+        ++count;
+        p = next;
+        while (p < end && ObjectLoader::is_space(*p))
+            ++p;
+    }
+    return count;
+}
+
+static size_t from_chars_corners(std::string_view sv, std::vector<ObjectLoader::Corner>& out) {
+    const char* p   = sv.data();
+    const char* end = p + sv.size();
+    while (p < end && !ObjectLoader::is_space(*p) && *p != '#') {
+        ObjectLoader::Corner corner{0, 0, 0};
+        auto [p1, ec1] = std::from_chars(p, end, corner.vertex);
+        if (ec1 != std::errc())
+            break;
+        p = p1;
+        if (p < end && *p == '/') {
+            ++p;
+            if (p < end && *p == '/') {
+                ++p;
+                auto [p2, ec2] = std::from_chars(p, end, corner.normal);
+                corner.normal  = ec2 == std::errc() ? corner.normal : 0;
+                p              = p2;
+            } else {
+                auto [p2, ec2]  = std::from_chars(p, end, corner.texcoord);
+                corner.texcoord = ec2 == std::errc() ? corner.texcoord : 0;
+                p               = p2;
+                if (p < end && *p == '/') {
+                    ++p;
+                    auto [p3, ec3] = std::from_chars(p, end, corner.normal);
+                    corner.normal  = ec3 == std::errc() ? corner.normal : 0;
+                    p              = p3;
+                }
+            }
+        }
+        out.push_back(corner);
+        while (p < end && ObjectLoader::is_space(*p))
+            ++p;
+    }
+    return out.size();
+}
+
+// Time per record of every numeric record type, for the from_chars loops against each
+// tokenizer implementation this CPU runs. Every result is compared bit for bit with from_chars.
+static int bench_tokenizer(const std::vector<std::string>& files, int repeat) {
+    struct RecordType {
+        const char*                   name;
+        size_t                        floats; // 0 for face corners
+        std::vector<std::string_view> records;
+        size_t                        bytes = 0;
+    };
+    RecordType types[] = {{"v", 4, {}}, {"vt", 2, {}}, {"vn", 3, {}}, {"f", 0, {}}, {"mtl", 3, {}}};
+
+    std::vector<ObjectLoader::MappedFile> mapped;
+    for (const auto& file : files) {
+        mapped.emplace_back(file);
+        std::string_view text = mapped.back().view();
+        size_t           pos  = 0;
+        while (pos < text.size()) {
+            std::string_view line = ObjectLoader::skip_spaces(ObjectLoader::next_line(text, pos));
+            size_t           key_end = 0;
+            while (key_end < line.size() && !ObjectLoader::is_space(line[key_end]))
+                ++key_end;
+            std::string_view key  = line.substr(0, key_end);
+            std::string_view data = ObjectLoader::skip_spaces(line.substr(key_end));
+            RecordType*      type = nullptr;
+            if (key == "v")
+                type = &types[0];
+            else if (key == "vt")
+                type = &types[1];
+            else if (key == "vn")
+                type = &types[2];
+            else if (key == "f")
+                type = &types[3];
+            else if (key == "Ka" || key == "Kd" || key == "Ks" || key == "Ke" || key == "Ns" ||
+                     key == "Ni" || key == "d")
+                type = &types[4];
+            if (type) {
+                type->records.push_back(data);
+                type->bytes += data.size();
+            }
+        }
+    }
+
+    std::vector<ObjectLoader::TokenizerIsa> isas = {ObjectLoader::TokenizerIsa::Scalar};
+    if (ObjectLoader::best_tokenizer_isa() >= ObjectLoader::TokenizerIsa::SSE42)
+        isas.push_back(ObjectLoader::TokenizerIsa::SSE42);
+    if (ObjectLoader::best_tokenizer_isa() >= ObjectLoader::TokenizerIsa::AVX2)
+        isas.push_back(ObjectLoader::TokenizerIsa::AVX2);
+
+    std::printf("%-6s %9s %12s", "record", "count", "from_chars");
+    for (auto isa : isas)
+        std::printf(" %12s", ObjectLoader::tokenizer_isa_name(isa));
+    std::printf(" %8s\n", "speedup");
+
+    const ObjectLoader::TokenizerIsa active = ObjectLoader::tokenizer_isa();
+    int                              mismatches = 0;
+    for (auto& type : types) {
+        if (type.records.empty())
+            continue;
+        const size_t width = type.floats ? type.floats : 1;
+        // one pass over every record of the type, -1 runs the from_chars reference
+        std::vector<float>                floats(type.records.size() * width);
+        std::vector<ObjectLoader::Corner> corners;
+        auto pass = [&](int isa) {
+            corners.clear();
+            auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < type.records.size(); ++r) {
+                if (type.floats == 0) {
+                    isa < 0 ? from_chars_corners(type.records[r], corners)
+                            : ObjectLoader::parse_corners(type.records[r], corners);
+                } else {
+                    float* out = floats.data() + r * width;
+                    isa < 0 ? from_chars_floats(type.records[r], out, width)
+                            : ObjectLoader::parse_floats(type.records[r], out, width);
+                }
+            }
+            auto stop = std::chrono::steady_clock::now();
+            return std::chrono::duration<double>(stop - start).count();
+        };
+        // the variants take turns within every repeat so a noisy stretch hits them all alike
+        std::vector<double> best(isas.size() + 1, 1e30);
+        for (int r = 0; r < repeat; ++r) {
+            best[0] = std::min(best[0], pass(-1));
+            for (size_t i = 0; i < isas.size(); ++i) {
+                ObjectLoader::set_tokenizer_isa(isas[i]);
+                best[i + 1] = std::min(best[i + 1], pass(static_cast<int>(isas[i])));
+            }
+        }
+
+        // compare every variant against a fresh from_chars pass
+        pass(-1);
+        const auto   reference_floats  = floats;
+        const auto   reference_corners = corners;
+        const double reference_time    = best[0];
+        const double per_record        = 1e9 / type.records.size();
+        std::printf("%-6s %9zu %9.1f ns", type.name, type.records.size(),
+                    reference_time * per_record);
+
+        double fastest = reference_time;
+        for (size_t i = 0; i < isas.size(); ++i) {
+            ObjectLoader::set_tokenizer_isa(isas[i]);
+            pass(static_cast<int>(isas[i]));
+            fastest = std::min(fastest, best[i + 1]);
+            std::printf(" %9.1f ns", best[i + 1] * per_record);
+
+            bool same = type.floats ? same_bytes(floats, reference_floats)
+                                    : corners.size() == reference_corners.size() &&
+                                          std::memcmp(corners.data(), reference_corners.data(),
+                                                      corners.size() *
+                                                          sizeof(ObjectLoader::Corner)) == 0;
+            if (!same) {
+                std::cerr << "MISMATCH against from_chars: " << type.name << " records, "
+                          << ObjectLoader::tokenizer_isa_name(isas[i]) << "\n";
+                ++mismatches;
+            }
+        }
+        std::printf(" %7.2fx\n", reference_time / fastest);
+    }
+    ObjectLoader::set_tokenizer_isa(active);
+    return mismatches == 0 ? 0 : 2;
+}
+
+// Bounds and triangle count through OBJLoader::stream() against the same from a full parse(),
+// with what each one had to keep in memory.
+static int bench_stream(const std::vector<std::string>& files, int repeat) {
+    struct Scan {
+        glm::vec3 min{1e30f}, max{-1e30f};
+        size_t    triangles = 0;
+    };
+    int mismatches = 0;
+    for (const auto& file : files) {
+        Scan                     scan;
+        ObjectLoader::OBJVisitor visitor;
+        visitor.on_vertex = [&](const glm::vec4& v) {
+            scan.min = glm::min(scan.min, glm::vec3(v));
+            scan.max = glm::max(scan.max, glm::vec3(v));
+        };
+        visitor.on_face = [&](const ObjectLoader::Corner*, size_t count) {
+            scan.triangles += count - 2;
+        };
+
+        double streamed = 1e30, parsed = 1e30;
+        size_t model_bytes = 0;
+        Scan   reference;
+        for (int r = 0; r < repeat; ++r) {
+            scan       = Scan{};
+            auto start = std::chrono::steady_clock::now();
+            ObjectLoader::OBJLoader{}.stream(file, visitor);
+            auto stop = std::chrono::steady_clock::now();
+            streamed  = std::min(streamed, std::chrono::duration<double>(stop - start).count());
+
+            ObjectLoader::OBJLoader loader;
+            loader.set_parse_threads(1);
+            start = std::chrono::steady_clock::now();
+            loader.parse(file);
+            reference = Scan{};
+            for (const auto& v : loader.model_data.m_vertices) {
+                reference.min = glm::min(reference.min, glm::vec3(v));
+                reference.max = glm::max(reference.max, glm::vec3(v));
+            }
+            reference.triangles = loader.model_data.m_faces.triangle_count();
+            stop                = std::chrono::steady_clock::now();
+            parsed      = std::min(parsed, std::chrono::duration<double>(stop - start).count());
+            model_bytes = loader.model_data.bytes();
+        }
+
+        if (scan.min != reference.min || scan.max != reference.max ||
+            scan.triangles != reference.triangles) {
+            std::cerr << "MISMATCH against parse(): " << file << "\n";
+            ++mismatches;
+        }
+        // the scan is all the stream keeps, the parse holds the whole model
+        std::printf("%-64s %9zu tris  stream %8.3f ms %6zu B  parse %8.3f ms %10zu B\n",
+                    file.c_str(), scan.triangles, streamed * 1e3, sizeof(Scan), parsed * 1e3,
+                    model_bytes);
+    }
+    return mismatches == 0 ? 0 : 2;
+}
+
+// Measures raw .obj parse throughput (no textures, no cache).
+// Built without DEBUG_OBJLOADER so the per-record logging does not skew the numbers.
+// MeshArena's placement without GL: the meshes of files loaded into blocks of the default size,
+// then random removals and reloads. Afterwards the blocks must account for every unit, no two
+// live meshes may overlap, and the removals should leave the free space mostly in one piece.
+static int bench_arena(const std::vector<std::string>& files, int repeat) {
+    constexpr uint32_t BLOCK_VERTICES    = 1u << 18;
+    constexpr uint32_t BLOCK_INDEX_BYTES = 4u << 20;
+    struct Size {
+        uint32_t vertices;
+        uint32_t index_bytes;
+    };
+    struct Block {
+        Models::RangeAllocator vertices;
+        Models::RangeAllocator indices;
+    };
+    struct Live {
+        size_t        block;
+        Models::Range vertices;
+        Models::Range indices;
+    };
+
+    std::vector<Size> sizes;
+    for (const auto& file : files) {
+        auto         mesh  = Models::MeshCache::load(file);
+        const size_t index = mesh->vertex_count() <= 65536 ? 2 : 4;
+        sizes.push_back({static_cast<uint32_t>(mesh->vertex_count()),
+                         static_cast<uint32_t>(mesh->index_count() * index + 3) & ~3u});
+    }
+    if (sizes.empty())
+        return 0;
+
+    std::vector<Block> blocks;
+    std::vector<Live>  live;
+    auto               place = [&](const Size& size) {
+        Live mesh;
+        for (mesh.block = 0; mesh.block < blocks.size(); ++mesh.block) {
+            Block& b = blocks[mesh.block];
+            if (b.vertices.largest_free() >= size.vertices &&
+                b.indices.largest_free() >= size.index_bytes)
+                break;
+        }
+        if (mesh.block == blocks.size()) {
+            const uint32_t index_bytes = std::max(size.index_bytes, BLOCK_INDEX_BYTES);
+            blocks.push_back({Models::RangeAllocator(std::max(size.vertices, BLOCK_VERTICES)),
+                              Models::RangeAllocator(index_bytes)});
+        }
+        blocks[mesh.block].vertices.allocate(size.vertices, mesh.vertices);
+        blocks[mesh.block].indices.allocate(size.index_bytes, mesh.indices);
+        live.push_back(mesh);
+    };
+    auto fragmentation = [&](size_t& free_ranges) {
+        size_t free_total = 0, scattered = 0;
+        free_ranges = 0;
+        for (const auto& b : blocks) {
+            free_total += size_t(b.vertices.free_units()) * sizeof(Models::PackedVertex) +
+                          b.indices.free_units();
+            scattered += size_t(b.vertices.free_units() - b.vertices.largest_free()) *
+                             sizeof(Models::PackedVertex) +
+                         b.indices.free_units() - b.indices.largest_free();
+            free_ranges += b.vertices.free_ranges() + b.indices.free_ranges();
+        }
+        return free_total ? double(scattered) / double(free_total) : 0.0;
+    };
+
+    for (const auto& size : sizes)
+        place(size);
+    size_t free_ranges = 0;
+    std::printf("%zu meshes in %zu blocks, %.1f%% fragmented\n", live.size(), blocks.size(),
+                100.0 * fragmentation(free_ranges));
+
+    std::mt19937 rng(1234);
+    const size_t rounds = size_t(repeat) * 2000;
+    double       worst  = 0.0;
+    auto         start  = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        const size_t victim = rng() % live.size();
+        blocks[live[victim].block].vertices.free(live[victim].vertices);
+        blocks[live[victim].block].indices.free(live[victim].indices);
+        live[victim] = live.back();
+        live.pop_back();
+        place(sizes[rng() % sizes.size()]);
+        worst = std::max(worst, fragmentation(free_ranges));
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    // every unit is either free or owned by exactly one live mesh
+    int failures = 0;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        std::vector<uint8_t> vertex_owner(blocks[b].vertices.capacity(), 0);
+        std::vector<uint8_t> index_owner(blocks[b].indices.capacity(), 0);
+        size_t               used_vertices = 0, used_indices = 0;
+        for (const auto& mesh : live) {
+            if (mesh.block != b)
+                continue;
+            for (uint32_t i = 0; i < mesh.vertices.size; ++i)
+                failures += vertex_owner[mesh.vertices.offset + i]++ != 0;
+            for (uint32_t i = 0; i < mesh.indices.size; ++i)
+                failures += index_owner[mesh.indices.offset + i]++ != 0;
+            used_vertices += mesh.vertices.size;
+            used_indices += mesh.indices.size;
+        }
+        const auto& block = blocks[b];
+        failures += used_vertices + block.vertices.free_units() != block.vertices.capacity();
+        failures += used_indices + block.indices.free_units() != block.indices.capacity();
+    }
+    const double last = fragmentation(free_ranges);
+    std::printf("%zu remove/reload rounds: %.3f us each, %zu blocks, %zu free ranges, "
+                "%.1f%% fragmented (worst %.1f%%)%s\n",
+                rounds, std::chrono::duration<double, std::micro>(stop - start).count() / rounds,
+                blocks.size(), free_ranges, 100.0 * last, 100.0 * worst,
+                failures ? "  FAIL" : "");
+    return failures == 0 ? 0 : 2;
+}
+
+// What instancing the copies of a mesh costs in triangles and saves in draws, the way
+// Group::instanced_models() collapses the room props: one copy in each of the five rooms of the
+// game (at the room offsets, 5 units in), seen from 24 views, the middle of each room and the
+// hallway looking along +-x and +-z (45 degree 16:9 perspectives). Copies are culled by their
+// AABB first, then per view: one multi-draw per submesh of separate models with their own
+// cluster culling, one instanced draw per submesh without it, and one instanced draw per run of
+// the clusters any visible copy keeps. The last must keep the triangles of the first.
+static int bench_instancing(const std::vector<std::string>& files) {
+    const glm::vec3 rooms[5] = {
+        {50.0f, 0.0f, 50.0f}, {-50.0f, 0.0f, -40.0f}, {50.0f, 0.0f, -40.0f},
+        {-50.0f, 0.0f, 50.0f}, {45.0f, 0.0f, 0.0f}};
+    const glm::vec3 axes[4] = {{1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}};
+    std::vector<glm::mat4> views;
+    for (int room = 0; room <= 5; ++room) {
+        const glm::vec3 eye = (room < 5 ? rooms[room] + glm::vec3(5.0f, 0.0f, 0.0f)
+                                        : glm::vec3(0.0f)) +
+                              glm::vec3(0.0f, 1.8f, 0.0f);
+        for (const auto& axis : axes)
+            views.push_back(glm::lookAt(eye, eye + axis, glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+    const glm::mat4 projection =
+        glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+    std::printf("%-48s %8s %8s %17s %17s %17s\n", "file", "tris", "clusters",
+                "separate tris/dr", "instanced tris/dr", "culled tris/dr");
+    double totals[3][2] = {};
+    int    failures     = 0;
+    for (const auto& file : files) {
+        ObjectLoader::OBJLoader loader;
+        loader.parse(file);
+        Models::MeshData mesh = Models::build_mesh(loader.model_data);
+        Models::optimize_mesh(mesh);
+        Models::build_clusters(mesh);
+        // on the floor, centred 5 units into the room
+        const glm::vec3 centre = 0.5f * (mesh.aabb_min + mesh.aabb_max);
+        std::vector<glm::mat4> copies;
+        for (const auto& room : rooms)
+            copies.push_back(glm::translate(
+                glm::mat4(1.0f), room + glm::vec3(5.0f - centre.x, -mesh.aabb_min.y, -centre.z)));
+
+        double counted[3][2] = {};
+        std::vector<Models::ClusterView> visible;
+        for (const auto& view : views) {
+            visible.clear();
+            for (const auto& copy : copies) {
+                // the mesh's AABB against the frustum brought into the copy's model space
+                const auto frustum = Models::make_cluster_view(view * copy, projection, false);
+                bool       inside  = true;
+                for (const auto& plane : frustum.planes) {
+                    const glm::vec3 far(plane.x > 0.0f ? mesh.aabb_max.x : mesh.aabb_min.x,
+                                        plane.y > 0.0f ? mesh.aabb_max.y : mesh.aabb_min.y,
+                                        plane.z > 0.0f ? mesh.aabb_max.z : mesh.aabb_min.z);
+                    inside = inside && glm::dot(glm::vec3(plane), far) + plane.w >= 0.0f;
+                }
+                if (inside)
+                    visible.push_back(frustum);
+            }
+            if (visible.empty())
+                continue;
+            for (const auto& sm : mesh.submeshes) {
+                const bool culls = sm.clusters.size() >= 2;
+                for (const auto& copy_view : visible) {
+                    size_t kept = culls ? 0 : sm.index_count;
+                    for (const auto& cluster : sm.clusters) {
+                        if (culls && Models::cluster_visible(cluster, copy_view))
+                            kept += cluster.index_count;
+                    }
+                    counted[0][0] += kept / 3;
+                    counted[0][1] += kept != 0;
+                }
+                counted[1][0] += sm.index_count / 3 * visible.size();
+                counted[1][1] += 1;
+                if (!culls) {
+                    counted[2][0] += sm.index_count / 3 * visible.size();
+                    counted[2][1] += 1;
+                    continue;
+                }
+                uint32_t end = sm.index_offset + sm.index_count + 1;
+                for (const auto& cluster : sm.clusters) {
+                    const bool seen =
+                        std::any_of(visible.begin(), visible.end(), [&](const auto& copy_view) {
+                            return Models::cluster_visible(cluster, copy_view);
+                        });
+                    if (!seen)
+                        continue;
+                    counted[2][0] += cluster.index_count / 3 * visible.size();
+                    counted[2][1] += cluster.index_offset != end;
+                    end = cluster.index_offset + cluster.index_count;
+                }
+            }
+        }
+        size_t clusters = 0;
+        for (const auto& sm : mesh.submeshes)
+            clusters += sm.clusters.size();
+        // union culling never drops a cluster a copy keeps, with one visible copy it is exact
+        failures += counted[2][0] < counted[0][0];
+        std::printf("%-48s %8zu %8zu %10.0f/%5.1f %10.0f/%5.1f %10.0f/%5.1f%s\n", file.c_str(),
+                    mesh.indices.size() / 3, clusters, counted[0][0] / views.size(),
+                    counted[0][1] / views.size(), counted[1][0] / views.size(),
+                    counted[1][1] / views.size(), counted[2][0] / views.size(),
+                    counted[2][1] / views.size(), counted[2][0] < counted[0][0] ? "  FAIL" : "");
+        for (int i = 0; i < 3; ++i) {
+            totals[i][0] += counted[i][0] / views.size();
+            totals[i][1] += counted[i][1] / views.size();
+        }
+    }
+    std::printf("per view: separate %.0f tris in %.1f draws, instanced %.0f in %.1f, "
+                "instanced with cluster culling %.0f in %.1f\n",
+                totals[0][0], totals[0][1], totals[1][0], totals[1][1], totals[2][0],
+                totals[2][1]);
+    return failures == 0 ? 0 : 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: obj_bench [--repeat N] [--threads N] [--verify] [--mesh] "
+                     "[--tokenizer] [--stream] [--weld] [--vertex-cache] [--packed] [--lod] "
+                     "[--clusters] [--tangents] [--arena] [--instancing] "
+                     "<file.obj|file.mtl>...\n";
+        return 1;
+    }
+
+    int                      repeat  = 5;
+    unsigned                 threads = 0;
+    bool                     verify  = false;
+    bool                     mesh    = false;
+    bool                     numbers = false;
+    bool                     streams = false;
+    bool                     weld    = false;
+    bool                     vcache  = false;
+    bool                     packed  = false;
+    bool                     lods    = false;
+    bool                     culling = false;
+    bool                     tangent = false;
+    bool                     arena   = false;
+    bool                     batches = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::max(0, std::stoi(argv[++i])));
+        } else if (arg == "--verify") {
+            verify = true;
+        } else if (arg == "--mesh") {
+            mesh = true;
+        } else if (arg == "--tokenizer") {
+            numbers = true;
+        } else if (arg == "--stream") {
+            streams = true;
+        } else if (arg == "--weld") {
+            weld = true;
+        } else if (arg == "--vertex-cache") {
+            vcache = true;
+        } else if (arg == "--packed") {
+            packed = true;
+        } else if (arg == "--lod") {
+            lods = true;
+        } else if (arg == "--clusters") {
+            culling = true;
+        } else if (arg == "--tangents") {
+            tangent = true;
+        } else if (arg == "--arena") {
+            arena = true;
+        } else if (arg == "--instancing") {
+            batches = true;
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (mesh) {
+        bench_mesh_cache(files, repeat);
+        return 0;
+    }
+    if (numbers)
+        return bench_tokenizer(files, repeat);
+    if (streams)
+        return bench_stream(files, repeat);
+    if (weld) {
+        bench_weld(files, repeat);
+        return 0;
+    }
+    if (vcache)
+        return bench_vertex_cache(files);
+    if (packed)
+        return check_packed_round_trip(files);
+    if (lods)
+        return bench_lod(files);
+    if (culling)
+        return bench_clusters(files);
+    if (tangent)
+        return bench_tangents(files, repeat, threads);
+    if (arena)
+        return bench_arena(files, repeat);
+    if (batches)
+        return bench_instancing(files);
+
+    double total_bytes   = 0.0;
+    double total_seconds = 0.0;
+    int    mismatches    = 0;
+    for (const auto& file : files) {
+        double best  = 1e30;
+        size_t bytes = 0;
+        for (int r = 0; r < repeat; ++r) {
+            ObjectLoader::OBJLoader loader;
+            loader.set_parse_threads(threads);
+            auto start = std::chrono::steady_clock::now();
+            bytes      = loader.parse(file);
+            auto stop  = std::chrono::steady_clock::now();
+            best       = std::min(best, std::chrono::duration<double>(stop - start).count());
+
+            if (verify && r == 0) {
+                ObjectLoader::OBJLoader serial;
+                serial.set_parse_threads(1);
+                serial.parse(file);
+                if (!same_model(loader.model_data, serial.model_data)) {
+                    std::cerr << "MISMATCH against serial parse: " << file << "\n";
+                    ++mismatches;
+                }
+            }
+        }
+        total_bytes += bytes;
+        total_seconds += best;
+        std::printf("%-64s %10.1f KB %9.2f MB/s\n", file.c_str(), bytes / 1024.0,
+                    bytes / best / 1e6);
+    }
+    std::printf("total: %.2f MB in %.3f ms -> %.2f MB/s\n", total_bytes / 1e6,
+                total_seconds * 1e3, total_bytes / total_seconds / 1e6);
+    return mismatches == 0 ? 0 : 2;
+}
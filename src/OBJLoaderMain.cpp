@@ -10,7 +10,7 @@ int main(int argc, char** argv) {
     const std::string filename = argv[1];
 
     ObjectLoader::OBJLoader loader;
-    loader.read_from_file(filename);
+    loader.parse(filename);
     loader.debug_dump();
 
     std::cout << "Finished loading.\n";
@@ -21,7 +21,8 @@ int main(int argc, char** argv) {
     // std::cout << "TexCoords:       " << loader.m_texture_coords.size() << "\n";
     std::cout << "TexCoords new:   " << loader.model_data.m_texture_coords.size() << "\n";
     // std::cout << "Faces:           " << loader.m_faces.size() << "\n";
-    std::cout << "Faces new:       " << loader.model_data.m_faces.size() << "\n";
+    std::cout << "Faces new:       " << loader.model_data.m_faces.face_count() << "\n";
+    std::cout << "Triangles:       " << loader.model_data.m_faces.triangle_count() << "\n";
 
 
 #ifdef DEBUG_OBJLOADER
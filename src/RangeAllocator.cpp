@@ -0,0 +1,67 @@
+#include "RangeAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+Models::RangeAllocator::RangeAllocator(uint32_t capacity) : total(capacity), available(capacity) {
+    if (capacity > 0)
+        free_list.push_back({0, capacity});
+}
+
+bool Models::RangeAllocator::allocate(uint32_t size, Range& out) {
+    if (size == 0 || size > available)
+        return false;
+
+    auto best = free_list.end();
+    for (auto it = free_list.begin(); it != free_list.end(); ++it) {
+        if (it->size >= size && (best == free_list.end() || it->size < best->size)) {
+            best = it;
+            if (best->size == size)
+                break;
+        }
+    }
+    if (best == free_list.end())
+        return false;
+
+    out = {best->offset, size};
+    if (best->size == size) {
+        free_list.erase(best);
+    } else {
+        best->offset += size;
+        best->size -= size;
+    }
+    available -= size;
+    return true;
+}
+
+void Models::RangeAllocator::free(const Range& range) {
+    if (range.size == 0)
+        return;
+    assert(range.offset + range.size <= total);
+
+    auto next = std::lower_bound(
+        free_list.begin(), free_list.end(), range.offset,
+        [](const Range& r, uint32_t offset) { return r.offset < offset; });
+    auto       prev       = next == free_list.begin() ? free_list.end() : std::prev(next);
+    const bool joins_prev = prev != free_list.end() && prev->offset + prev->size == range.offset;
+    const bool joins_next = next != free_list.end() && range.offset + range.size == next->offset;
+
+    if (joins_prev && joins_next) {
+        prev->size += range.size + next->size;
+        free_list.erase(next);
+    } else if (joins_prev) {
+        prev->size += range.size;
+    } else if (joins_next) {
+        next->offset = range.offset;
+        next->size += range.size;
+    } else {
+        free_list.insert(next, range);
+    }
+    available += range.size;
+}
+
+uint32_t Models::RangeAllocator::largest_free() const {
+    uint32_t largest = 0;
+    for (const auto& r : free_list)
+        largest = std::max(largest, r.size);
+    return largest;
+}
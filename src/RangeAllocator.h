@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Models {
+
+    // A run of units of a buffer, vertices or bytes depending on who asks
+    struct Range {
+        uint32_t offset = 0;
+        uint32_t size   = 0;
+    };
+
+    // Free list over a buffer of capacity units. allocate() takes the smallest free range that
+    // fits (best fit), so the large ones stay around for large meshes, and free() merges the
+    // range it gets back with the free ones on either side. No GL in here.
+    class RangeAllocator {
+    public:
+        explicit RangeAllocator(uint32_t capacity = 0);
+
+        // false when no free range holds size units, out is left alone then
+        bool allocate(uint32_t size, Range& out);
+        void free(const Range& range);
+
+        inline uint32_t capacity() const {
+            return total;
+        }
+
+        inline uint32_t free_units() const {
+            return available;
+        }
+
+        uint32_t largest_free() const;
+
+        inline size_t free_ranges() const {
+            return free_list.size();
+        }
+
+    private:
+        uint32_t total     = 0;
+        uint32_t available = 0;
+        // sorted by offset, never two touching ranges
+        std::vector<Range> free_list;
+    };
+
+} // namespace Models
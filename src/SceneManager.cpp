@@ -1,6 +1,10 @@
 #include "SceneManager.h"
 #include "Camera.h"
+#include "DecodePool.h"
 #include "Light.h"
+#include "MeshCache.h"
+#include "TextureRegistry.h"
+#include "TextureUpload.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_mixer.h>
 #include <SDL_keyboard.h>
@@ -16,6 +20,7 @@ void Game::GameState::add_model(std::unique_ptr<Models::Model> model, const std:
     model_indices[name] = idx;
     model_names.push_back(name);
     models.push_back(std::move(model));
+    index_instances(models.back().get());
 }
 
 void Game::GameState::add_model(Models::Model&& model, const std::string& name) {
@@ -26,6 +31,19 @@ void Game::GameState::add_model(Models::Model&& model, const std::string& name)
     model_indices[name] = idx;
     model_names.push_back(std::move(name));
     models.push_back(std::move(ptr));
+    index_instances(models.back().get());
+}
+
+void Game::GameState::index_instances(Models::Model* model) {
+    if (!model->is_instanced())
+        return;
+    for (size_t i = 0; i < model->get_instance_count(); ++i) {
+        const std::string      name     = model->name(i);
+        Models::InstanceHandle instance = model->find_instance(name.substr(model->label().size()));
+        if (!instance_names.emplace(name, InstanceRef{model, instance}).second) {
+            throw std::runtime_error("Instance name registered twice: " + name);
+        }
+    }
 }
 
 void Game::GameState::remove_model(const std::string& name) {
@@ -36,6 +54,13 @@ void Game::GameState::remove_model(const std::string& name) {
     size_t idx  = it->second;
     size_t last = models.size() - 1;
 
+    for (auto ref = instance_names.begin(); ref != instance_names.end();) {
+        if (ref->second.model == models[idx].get()) {
+            ref = instance_names.erase(ref);
+        } else {
+            ++ref;
+        }
+    }
     if (idx != last) {
         std::swap(models[idx], models[last]);
         std::swap(model_names[idx], model_names[last]);
@@ -57,6 +82,16 @@ const std::vector<std::unique_ptr<Models::Model>>& Game::GameState::get_models()
     return models;
 }
 
+Models::Model* Game::GameState::find_instance(const std::string&      name,
+                                              Models::InstanceHandle& instance) const {
+    auto it = instance_names.find(name);
+    // removed instances stay in the index, their handles no longer resolve
+    if (it == instance_names.end() || it->second.model->instance_index(it->second.instance) < 0)
+        return nullptr;
+    instance = it->second.instance;
+    return it->second.model;
+}
+
 void Game::GameState::add_light(std::unique_ptr<Light> light, const std::string& name) {
     size_t idx          = lights.size();
     light_indices[name] = idx;
@@ -208,8 +243,9 @@ void Game::SceneManager::run_game_loop() {
         .speed_within(4.0f, 10.0f)
         .restrict_monster_within(-room_width, room_width, -room_depth, room_depth);
 
-    running           = true;
-    Uint64 lastTicks  = SDL_GetPerformanceCounter();
+    running                      = true;
+    bool   decode_report_pending = true;
+    Uint64 lastTicks             = SDL_GetPerformanceCounter();
     auto   flashlight = game_state->find_light("flashlight");
 
     if (!flashlight) {
@@ -250,6 +286,7 @@ void Game::SceneManager::run_game_loop() {
         Uint64 now = SDL_GetPerformanceCounter();
         float  dt  = float(now - lastTicks) / float(SDL_GetPerformanceFrequency());
         lastTicks  = now;
+        Models::Model::reset_frame_stats();
         handle_sdl_events(running);
         last_camera_position   = camera.get_position();
         last_monster_transform = monster.monster_model()->get_local_transform();
@@ -277,7 +314,34 @@ void Game::SceneManager::run_game_loop() {
         }
        
 
+        // collisions and culling read the world AABBs
+        update_transforms();
         check_collisions(dt);
+        // textures decoded since the last frame get their GL names here
+        TextureUploadQueue::main_queue().drain();
+        if (decode_report_pending && ObjectLoader::DecodePool::shared().idle() &&
+            TextureUploadQueue::main_queue().pending() == 0) {
+            // every texture of the scene is on the GPU, show what startup was waiting on
+            ObjectLoader::DecodePool::shared().report(std::cout);
+            TextureRegistry::global().report(std::cout);
+            auto meshes = Models::MeshCache::memory().stats();
+            std::cout << meshes.entries << " meshes cached, " << meshes.bytes / 1024 << " KiB, "
+                      << meshes.hits << " hits, " << meshes.misses << " misses, "
+                      << meshes.evictions << " evictions\n";
+            auto indices = Models::Model::index_buffer_stats();
+            std::cout << "index buffers: " << indices.bytes / 1024 << " KiB, "
+                      << indices.saved / 1024 << " KiB saved by 16-bit indices\n";
+            auto vertices = Models::Model::vertex_memory_stats();
+            std::cout << "CPU vertex copies: " << vertices.released / 1024 << " KiB released, "
+                      << vertices.kept / 1024 << " KiB kept\n";
+            auto arena = Models::MeshArena::shared().stats();
+            std::cout << "mesh arena: " << arena.blocks << " blocks, "
+                      << arena.used_vertex_bytes / 1024 << "/" << arena.vertex_bytes / 1024
+                      << " KiB vertices, " << arena.used_index_bytes / 1024 << "/"
+                      << arena.index_bytes / 1024 << " KiB indices, " << arena.free_ranges
+                      << " free ranges, " << int(arena.fragmentation * 100.0) << "% fragmented\n";
+            decode_report_pending = false;
+        }
         glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         // glEnable(GL_BLEND);
@@ -289,11 +353,13 @@ void Game::SceneManager::run_game_loop() {
         flashlight->set_position(camera.get_position() + offset);
         flashlight->set_direction(camera.get_direction());
 
+        // every pass draws from its own visible set
+        perform_culling();
         render_depth_pass();
         glm::mat4 view = camera.get_view_matrix();
         glm::mat4 proj = camera.get_projection_matrix();
-        perform_culling();
         render(view, proj);
+        Models::InstanceStream::shared().end_frame();
         run_interaction_handlers();
         SDL_GL_SwapWindow(window);
     }
@@ -345,6 +411,9 @@ void Game::SceneManager::remove_instanced_model_at(const std::string& name,
 void Game::SceneManager::remove_model(const std::string& name) {
     auto it = event_handlers.find(name);
     if (it != event_handlers.end()) {
+        if (game_state->find_model(name) == highlighted_model) {
+            highlight_interactable("");
+        }
         game_state->remove_model(name);
     }
 }
@@ -372,10 +441,11 @@ void Game::SceneManager::render_depth_pass() {
     auto depth2D   = get_shader_by_name("depth_2d");
     auto depthCube = get_shader_by_name("depth_cube");
 
-    for (auto& light : game_state->get_lights()) {
+    for (size_t i = 0; i < game_state->get_lights().size(); ++i) {
+        const auto& light = game_state->get_lights()[i];
         if(!light->is_turned_on()){
             continue;
-        } 
+        }
         std::shared_ptr<Shader> sh;
         if (light->get_type() == LightType::POINT) {
             auto depthCube = get_shader_by_name("depth_cube");
@@ -384,7 +454,7 @@ void Game::SceneManager::render_depth_pass() {
             auto depth2D = get_shader_by_name("depth_2d");
             sh           = depth2D;
         }
-        light->draw_depth_pass(sh, game_state->get_models());
+        light->draw_depth_pass(sh, visibility, light_first_view[i]);
     }
 }
 
@@ -399,10 +469,46 @@ void Game::SceneManager::run_interaction_handlers() {
                 run_handler_for(game_state->closest_model);
             }
             bottom_text_hints = "Interact with " + game_state->closest_model + " (Press I)";
+            highlight_interactable(game_state->closest_model);
         } else {
             bottom_text_hints = "";
+            highlight_interactable("");
+        }
+    }
+}
+
+void Game::SceneManager::highlight_interactable(const std::string& name) {
+    if (name == highlighted)
+        return;
+    // an instance carries the flag in its attributes, a model of its own in its flags; a stale
+    // handle (the instance was removed) just does nothing
+    auto set_highlight = [this](bool on) {
+        if (!highlighted_model)
+            return;
+        if (!highlighted_model->is_instanced()) {
+            uint32_t flags = highlighted_model->get_flags();
+            highlighted_model->set_flags(on ? flags | Models::INSTANCE_HIGHLIGHT
+                                            : flags & ~Models::INSTANCE_HIGHLIGHT);
+            return;
         }
+        int index = highlighted_model->instance_index(highlighted_instance);
+        if (index < 0)
+            return;
+        auto attributes = highlighted_model->get_instance_attributes(index);
+        attributes.flags = on ? attributes.flags | Models::INSTANCE_HIGHLIGHT
+                              : attributes.flags & ~Models::INSTANCE_HIGHLIGHT;
+        highlighted_model->set_instance_attributes(highlighted_instance, attributes);
+    };
+
+    set_highlight(false);
+    highlighted       = name;
+    highlighted_model = nullptr;
+    if (!name.empty()) {
+        highlighted_model = game_state->find_instance(name, highlighted_instance);
+        if (!highlighted_model)
+            highlighted_model = game_state->find_model(name);
     }
+    set_highlight(true);
 }
 void Game::SceneManager::handle_sdl_events(bool& running) {
     SDL_Event ev;
@@ -417,6 +523,9 @@ void Game::SceneManager::handle_sdl_events(bool& running) {
         }
         
         const auto keys = SDL_GetKeyboardState(nullptr);
+        if (ev.type == SDL_KEYDOWN && ev.key.repeat == 0 && keys[SDL_SCANCODE_F3]) {
+            show_stats = !show_stats;
+        }
         if(ev.type == SDL_KEYDOWN && ev.key.repeat == 0 && keys[SDL_SCANCODE_M]){
             std::cout << "Position: " << camera.get_position().x << "," << camera.get_position().y << "," << camera.get_position().z << "\n";
         }
@@ -425,13 +534,26 @@ void Game::SceneManager::handle_sdl_events(bool& running) {
     }
 }
 
-void Game::SceneManager::perform_culling() {
-    auto frustum_planes  = camera.extract_frustum_planes();
-    auto camera_position = camera.get_position();
-
+void Game::SceneManager::update_transforms() {
+    // only the models that moved since the last frame recompute anything
     for (auto& model : game_state->get_models()) {
-        model->in_frustum(frustum_planes);
+        model->update_world_transform(glm::mat4(1.0f));
+    }
+}
+
+void Game::SceneManager::perform_culling() {
+    // view 0 is the camera, then the shadow views of every light that is on, in light order
+    view_frusta.clear();
+    view_frusta.push_back(camera.extract_frustum_planes());
+    light_first_view.assign(game_state->get_lights().size(), 0);
+    for (size_t i = 0; i < game_state->get_lights().size(); ++i) {
+        const auto& light = game_state->get_lights()[i];
+        if (!light->is_turned_on())
+            continue;
+        light_first_view[i] = view_frusta.size();
+        light->append_view_frusta(view_frusta);
     }
+    visibility.compute(game_state->get_models(), view_frusta);
 }
 
 void Game::SceneManager::check_collisions(float dt) {
@@ -444,7 +566,6 @@ void Game::SceneManager::check_collisions(float dt) {
     }
 
     // Precompute monster world‐space center
-    monster_model->update_world_transform(glm::mat4(1.0f));
     glm::vec3 monster_center = 0.5f * (monster_model->get_aabbmin() + monster_model->get_aabbmax());
 
     const auto camera_pos     = camera.get_position();
@@ -492,6 +613,7 @@ void Game::SceneManager::check_collisions(float dt) {
             if (model->name() != monster_name && monster_is_collided) {
                 // std::cout << "Name is: " << name << ", monster name: " << monster_name << "\n";
                 monster_model->set_local_transform(last_mon_xform);
+                monster_model->update_world_transform(glm::mat4(1.0f));
                 return true;
             }
         }
@@ -512,6 +634,9 @@ void Game::SceneManager::render(const glm::mat4& view, const glm::mat4& projecti
 
     GLCall(glViewport(0, 0, screen_width, screen_height));
     GLCall(glEnable(GL_MULTISAMPLE));
+    // the shadow passes leave it on as well, Model::draw() drops the clusters facing away
+    GLCall(glEnable(GL_CULL_FACE));
+    GLCall(glCullFace(GL_BACK));
     GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
 
     auto shader = get_shader_by_name("blinn-phong");
@@ -526,19 +651,9 @@ void Game::SceneManager::render(const glm::mat4& view, const glm::mat4& projecti
         light->draw_lighting(shader, base, i);
     }
 
-    for (auto const& model : game_state->get_models()) {
-        if (!model->is_active()) {
-            continue;
-        }
-        
-        //TODO this has a problem, in the beginning not all things are rendered properly
-        if (!model->is_in_frustum()) {
-            // std::cout << model->name() << std::endl;
-            continue;
-        }
-
-        model->update_world_transform(glm::mat4(1.0f));
-        model->draw(view, projection, shader);
+    const auto& visible = visibility.view(0);
+    for (const auto& entry : visible.models) {
+        entry.model->draw(view, projection, shader, visible.instances(entry), 0);
     }
 
     GLCall(glDisable(GL_MULTISAMPLE));
@@ -555,6 +670,18 @@ void Game::SceneManager::render(const glm::mat4& view, const glm::mat4& projecti
                                   1.2f, {1.0f, 0.0f, 0.0f}, text_projection);
     }
 
+    if (show_stats) {
+        // the main pass has been counted by now, the depth passes ran before it
+        auto        frame = Models::Model::frame_stats();
+        std::string stats = "tris " + std::to_string(frame.triangles) + "  shadow tris " +
+                            std::to_string(frame.shadow_triangles) + "  transforms " +
+                            std::to_string(frame.transforms) + "  vao binds " +
+                            std::to_string(frame.vao_binds) + "  instance bytes " +
+                            std::to_string(frame.instance_bytes);
+        text_renderer.render_text(textShader, stats, 50.0f, 720.0f - 90.0f, 0.5f,
+                                  {1.0f, 1.0f, 1.0f}, text_projection);
+    }
+
     if (!bottom_text_hints.empty()) {
         text_renderer.render_text(textShader, bottom_text_hints, 300.0f, 720.0f - 650.0f, 0.8f,
                                   {0.5f, 0.5f, 0.0f}, text_projection);
@@ -568,6 +695,8 @@ Game::SceneManager::SceneManager(int width, int height, Camera::CameraObj camera
 }
 
 Game::SceneManager::~SceneManager() {
+    // drop the shared meshes (and their textures) while the context is still alive
+    Models::MeshCache::clear();
     SDL_GL_DeleteContext(glCtx);
     SDL_DestroyWindow(window);
     Mix_CloseAudio();
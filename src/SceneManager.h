@@ -41,6 +41,12 @@ namespace Game {
         /// Fast, cache-friendly iteration over all models.
         const std::vector<std::unique_ptr<Models::Model>>& get_models() const;
 
+        /// Look up the instanced model that has an instance named `name` (model->name(i));
+        /// returns nullptr if there is none, instance gets the handle of it otherwise.
+        /// Only instances the model had when it was added are indexed.
+        Models::Model* find_instance(const std::string&      name,
+                                     Models::InstanceHandle& instance) const;
+
         // — Lights API —
         /// Take ownership of this light and register it under `name`.
         void add_light(std::unique_ptr<Light> light, const std::string& name);
@@ -61,6 +67,7 @@ namespace Game {
             models.clear();          // the unique_ptrs—and hence the Model objects—are destroyed
             model_names.clear();     // clear the name list
             model_indices.clear();   // clear the lookup map
+            instance_names.clear();
         }
 
         void clear_lights() {
@@ -73,6 +80,14 @@ namespace Game {
         std::vector<std::string>                   model_names;
         std::unordered_map<std::string, size_t>    model_indices;
 
+        // every instance of the instanced models by its full name, label + suffix
+        struct InstanceRef {
+            Models::Model*         model;
+            Models::InstanceHandle instance;
+        };
+        std::unordered_map<std::string, InstanceRef> instance_names;
+        void index_instances(Models::Model* model);
+
         std::vector<std::unique_ptr<Light>> lights;
         std::vector<std::string>           light_names;
         std::unordered_map<std::string, size_t> light_indices;
@@ -125,9 +140,12 @@ namespace Game {
         std::shared_ptr<Shader> get_shader_by_name(const std::string& shader_name);
         void handle_sdl_events(bool& running);
         void check_collisions(float dt);
+        void update_transforms();
         void perform_culling();
         void run_handler_for(const std::string& m);
         void run_interaction_handlers();
+        // flags the instance or model named name (none when empty) with INSTANCE_HIGHLIGHT
+        void highlight_interactable(const std::string& name);
         bool has_user_won();
 
         GameState* game_state;
@@ -141,9 +159,18 @@ namespace Game {
         Monster monster;
         std::string center_text = "";
         std::string bottom_text_hints = "";
+        std::string            highlighted;
+        Models::Model*         highlighted_model = nullptr;
+        Models::InstanceHandle highlighted_instance;
+        // F3: triangles drawn last frame, per pass
+        bool show_stats = false;
         float room_width;
         float room_height;
         float room_depth;
+        // what the camera and every shadow view see this frame, filled by perform_culling()
+        Models::Visibility           visibility;
+        std::vector<Models::Frustum> view_frusta;
+        std::vector<size_t>          light_first_view;
         glm::vec3 last_camera_position;
         glm::mat4 last_monster_transform;
         bool running = false;
@@ -145,6 +145,20 @@ void Shader::set_vec4(const std::string &name, float x, float y, float z, float
     GLint loc = get_uniform_location(name);
     SET_UNIFORM(loc, glUniform4f(loc, x, y, z, w));
 }
+bool Shader::set_vec4_array(const std::string &name, const glm::vec4 *v, GLsizei count,
+                            uint64_t version) {
+    GLint loc = get_uniform_location(name);
+    if (loc < 0) return false;
+    if (version != 0) {
+        uint64_t& uploaded = uniform_versions[loc];
+        if (uploaded == version) return false;
+        uploaded = version;
+    }
+    if (count > 0) {
+        GLCall(glUniform4fv(loc, count, glm::value_ptr(v[0])));
+    }
+    return true;
+}
 void Shader::set_mat2(const std::string &name, const glm::mat2 &m) {
     GLint loc = get_uniform_location(name);
     SET_UNIFORM(loc, glUniformMatrix2fv(loc, 1, GL_FALSE, glm::value_ptr(m)));
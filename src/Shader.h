@@ -42,6 +42,10 @@ public:
     void set_vec3(const std::string &name, float x, float y, float z);
     void set_vec4(const std::string &name, const glm::vec4 &v);
     void set_vec4(const std::string &name, float x, float y, float z, float w);
+    // count vec4s into the uniform array name with one call. A non-zero version tags the
+    // values: the upload is skipped (and false returned) while the program still holds them.
+    bool set_vec4_array(const std::string &name, const glm::vec4 *v, GLsizei count,
+                        uint64_t version = 0);
     void set_mat2(const std::string &name, const glm::mat2 &m);
     void set_mat3(const std::string &name, const glm::mat3 &m);
     void set_mat4(const std::string &name, const glm::mat4 &m);
@@ -58,5 +62,7 @@ private:
     std::string shader_name;
 
     std::unordered_map<std::string, GLint> uniform_cache;
+    // set_vec4_array() version of the values at a location
+    std::unordered_map<GLint, uint64_t> uniform_versions;
 
 };
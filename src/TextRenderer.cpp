@@ -100,13 +100,13 @@ void TextRenderer::load_font(const char* fontpath) {
     // Setup VAO/VBO for quads
     GLCall(glGenVertexArrays(1, &vao));
     GLCall(glGenBuffers(1, &vbo));
-    GLCall(glBindVertexArray(vao));
+    bind_vertex_array(vao);
     GLCall(glBindBuffer(GL_ARRAY_BUFFER, vbo));
     GLCall(glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW));
     GLCall(glEnableVertexAttribArray(0));
     GLCall(glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0));
     GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-    GLCall(glBindVertexArray(0));
+    bind_vertex_array(0);
 }
 
 void TextRenderer::render_text(std::shared_ptr<Shader> s,
@@ -125,7 +125,7 @@ void TextRenderer::render_text(std::shared_ptr<Shader> s,
     GLCall(glUniform3f(s->get_uniform_location("textColor"),
                        color.x, color.y, color.z));
     GLCall(glActiveTexture(GL_TEXTURE0));
-    GLCall(glBindVertexArray(vao));
+    bind_vertex_array(vao);
 
     for (auto c : text) {
         Character ch = characters[c];
@@ -159,7 +159,7 @@ void TextRenderer::render_text(std::shared_ptr<Shader> s,
         x += (ch.advance >> 6) * scale;
     }
 
-    GLCall(glBindVertexArray(0));
+    bind_vertex_array(0);
     GLCall(glBindTexture(GL_TEXTURE_2D, 0));
     GLCall(glEnable(GL_DEPTH_TEST));
 }
@@ -0,0 +1,161 @@
+#include "TextureRegistry.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+namespace {
+
+    // same file reached through "a/../b.png", "./b.png" or a symlink gives the same key
+    std::string canonical_path(const std::string& path) {
+        std::error_code ec;
+        auto            canonical = std::filesystem::weakly_canonical(path, ec);
+        if (ec)
+            return std::filesystem::path(path).lexically_normal().string();
+        return canonical.string();
+    }
+
+    // 0 for unreadable files, those never match anything
+    uint64_t hash_file(const std::string& path) {
+        try {
+            ObjectLoader::MappedFile file{path};
+            return ObjectLoader::hash_bytes(file.view()) | 1;
+        } catch (const std::runtime_error&) {
+            return 0;
+        }
+    }
+
+} // namespace
+
+GlHelpers::TextureRegistry::TextureRegistry(TextureUploadQueue&       queue,
+                                            ObjectLoader::DecodePool& pool)
+    : queue(queue), pool(pool) {}
+
+GlHelpers::TextureRegistry& GlHelpers::TextureRegistry::global() {
+    static TextureRegistry registry(TextureUploadQueue::main_queue(),
+                                    ObjectLoader::DecodePool::shared());
+    return registry;
+}
+
+std::shared_ptr<Texture> GlHelpers::TextureRegistry::acquire(const std::string& path) {
+    std::string key = canonical_path(path);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = by_path.find(key);
+    if (it != by_path.end()) {
+        if (auto texture = it->second.lock()) {
+            ++hits;
+            return texture;
+        }
+    }
+
+    uint64_t content_hash = content_dedup ? hash_file(key) : 0;
+    if (content_hash) {
+        auto content_it = by_content.find(content_hash);
+        if (content_it != by_content.end()) {
+            if (auto texture = content_it->second.lock()) {
+                by_path[key] = texture;
+                ++hits;
+                return texture;
+            }
+        }
+    }
+
+    auto texture = std::make_shared<Texture>(key);
+    by_path[key] = texture;
+    if (content_hash)
+        by_content[content_hash] = texture;
+
+    // the pool only keeps a weak reference, a texture dropped before it finished decoding
+    // is not uploaded
+    std::weak_ptr<Texture> target = texture;
+    TextureUploadQueue&    upload = queue;
+    pool.submit(key, [target, &upload](ObjectLoader::Image image) {
+        auto texture = target.lock();
+        if (texture && image.valid())
+            upload.push(std::move(texture), std::move(image));
+    });
+    return texture;
+}
+
+void GlHelpers::TextureRegistry::prune() {
+    for (auto it = by_path.begin(); it != by_path.end();) {
+        it = it->second.expired() ? by_path.erase(it) : std::next(it);
+    }
+    for (auto it = by_content.begin(); it != by_content.end();) {
+        it = it->second.expired() ? by_content.erase(it) : std::next(it);
+    }
+}
+
+std::vector<GlHelpers::TextureRegistry::Entry> GlHelpers::TextureRegistry::entries() {
+    std::lock_guard<std::mutex> lock(mutex);
+    prune();
+
+    std::vector<Entry> out;
+    out.reserve(by_path.size());
+    for (const auto& [key, weak] : by_path) {
+        auto texture = weak.lock();
+        // paths merged by content dedup point at a texture that is listed under its own path
+        if (!texture || texture->path != key)
+            continue;
+        Entry entry;
+        entry.path     = key;
+        entry.bytes    = texture->bytes;
+        entry.users    = texture.use_count() - 1;
+        entry.uploaded = texture->id != 0;
+        out.push_back(std::move(entry));
+    }
+    return out;
+}
+
+size_t GlHelpers::TextureRegistry::total_bytes() {
+    size_t total = 0;
+    for (const auto& entry : entries()) {
+        total += entry.bytes;
+    }
+    return total;
+}
+
+void GlHelpers::TextureRegistry::report(std::ostream& out, size_t max_textures) {
+    std::vector<Entry> live = entries();
+    if (live.empty())
+        return;
+
+    size_t total = 0;
+    for (const auto& entry : live) {
+        total += entry.bytes;
+    }
+    std::sort(live.begin(), live.end(),
+              [](const Entry& a, const Entry& b) { return a.bytes > b.bytes; });
+
+    char line[64];
+    std::snprintf(line, sizeof(line), "%.1f MiB", total / (1024.0 * 1024.0));
+    out << live.size() << " textures in VRAM, " << line << ", " << shared_hits()
+        << " loads served by an existing texture\n";
+
+    const size_t shown = std::min(max_textures, live.size());
+    for (size_t i = 0; i < shown; ++i) {
+        std::snprintf(line, sizeof(line), "%9.2f MiB %4ld users ",
+                      live[i].bytes / (1024.0 * 1024.0), live[i].users);
+        out << line << live[i].path << "\n";
+    }
+}
+
+void GlHelpers::request_material_textures(Material& material, TextureRegistry& registry) {
+    if (!material.map_Kd.empty())
+        material.tex_Kd = registry.acquire(material.map_Kd);
+    if (!material.map_Ka.empty())
+        material.tex_Ka = registry.acquire(material.map_Ka);
+    if (!material.map_Ks.empty())
+        material.tex_Ks = registry.acquire(material.map_Ks);
+
+    if (!material.map_Bump.empty() && material.map_Bump != material.map_Kd) {
+        // only load a bump map if it's a different file from the diffuse
+        material.tex_Bump = registry.acquire(material.map_Bump);
+        // a bump map that fails to decode is skipped at draw time since its id stays 0
+        material.use_bump_map = true;
+    } else {
+        // either no bump entry, or they're re-using the diffuse as bump: disable it
+        material.use_bump_map = false;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "DecodePool.h"
+#include "Material.h"
+#include "Texture.h"
+#include "TextureUpload.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GlHelpers {
+
+// One GPU texture per image file for the whole game.
+// acquire() returns the Texture already handed out for the same canonical path (and, with
+// content dedup on, for a different file with identical bytes), otherwise it creates one and
+// queues the decode and upload. The registry only holds weak references: the GL texture is
+// freed when the last material using it goes away, and a later acquire() loads it again.
+class TextureRegistry {
+  public:
+    struct Entry {
+        std::string path;         // canonical
+        size_t      bytes    = 0; // GPU bytes including mipmaps, 0 until uploaded
+        long        users    = 0;
+        bool        uploaded = false;
+    };
+
+    TextureRegistry(TextureUploadQueue& queue, ObjectLoader::DecodePool& pool);
+
+    TextureRegistry(const TextureRegistry&)            = delete;
+    TextureRegistry& operator=(const TextureRegistry&) = delete;
+
+    std::shared_ptr<Texture> acquire(const std::string& path);
+
+    // Also match files by a hash of their bytes, so copies of one image under different names
+    // (common in the asset packs) share a texture. Costs a read of every new file on the
+    // calling thread, off by default. Only textures acquired while it is on are matched.
+    inline void set_content_dedup(bool enabled) {
+        std::lock_guard<std::mutex> lock(mutex);
+        content_dedup = enabled;
+    }
+
+    // live textures, expired ones are dropped on the way
+    std::vector<Entry> entries();
+    size_t             total_bytes();
+
+    // acquire() calls that returned an existing texture
+    inline size_t shared_hits() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hits;
+    }
+
+    // count, total size and the largest textures
+    void report(std::ostream& out, size_t max_textures = 10);
+
+    // the registry the material loaders use
+    static TextureRegistry& global();
+
+  private:
+    void prune();
+
+    TextureUploadQueue&       queue;
+    ObjectLoader::DecodePool& pool;
+
+    mutable std::mutex                                      mutex;
+    bool                                                    content_dedup = false;
+    size_t                                                  hits          = 0;
+    std::unordered_map<std::string, std::weak_ptr<Texture>> by_path;
+    std::unordered_map<uint64_t, std::weak_ptr<Texture>>    by_content;
+};
+
+// Fills mat.tex_* from the registry for every map_* file of mat, the new ones are decoded on
+// the pool and uploaded later, files that fail to decode keep an id of 0.
+// Also decides use_bump_map.
+void request_material_textures(Material&        mat,
+                               TextureRegistry& registry = TextureRegistry::global());
+
+} // namespace GlHelpers
@@ -0,0 +1,91 @@
+#include "TextureUpload.h"
+#include <algorithm>
+
+using namespace GlHelpers;
+
+Texture::~Texture() {
+    if (id) {
+        GLCall(glDeleteTextures(1, &id));
+    }
+}
+
+// what glGenerateMipmap ends up allocating for image, give or take driver padding
+static size_t mip_chain_bytes(const ObjectLoader::Image& image) {
+    size_t bytes  = 0;
+    int    width  = image.width;
+    int    height = image.height;
+    for (;;) {
+        bytes += size_t(width) * size_t(height) * size_t(image.channels);
+        if (width == 1 && height == 1)
+            break;
+        width  = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return bytes;
+}
+
+GLuint GlHelpers::upload_texture(const ObjectLoader::Image& image) {
+    GLenum format = (image.channels == 4) ? GL_RGBA : GL_RGB;
+    GLuint texture_id;
+    GLCall(glGenTextures(1, &texture_id));
+    GLCall(glBindTexture(GL_TEXTURE_2D, texture_id));
+    // RGB rows are not 4 byte aligned for odd widths
+    GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format,
+                        GL_UNSIGNED_BYTE, image.pixels.data()));
+    GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+    GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+    return texture_id;
+}
+
+GlHelpers::TextureUploadQueue& GlHelpers::TextureUploadQueue::main_queue() {
+    static TextureUploadQueue queue;
+    return queue;
+}
+
+std::shared_ptr<Texture> GlHelpers::TextureUploadQueue::push(ObjectLoader::Image image) {
+    auto texture = std::make_shared<Texture>(image.path);
+    push(texture, std::move(image));
+    return texture;
+}
+
+void GlHelpers::TextureUploadQueue::push(std::shared_ptr<Texture> texture,
+                                         ObjectLoader::Image      image) {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back({std::move(image), std::move(texture)});
+}
+
+size_t GlHelpers::TextureUploadQueue::drain(size_t max_uploads) {
+    size_t uploaded = 0;
+    while (uploaded < max_uploads) {
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (jobs.empty())
+                break;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        // nobody holds the texture anymore, skip the upload
+        if (job.texture.use_count() == 1)
+            continue;
+        job.texture->id       = upload_texture(job.image);
+        job.texture->width    = job.image.width;
+        job.texture->height   = job.image.height;
+        job.texture->channels = job.image.channels;
+        job.texture->bytes    = mip_chain_bytes(job.image);
+        ++uploaded;
+    }
+    return uploaded;
+}
+
+size_t GlHelpers::TextureUploadQueue::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size();
+}
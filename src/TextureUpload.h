@@ -0,0 +1,42 @@
+#pragma once
+#include "GlMacros.h"
+#include "Image.h"
+#include "Texture.h"
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace GlHelpers {
+
+// Creates a mipmapped, repeating GL texture from a decoded image. GL thread only.
+GLuint upload_texture(const ObjectLoader::Image& image);
+
+// Hands decoded images from the loaders to the GL thread.
+// push() can be called from any thread and returns the Texture straight away,
+// drain() runs on the GL thread (once per frame) and gives it its GL name and size.
+class TextureUploadQueue {
+  public:
+    std::shared_ptr<Texture> push(ObjectLoader::Image image);
+    // for textures handed out before their image was decoded
+    void push(std::shared_ptr<Texture> texture, ObjectLoader::Image image);
+
+    // Uploads up to max_uploads queued images, returns how many were uploaded.
+    size_t drain(size_t max_uploads = std::numeric_limits<size_t>::max());
+
+    size_t pending() const;
+
+    // the queue the render loop drains
+    static TextureUploadQueue& main_queue();
+
+  private:
+    struct Job {
+        ObjectLoader::Image      image;
+        std::shared_ptr<Texture> texture;
+    };
+
+    mutable std::mutex mutex;
+    std::deque<Job>    jobs;
+};
+
+} // namespace GlHelpers
@@ -0,0 +1,57 @@
+#include "Visibility.h"
+#include "Model.h"
+
+bool Models::aabb_in_frustum(const Frustum& planes, const glm::vec3& min, const glm::vec3& max) {
+    for (const auto& plane : planes) {
+        // the corner furthest along the plane normal, if it is outside the whole box is
+        const glm::vec3 n(plane);
+        const glm::vec3 positive = {n.x > 0.0f ? max.x : min.x, n.y > 0.0f ? max.y : min.y,
+                                    n.z > 0.0f ? max.z : min.z};
+        if (glm::dot(n, positive) + plane.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+void Models::Visibility::compute(const std::vector<std::unique_ptr<Model>>& scene,
+                                 const std::vector<Frustum>&                 frusta) {
+    used = frusta.size();
+    if (views.size() < used) {
+        views.resize(used);
+        starts.resize(used);
+    }
+    for (size_t v = 0; v < used; ++v) {
+        views[v].models.clear();
+        views[v].slots.clear();
+    }
+
+    for (const auto& model : scene) {
+        if (!model->is_active())
+            continue;
+
+        if (!model->is_instanced()) {
+            for (size_t v = 0; v < used; ++v) {
+                if (aabb_in_frustum(frusta[v], model->get_aabbmin(), model->get_aabbmax()))
+                    views[v].models.push_back({model.get(), 0, 0});
+            }
+            continue;
+        }
+
+        // every view's slots of this model end up next to each other
+        for (size_t v = 0; v < used; ++v)
+            starts[v] = static_cast<uint32_t>(views[v].slots.size());
+        for (size_t i = 0; i < model->get_instance_count(); ++i) {
+            const glm::vec3& min = model->get_instance_aabb_min(i);
+            const glm::vec3& max = model->get_instance_aabb_max(i);
+            for (size_t v = 0; v < used; ++v) {
+                if (aabb_in_frustum(frusta[v], min, max))
+                    views[v].slots.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        for (size_t v = 0; v < used; ++v) {
+            const auto count = static_cast<uint32_t>(views[v].slots.size()) - starts[v];
+            if (count)
+                views[v].models.push_back({model.get(), starts[v], count});
+        }
+    }
+}
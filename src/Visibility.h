@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+namespace Models {
+
+    class Model;
+
+    // frustum planes pointing inside, as Camera::CameraObj::extract_frustum_planes() makes them
+    using Frustum = std::array<glm::vec4, 6>;
+
+    bool aabb_in_frustum(const Frustum& planes, const glm::vec3& min, const glm::vec3& max);
+
+    // Instance slots (indices into a Model's instance arrays) that one view sees
+    struct InstanceSpan {
+        const uint32_t* first = nullptr;
+        size_t          count = 0;
+
+        inline const uint32_t* begin() const {
+            return first;
+        }
+
+        inline const uint32_t* end() const {
+            return first + count;
+        }
+    };
+
+    // A model one view sees. Instanced models list the slots of their visible instances,
+    // slots [first, first + count) of the view's slot list.
+    struct VisibleModel {
+        Model*   model = nullptr;
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+
+    // What one view (the camera, a spot light, a cube face of a point light) sees, in the
+    // order of the scene's model list
+    struct ViewVisibility {
+        std::vector<VisibleModel> models;
+        std::vector<uint32_t>     slots;
+
+        inline InstanceSpan instances(const VisibleModel& visible) const {
+            return {slots.data() + visible.first, visible.count};
+        }
+    };
+
+    // The visible set of every view of a frame. compute() tests each active model's AABB, or
+    // each instance's, against all the views in one sweep over the scene, and reuses the
+    // lists of the frame before so nothing is allocated once they are large enough.
+    class Visibility {
+    public:
+        void compute(const std::vector<std::unique_ptr<Model>>& scene,
+                     const std::vector<Frustum>&                 frusta);
+
+        inline const ViewVisibility& view(size_t index) const {
+            return views[index];
+        }
+
+        inline size_t view_count() const {
+            return used;
+        }
+
+    private:
+        // never shrinks, only the first used are this frame's
+        std::vector<ViewVisibility> views;
+        size_t                      used = 0;
+        // compute() scratch, where each view's slots of the current model start
+        std::vector<uint32_t> starts;
+    };
+
+} // namespace Models
@@ -90,8 +90,18 @@ void Light::draw_lighting(std::shared_ptr<Shader> shader, const std::string& bas
     shader->set_mat4(base + "proj", get_light_projection());
 }
 
-void Light::draw_depth_pass(std::shared_ptr<Shader>                            shader,
-                            const std::vector<std::unique_ptr<Models::Model>>& models) const {
+void Light::append_view_frusta(std::vector<Models::Frustum>& frusta) const {
+    glm::mat4 proj = get_light_projection();
+    if (type == LightType::POINT) {
+        for (const auto& view : get_point_light_views())
+            frusta.push_back(Camera::CameraObj::extract_frustum_planes(proj * view));
+    } else {
+        frusta.push_back(Camera::CameraObj::extract_frustum_planes(proj * get_light_view()));
+    }
+}
+
+void Light::draw_depth_pass(std::shared_ptr<Shader> shader, const Models::Visibility& visibility,
+                            size_t first_view) const {
     GLCall(glViewport(0, 0, shadow_width, shadow_height));
     GLCall(glBindFramebuffer(GL_FRAMEBUFFER, depth_map_fbo));
     GLCall(glClear(GL_DEPTH_BUFFER_BIT));
@@ -99,52 +109,40 @@ void Light::draw_depth_pass(std::shared_ptr<Shader>                            s
     GLCall(glEnable(GL_CULL_FACE));
     GLCall(glCullFace(GL_FRONT));
 
+    // the models a view sees, in scene order
+    auto draw_view = [&](size_t view_id, const glm::mat4& view, const glm::mat4& proj) {
+        const auto& visible = visibility.view(view_id);
+        for (const auto& entry : visible.models) {
+            Models::Model* m = entry.model;
+            if (m->is_instanced()) {
+                m->draw_depth_instanced(shader, view, proj, visible.instances(entry),
+                                        static_cast<uint32_t>(view_id));
+            } else {
+                m->draw_depth(shader, view, proj, static_cast<uint32_t>(view_id));
+            }
+        }
+    };
+
     shader->use();
     if (type == LightType::POINT) {
         glm::mat4 proj  = get_light_projection();
         auto      views = get_point_light_views();
-        // Six passes, one per cube face
+        // Six passes, one per cube face. The geometry shader only emits to shadowFace, so every
+        // layer gets exactly the models, and LODs, its own view picked.
         for (int face = 0; face < 6; ++face) {
             // update this face's matrix
             shader->set_vec3("lightPos", position);
             shader->set_float("farPlane", far_plane);
             shader->set_mat4("shadowMatrices[" + std::to_string(face) + "]", proj * views[face]);
-            glm::mat4 VP     = proj * views[face];
-            auto      planes = Camera::CameraObj::extract_frustum_planes(VP);
-
-            // draw all models into this face
-            for (auto& m : models) {
-                m->in_frustum(planes);
-
-                if (!m->is_active())
-                    continue;
-                if (!m->is_in_frustum())
-                    continue;
-                if (m->is_instanced()) {
-                    m->draw_depth_instanced(shader);
-                } else {
-                    m->draw_depth(shader);
-                }
-            }
+            shader->set_int("shadowFace", face);
+            draw_view(first_view + face, views[face], proj);
         }
     } else {
-        shader->set_mat4("uView", get_light_view());
-        shader->set_mat4("uProj", get_light_projection());
-        glm::mat4 VP     = get_light_projection() * get_light_view();
-        auto      planes = Camera::CameraObj::extract_frustum_planes(VP);
-
-        for (auto& m : models) {
-            m->in_frustum(planes);
-            if (!m->is_active())
-                continue;
-            if (!m->is_in_frustum())
-                continue;
-            if (m->is_instanced()) {
-                m->draw_depth_instanced(shader);
-            } else {
-                m->draw_depth(shader);
-            }
-        }
+        glm::mat4 view = get_light_view();
+        glm::mat4 proj = get_light_projection();
+        shader->set_mat4("uView", view);
+        shader->set_mat4("uProj", proj);
+        draw_view(first_view, view, proj);
     }
 
     GLCall(glCullFace(GL_BACK));
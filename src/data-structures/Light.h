@@ -153,7 +153,12 @@ public:
 
     void bind_shadow_map(std::shared_ptr<Shader> shader, const std::string& base, int index) const;
     void draw_lighting(std::shared_ptr<Shader> shader, const std::string& base, int index) const;
-    void draw_depth_pass(std::shared_ptr<Shader>shader, const std::vector<std::unique_ptr<Models::Model>>& models) const;
+    // the frustum of every shadow view, one for spot lights and one per cube face for point
+    // lights, in the order draw_depth_pass() draws them
+    void append_view_frusta(std::vector<Models::Frustum>& frusta) const;
+    // draws what visibility's views first_view onwards see, the ones append_view_frusta() added
+    void draw_depth_pass(std::shared_ptr<Shader> shader, const Models::Visibility& visibility,
+                         size_t first_view) const;
 private:
     LightType type;
     glm::vec3 position;
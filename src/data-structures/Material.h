@@ -1,7 +1,8 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <memory>
 #include <string>
-#include <GL/glew.h>
+#include "Texture.h"
 struct Material {
     std::string name;
     glm::vec3 Ka{0.f};     // ambient
@@ -14,9 +15,10 @@ struct Material {
     int       illum{0};    // illumination model
     std::string map_Ka, map_Kd, map_Ks, map_Bump;
 
-    GLuint tex_Ka = 0;
-    GLuint tex_Kd = 0;
-    GLuint tex_Ks = 0;
-    GLuint tex_Bump = 0;
+    // filled in by GlHelpers::request_material_textures, empty for CPU-only loads
+    std::shared_ptr<Texture> tex_Ka;
+    std::shared_ptr<Texture> tex_Kd;
+    std::shared_ptr<Texture> tex_Ks;
+    std::shared_ptr<Texture> tex_Bump;
     bool   use_bump_map = false;
 };
@@ -1,11 +1,33 @@
 #pragma once
-#include <GL/glew.h>
+#include <cstdint>
+#include <glm/glm.hpp>
 #include <vector>
 #include "Material.h"
 
+// a run of triangles in the big EBO
+struct LodRange {
+  uint32_t index_offset;
+  uint32_t index_count;
+};
+
+// up to ~124 neighbouring triangles of a SubMesh, culled as a whole
+struct Cluster {
+  uint32_t  index_offset;
+  uint32_t  index_count;
+  glm::vec3 center; // bounding sphere, model space
+  float     radius;
+  // Every triangle faces away from an eye at e once
+  // dot(center - e, cone_axis) >= cone_cutoff * |center - e| + radius, 1 means never
+  glm::vec3 cone_axis;
+  float     cone_cutoff;
+};
+
 struct SubMesh {
   Material mat;
-  std::vector<GLuint> indices;
-  GLuint index_offset;   // offset into the big EBO
-  GLuint index_count;
-};
\ No newline at end of file
+  std::vector<uint32_t> indices;
+  uint32_t index_offset;   // offset into the big EBO
+  uint32_t index_count;
+  uint32_t index_size = 4; // bytes per index in the EBO, 2 when the model has < 65536 vertices
+  std::vector<LodRange> lods; // simplified versions of the range above, coarser ones later
+  std::vector<Cluster> clusters; // the range above split for culling, in index order
+};
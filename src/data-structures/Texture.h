@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// A GPU texture created from an image file, shared by every material that uses it.
+// The loaders hand these out before the pixels reach the GPU: id stays 0 until the
+// upload queue has been drained on the GL thread, so users must skip unbound textures.
+// The GL texture is deleted with the last reference, which must be dropped on the GL thread.
+struct Texture {
+    std::string path;
+    uint32_t    id       = 0; // GLuint
+    int         width    = 0;
+    int         height   = 0;
+    int         channels = 0;
+    size_t      bytes    = 0; // GPU memory including the mip chain, set on upload
+
+    Texture() = default;
+    explicit Texture(std::string path) : path(std::move(path)) {}
+    ~Texture();
+
+    Texture(const Texture&)            = delete;
+    Texture& operator=(const Texture&) = delete;
+};
+
+// GL name of tex, 0 when there is no texture or it has not been uploaded yet
+inline uint32_t gl_id(const std::shared_ptr<Texture>& tex) {
+    return tex ? tex->id : 0;
+}
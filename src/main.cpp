@@ -422,11 +422,6 @@ int main() {
     // right_spot_light_model.set_local_transform(glm::translate(glm::mat4(1.0f),
     // right_light_world));
     // game_state.add_light(std::move(spotlight), "spotlight");
-    auto room1_models = room1.models();
-    for (auto& m : room1_models) {
-        game_state.add_model(std::move(m), m->name());
-    }
-
     glm::vec3 room_offset2 = glm::vec3(-ROOM_WIDTH + room_size, 0.0f, -ROOM_DEPTH + room_size * 2);
     Group     room2("room-2", room_offset2);
     room2
@@ -464,10 +459,6 @@ int main() {
     
     // game_state.add_model(std::move(overhead_point_light_model), "overhead_pointlight_model");
 
-    for (auto& m : room2.models()) {
-        game_state.add_model(std::move(m), m->name());
-    }
-
     glm::vec3 room_offset3 = glm::vec3(ROOM_WIDTH - room_size, 0.0f, -ROOM_DEPTH + room_size * 2);
     Group     room3("room-3", room_offset3);
     room3.model(lamp_file, "lamp", lamp_translate, lamp_scale, lamp_rotation, false)
@@ -488,10 +479,6 @@ int main() {
                glm::vec3(1.2f, 1.2f, 1.2f));
     spotlight3.set_position(room_offset3 + spotlight_offset);
     game_state.add_light(std::move(spotlight3),"room-3-light");
-    for (auto& m : room3.models()) {
-        game_state.add_model(std::move(m), m->name());
-    }
-
     glm::vec3 page3_pos = room_offset3 + glm::vec3(5.0f, 0.15f, 8.0f);
     scroll.add_instance_transform(glm::translate(scroll.get_local_transform(), page3_pos),
                                   "room-3-page-9");
@@ -519,13 +506,6 @@ int main() {
     spotlight4.set_position(room_offset4 + spotlight_offset);
     game_state.add_light(std::move(spotlight4),"room-4-light");
 
-
-    auto room4_models = room4.models();
-    for (auto& m : room4_models) {
-        // std::cout << "Model: " << m->name() << std::endl;
-        game_state.add_model(std::move(m), m->name());
-    }
-
     Group dining_room("dining-room", glm::vec3(ROOM_DEPTH - ROOM_DEPTH / 4, 0.0f, 0.0f));
     dining_room.model("assets/models/SimpleOldTownAssets/OldHouseDoorWoodDarkRed.obj", "door",
                       glm::vec3(0.0f), door_scale, std::nullopt,
@@ -547,9 +527,16 @@ int main() {
     spotlight.set_position(dining_room.room_position() + spotlight_offset);
     game_state.add_light(std::move(spotlight), "dining-room-light");
 
-    for (auto& m : dining_room.models()) {
-        game_state.add_model(std::move(m), m->name());
+    // the doors, switches, lamps and furniture every room repeats draw as one instanced model
+    // each, their instances keep the entry names ("room-1-door") for interaction and handlers
+    GroupInstancingStats grouped;
+    for (auto& [name, m] : Group::instanced_models({&room1, &room2, &room3, &room4, &dining_room},
+                                                   &grouped)) {
+        game_state.add_model(std::move(m), name);
     }
+    std::cout << "room groups: " << grouped.entries << " entries drawn by " << grouped.models
+              << " models (" << grouped.instanced << " instanced), "
+              << grouped.entries - grouped.models << " fewer model draws per view\n";
 
     game_state.add_model(std::move(scroll), "page");
     game_state.add_model(std::move(wall), "wall");
@@ -559,7 +546,6 @@ int main() {
     std::array<std::string, 5> rooms = {"dining-room","room-1","room-2","room-3","room-4"};
     for (auto r : rooms) {
         auto switch_model_name = r + "-switch";
-        auto switch_model      = game_state.find_model(switch_model_name);
         scene_manager.bind_handler_to_model(switch_model_name, [r](Game::SceneManager* scene_mgr) {
             auto room_light = scene_mgr->get_game_state()->find_light(r + "-light");
             room_light->toggle_light();
@@ -572,6 +558,10 @@ int main() {
         bool      initialized = false;
         glm::mat4 closed_xf   = glm::mat4(1.0f);
         glm::mat4 open_xf     = glm::mat4(1.0f);
+        // found once by name: an instance of the shared door model, or a model of its own
+        Models::Model*         model     = nullptr;
+        bool                   instanced = false;
+        Models::InstanceHandle instance;
     };
     constexpr size_t                   NUM_DOORS     = 5;
     std::array<std::string, NUM_DOORS> doors_of_game = {
@@ -582,23 +572,31 @@ int main() {
         DoorState&  state     = door_states[i];
         scene_manager.bind_handler_to_model(
             door_name, [&state, door_name](Game::SceneManager* scene_manager) mutable {
-                auto door_to_toggle = scene_manager->get_game_state()->find_model(door_name);
-                if (!door_to_toggle) {
-                    throw std::runtime_error("Door Model not found: " + door_name);
-                }
-
                 if (!state.initialized) {
+                    auto* game_state = scene_manager->get_game_state();
+                    state.model      = game_state->find_instance(door_name, state.instance);
+                    state.instanced  = state.model != nullptr;
+                    if (!state.model) {
+                        state.model = game_state->find_model(door_name);
+                    }
+                    if (!state.model) {
+                        throw std::runtime_error("Door Model not found: " + door_name);
+                    }
                     state.initialized = true;
-                    state.closed_xf   = door_to_toggle->get_local_transform();
+                    state.closed_xf   = state.instanced
+                                            ? state.model->get_instance_transform(
+                                                state.model->instance_index(state.instance))
+                                            : state.model->get_local_transform();
                     // TODO door does not open to the correct side, it needs a couple extra
                     // transforms
                     state.open_xf = glm::rotate(state.closed_xf, glm::radians(-90.0f),
                                                 glm::vec3(0.0f, 1.0f, 0.0f));
                 }
-                if (state.is_open) {
-                    door_to_toggle->set_local_transform(state.closed_xf);
+                const glm::mat4& xf = state.is_open ? state.closed_xf : state.open_xf;
+                if (state.instanced) {
+                    state.model->set_instance_transform(state.instance, xf);
                 } else {
-                    door_to_toggle->set_local_transform(state.open_xf);
+                    state.model->set_local_transform(xf);
                 }
                 state.is_open = !state.is_open;
                 return true;
@@ -612,10 +610,10 @@ int main() {
             if (!m) {
                 throw std::runtime_error("Model not found " + m->name());
             }
-            scene_manager->remove_instanced_model_at(m->name(-1), "-" + std::to_string(i));
+            scene_manager->remove_instanced_model_at(m->label(), "-" + std::to_string(i));
             scene_manager->get_game_state()->pages_collected += 1;
 
-            if (m->get_active_instance_count() == 0) {
+            if (m->get_instance_count() == 0) {
                 m->disable();
             }
             return false;